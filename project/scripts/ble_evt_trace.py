@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""Decoder and replay driver for BLE event traces captured over RTT.
+
+Reads the binary stream written by src/ble_service/ble_evt_trace.c to RTT up
+channel BLE_EVT_TRACE_RTT_CHANNEL, for example as captured with
+`JLinkRTTLogger -RTTChannel 1`. The stream starts with the magic word and the
+trace version, followed by one record per BLE event: an 8-byte
+ble_evt_trace_hdr_t and the first `len` bytes of the event parameters.
+
+Records are replayed in order on a virtual clock driven by their app_timer
+ticks. Each record is passed to the handler registered for its event id, or
+to the default handler, which prints a timeline. Sequence gaps, where the
+host did not drain the channel fast enough, are reported.
+
+Other tools can import this module and call replay() with their own handlers,
+for example a model of the request pipeline whose decisions are compared
+against the event export of the same session. The firmware handlers
+themselves need a host build of the application, which the tree does not
+have.
+
+The parameter offsets follow the S140 v7 headers.
+
+Usage: ble_evt_trace.py trace.bin [--tick-hz 16384] [--summary]
+"""
+
+import argparse
+import collections
+import struct
+import sys
+
+TRACE_MAGIC = 0x54455642
+TRACE_VERSION = 1
+
+HDR = struct.Struct("<BBHI")
+STREAM_HDR = struct.Struct("<II")
+
+# Default app_timer frequency, 32768 / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1).
+TICK_HZ = 16384
+
+EVT_NAMES = {
+    0x01: "USER_MEM_REQUEST",
+    0x02: "USER_MEM_RELEASE",
+    0x10: "GAP_CONNECTED",
+    0x11: "GAP_DISCONNECTED",
+    0x12: "GAP_CONN_PARAM_UPDATE",
+    0x13: "GAP_SEC_PARAMS_REQUEST",
+    0x14: "GAP_SEC_INFO_REQUEST",
+    0x15: "GAP_PASSKEY_DISPLAY",
+    0x16: "GAP_KEY_PRESSED",
+    0x17: "GAP_AUTH_KEY_REQUEST",
+    0x18: "GAP_LESC_DHKEY_REQUEST",
+    0x19: "GAP_AUTH_STATUS",
+    0x1A: "GAP_CONN_SEC_UPDATE",
+    0x1B: "GAP_TIMEOUT",
+    0x1C: "GAP_RSSI_CHANGED",
+    0x1D: "GAP_ADV_REPORT",
+    0x1E: "GAP_SEC_REQUEST",
+    0x1F: "GAP_CONN_PARAM_UPDATE_REQUEST",
+    0x20: "GAP_SCAN_REQ_REPORT",
+    0x21: "GAP_PHY_UPDATE_REQUEST",
+    0x22: "GAP_PHY_UPDATE",
+    0x23: "GAP_DATA_LENGTH_UPDATE_REQUEST",
+    0x24: "GAP_DATA_LENGTH_UPDATE",
+    0x25: "GAP_QOS_CHANNEL_SURVEY_REPORT",
+    0x26: "GAP_ADV_SET_TERMINATED",
+    0x30: "GATTC_PRIM_SRVC_DISC_RSP",
+    0x31: "GATTC_REL_DISC_RSP",
+    0x32: "GATTC_CHAR_DISC_RSP",
+    0x33: "GATTC_DESC_DISC_RSP",
+    0x34: "GATTC_ATTR_INFO_DISC_RSP",
+    0x35: "GATTC_CHAR_VAL_BY_UUID_READ_RSP",
+    0x36: "GATTC_READ_RSP",
+    0x37: "GATTC_CHAR_VALS_READ_RSP",
+    0x38: "GATTC_WRITE_RSP",
+    0x39: "GATTC_HVX",
+    0x3A: "GATTC_EXCHANGE_MTU_RSP",
+    0x3B: "GATTC_TIMEOUT",
+    0x3C: "GATTC_WRITE_CMD_TX_COMPLETE",
+    0x50: "GATTS_WRITE",
+    0x51: "GATTS_RW_AUTHORIZE_REQUEST",
+    0x52: "GATTS_SYS_ATTR_MISSING",
+    0x53: "GATTS_HVC",
+    0x54: "GATTS_SC_CONFIRM",
+    0x55: "GATTS_EXCHANGE_MTU_REQUEST",
+    0x56: "GATTS_TIMEOUT",
+    0x57: "GATTS_HVN_TX_COMPLETE",
+}
+
+EVT_GAP_CONNECTED = 0x10
+EVT_GAP_DISCONNECTED = 0x11
+EVT_GAP_RSSI_CHANGED = 0x1C
+EVT_GATTC_READ_RSP = 0x36
+EVT_GATTC_WRITE_RSP = 0x38
+EVT_GATTC_HVX = 0x39
+EVT_GATTS_WRITE = 0x50
+
+
+class Record(object):
+    """One BLE event of the trace."""
+
+    def __init__(self, seq, evt_id, ticks, params):
+        self.seq = seq
+        self.evt_id = evt_id
+        self.ticks = ticks
+        self.params = params
+        self.time_ms = 0
+
+    @property
+    def name(self):
+        return EVT_NAMES.get(self.evt_id, "0x{:02x}".format(self.evt_id))
+
+    @property
+    def conn_handle(self):
+        """Connection handle of GAP, GATT and L2CAP events, else None."""
+        if self.evt_id >= 0x10 and len(self.params) >= 2:
+            return struct.unpack_from("<H", self.params)[0]
+        return None
+
+    def u8(self, offset):
+        return self.params[offset] if len(self.params) > offset else None
+
+    def u16(self, offset):
+        if len(self.params) >= offset + 2:
+            return struct.unpack_from("<H", self.params, offset)[0]
+        return None
+
+
+def read_records(data):
+    """Yields the records of a trace, raises ValueError on a bad stream."""
+    if len(data) < STREAM_HDR.size:
+        raise ValueError("trace too short")
+    magic, version = STREAM_HDR.unpack_from(data)
+    if magic != TRACE_MAGIC:
+        raise ValueError("bad magic 0x{:08x}".format(magic))
+    if version != TRACE_VERSION:
+        raise ValueError("unsupported trace version {}".format(version))
+
+    offset = STREAM_HDR.size
+    while offset + HDR.size <= len(data):
+        length, seq, evt_id, ticks = HDR.unpack_from(data, offset)
+        offset += HDR.size
+        if offset + length > len(data):
+            break
+        yield Record(seq, evt_id, ticks, data[offset:offset + length])
+        offset += length
+
+
+# Offsets of the event specific parameters behind the connection handle. The
+# GAP union holds pointers, the GATT unions only 16-bit fields.
+GAP_PARAMS = 4
+GATTC_PARAMS = 6
+GATTS_PARAMS = 2
+
+
+def describe(record):
+    """Returns the decoded fields of the events the application routes."""
+    if record.evt_id == EVT_GAP_CONNECTED:
+        role = record.u8(GAP_PARAMS + 7)
+        return "role {}".format({1: "periph", 2: "central"}.get(role, role))
+    if record.evt_id == EVT_GAP_DISCONNECTED:
+        return "reason 0x{:02x}".format(record.u8(GAP_PARAMS) or 0)
+    if record.evt_id == EVT_GAP_RSSI_CHANGED:
+        rssi = record.u8(GAP_PARAMS)
+        return "rssi {} dBm".format(rssi - 256 if rssi is not None and rssi > 127 else rssi)
+    if record.evt_id in (EVT_GATTC_READ_RSP, EVT_GATTC_WRITE_RSP):
+        return "status 0x{:04x} handle 0x{:04x}".format(record.u16(2) or 0, record.u16(GATTC_PARAMS) or 0)
+    if record.evt_id == EVT_GATTC_HVX:
+        length = record.u16(GATTC_PARAMS + 4) or 0
+        value = bytes(record.params[GATTC_PARAMS + 6:GATTC_PARAMS + 6 + length])
+        return "handle 0x{:04x} value {}".format(record.u16(GATTC_PARAMS) or 0, value.hex())
+    if record.evt_id == EVT_GATTS_WRITE:
+        length = record.u16(GATTS_PARAMS + 10) or 0
+        value = bytes(record.params[GATTS_PARAMS + 12:GATTS_PARAMS + 12 + length])
+        return "handle 0x{:04x} value {}".format(record.u16(GATTS_PARAMS) or 0, value.hex())
+    return ""
+
+
+def print_record(record):
+    conn = record.conn_handle
+    print("{:>10.3f} {:>3} {:<32} {:<6} {}".format(
+        record.time_ms / 1000.0, record.seq, record.name,
+        "" if conn is None else "0x{:x}".format(conn), describe(record)))
+
+
+def replay(data, handlers=None, default=print_record, tick_hz=TICK_HZ, on_gap=None):
+    """Replays a trace on a virtual clock.
+
+    Each record gets time_ms, the time since the first record, with the 32-bit
+    tick count unwrapped. The handler registered for its event id in handlers,
+    or default, is then called with it. on_gap is called with the number of
+    records lost before a record. Returns the number of records replayed.
+    """
+    handlers = handlers or {}
+    first = None
+    last_ticks = None
+    wraps = 0
+    expected_seq = None
+    count = 0
+
+    for record in read_records(data):
+        if last_ticks is not None and record.ticks < last_ticks:
+            wraps += 1
+        last_ticks = record.ticks
+        ticks = (wraps << 32) + record.ticks
+        if first is None:
+            first = ticks
+        record.time_ms = (ticks - first) * 1000.0 / tick_hz
+
+        if expected_seq is not None and record.seq != expected_seq and on_gap:
+            on_gap((record.seq - expected_seq) & 0xFF)
+        expected_seq = (record.seq + 1) & 0xFF
+
+        handler = handlers.get(record.evt_id, default)
+        if handler:
+            handler(record)
+        count += 1
+    return count
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="binary capture of the trace RTT channel")
+    parser.add_argument("--tick-hz", type=int, default=TICK_HZ,
+                        help="app_timer frequency of the firmware")
+    parser.add_argument("--summary", action="store_true",
+                        help="only print the event counts")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f:
+        data = f.read()
+
+    counts = collections.Counter()
+    lost = [0]
+
+    def count(record):
+        counts[record.name] += 1
+        if not args.summary:
+            print_record(record)
+
+    def gap(n):
+        lost[0] += n
+        if not args.summary:
+            print("{:>10} {} records lost".format("", n))
+
+    try:
+        total = replay(data, default=count, tick_hz=args.tick_hz, on_gap=gap)
+    except ValueError as e:
+        print("error: {}".format(e), file=sys.stderr)
+        return 1
+
+    if args.summary or total:
+        print()
+        for name, n in counts.most_common():
+            print("{:<32} {:>8}".format(name, n))
+        print("{:<32} {:>8}".format("total", total))
+        print("{:<32} {:>8}".format("lost (at least)", lost[0]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
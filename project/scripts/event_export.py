@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+"""Decoder for the event export stream.
+
+Reads the SLIP framed records written by src/export_service/event_export.c,
+from a serial port (the export UARTE, or the CDC-ACM port of the pca10059
+dongle), a capture file, or stdin. Each frame is a 20-byte
+event_export_record_t followed by its CRC-16-CCITT, little endian. Frames
+with a bad CRC or length are counted and skipped, sequence gaps are reported.
+
+With --bench, the decoder instead reads synthetic records written at full
+speed through a pseudo terminal, and prints the records/sec it sustained.
+
+The type and statistics names follow event_export.h.
+
+Usage: event_export.py [PORT|FILE|-] [--baud 1000000] [--summary]
+       event_export.py --bench [--records 100000]
+"""
+
+import argparse
+import collections
+import datetime
+import os
+import struct
+import sys
+import termios
+import threading
+import time
+import tty
+
+EXPORT_VERSION = 2
+
+RECORD = struct.Struct("<BBHQHBBI")
+
+SLIP_END = 0xC0
+SLIP_ESC = 0xDB
+SLIP_ESC_END = 0xDC
+SLIP_ESC_ESC = 0xDD
+
+TIME_SINCE_BOOT = 1 << 63
+
+TYPE_NAMES = {
+    1: "REQUEST",
+    2: "ACK",
+    3: "LINK",
+    4: "STATS",
+    5: "HANDOVER",
+    6: "RELAY",
+    7: "CLOCK_SYNC",
+    8: "PROFILE",
+    9: "RESTART",
+    10: "BOOT",
+    11: "FAULT",
+    12: "ESCALATION",
+}
+
+TYPE_STATS = 4
+
+STAT_NAMES = {
+    1: "PENDING_REQUESTS",
+    2: "ACK_COUNT",
+    3: "ACK_P50_MS",
+    4: "ACK_P99_MS",
+    5: "RECORDS_SENT",
+    6: "RECORDS_DROPPED",
+    7: "RECORDS_PER_SEC",
+    8: "RELAY_BUFFERED",
+    9: "RELAY_LATENCY_MS",
+    10: "TRANSIENT_ERRORS",
+    11: "LINK_RECOVERIES",
+    12: "STACK_USED",
+    13: "PENDING_REQUESTS_MAX",
+    14: "REQUESTS_REJECTED",
+    15: "WORK_DEPTH_MAX",
+    16: "WORK_DROPPED",
+    17: "WORK_ENQUEUE_CYCLES",
+    18: "REQUEST_STATES_ABSORBED",
+    19: "LOG_BACKLOG_MAX",
+    20: "LOG_UART_BUSY_MS",
+    21: "RELAY_LOST",
+}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16-CCITT as computed by the SDK's crc16_compute()."""
+    for byte in data:
+        crc = ((crc >> 8) | (crc << 8)) & 0xFFFF
+        crc ^= byte
+        crc ^= (crc & 0xFF) >> 4
+        crc ^= (crc << 12) & 0xFFFF
+        crc ^= ((crc & 0xFF) << 5) & 0xFFFF
+    return crc
+
+
+def encode(record):
+    """Frames a record the way the firmware does, used by the benchmark."""
+    frame = bytearray()
+    for byte in record + struct.pack("<H", crc16(record)):
+        if byte == SLIP_END:
+            frame += bytes((SLIP_ESC, SLIP_ESC_END))
+        elif byte == SLIP_ESC:
+            frame += bytes((SLIP_ESC, SLIP_ESC_ESC))
+        else:
+            frame.append(byte)
+    frame.append(SLIP_END)
+    return bytes(frame)
+
+
+class Record(object):
+    """One exported event."""
+
+    def __init__(self, data):
+        (self.version, self.type, self.seq, self.time_ms, self.conn_handle,
+         self.arg0, self.arg1, self.value) = RECORD.unpack(data)
+
+    @property
+    def name(self):
+        if self.type == TYPE_STATS:
+            return "STATS " + STAT_NAMES.get(self.arg0, str(self.arg0))
+        return TYPE_NAMES.get(self.type, str(self.type))
+
+    @property
+    def time(self):
+        if self.time_ms & TIME_SINCE_BOOT:
+            return "+{:.3f}".format((self.time_ms & ~TIME_SINCE_BOOT) / 1000.0)
+        stamp = datetime.datetime.fromtimestamp(self.time_ms / 1000.0, datetime.timezone.utc)
+        return stamp.strftime("%Y-%m-%d %H:%M:%S.%f")[:-3]
+
+    def __str__(self):
+        conn = "" if self.conn_handle == 0xFFFF else "0x{:x}".format(self.conn_handle)
+        return "{:>23} {:>5} {:<32} {:<6} {:>3} {:>3} {}".format(
+            self.time, self.seq, self.name, conn, self.arg0, self.arg1, self.value)
+
+
+class Decoder(object):
+    """Incremental SLIP decoder, fed with whatever the port returned."""
+
+    def __init__(self):
+        self.frame = bytearray()
+        self.escaped = False
+        self.expected_seq = None
+        self.records = 0
+        self.bad_frames = 0
+        self.lost = 0
+
+    def feed(self, data):
+        """Yields the records completed by data."""
+        for byte in data:
+            if byte == SLIP_END:
+                record = self.frame_done(bytes(self.frame))
+                self.frame = bytearray()
+                self.escaped = False
+                if record:
+                    yield record
+            elif self.escaped:
+                self.escaped = False
+                if byte == SLIP_ESC_END:
+                    self.frame.append(SLIP_END)
+                elif byte == SLIP_ESC_ESC:
+                    self.frame.append(SLIP_ESC)
+                else:
+                    self.frame.append(byte)
+            elif byte == SLIP_ESC:
+                self.escaped = True
+            else:
+                self.frame.append(byte)
+
+    def frame_done(self, frame):
+        if not frame:
+            return None
+        if len(frame) != RECORD.size + 2:
+            self.bad_frames += 1
+            return None
+        crc = struct.unpack_from("<H", frame, RECORD.size)[0]
+        if crc != crc16(frame[:RECORD.size]):
+            self.bad_frames += 1
+            return None
+
+        record = Record(frame[:RECORD.size])
+        if record.version != EXPORT_VERSION:
+            self.bad_frames += 1
+            return None
+        if self.expected_seq is not None and record.seq != self.expected_seq:
+            self.lost += (record.seq - self.expected_seq) & 0xFFFF
+        self.expected_seq = (record.seq + 1) & 0xFFFF
+        self.records += 1
+        return record
+
+
+def open_port(path, baud):
+    """Opens a serial port in raw mode, or a file, returns a file descriptor."""
+    if path == "-":
+        return sys.stdin.fileno()
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B{}".format(baud), None)
+        if speed is not None:
+            attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def bench(count):
+    """Writes count records through a pty and times the decoder reading them."""
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    frames = b"".join(encode(RECORD.pack(EXPORT_VERSION, TYPE_STATS, i & 0xFFFF, TIME_SINCE_BOOT | i,
+                                         0xFFFF, i % 21, 0, i * 0x01010101 & 0xFFFFFFFF))
+                      for i in range(count))
+
+    def writer():
+        view = memoryview(frames)
+        while view:
+            view = view[os.write(master, view[:4096]):]
+
+    decoder = Decoder()
+    thread = threading.Thread(target=writer)
+    start = time.time()
+    thread.start()
+    while decoder.records + decoder.bad_frames < count:
+        for _ in decoder.feed(os.read(slave, 4096)):
+            pass
+    elapsed = time.time() - start
+    thread.join()
+    os.close(master)
+    os.close(slave)
+
+    print("{} records, {} bytes in {:.3f} s".format(count, len(frames), elapsed))
+    print("{:.0f} records/sec, {:.0f} bytes/sec".format(count / elapsed, len(frames) / elapsed))
+    print("{} bad frames, {} lost".format(decoder.bad_frames, decoder.lost))
+    return 0 if decoder.bad_frames == 0 and decoder.lost == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", nargs="?", default="-",
+                        help="serial port or capture file, - for stdin")
+    parser.add_argument("--baud", type=int, default=1000000,
+                        help="baud rate of a serial port")
+    parser.add_argument("--summary", action="store_true",
+                        help="only print the record counts")
+    parser.add_argument("--bench", action="store_true",
+                        help="measure the decoder throughput over a pty")
+    parser.add_argument("--records", type=int, default=100000,
+                        help="records written by the benchmark")
+    args = parser.parse_args()
+
+    if args.bench:
+        return bench(args.records)
+
+    fd = open_port(args.port, args.baud)
+    decoder = Decoder()
+    counts = collections.Counter()
+    lost = 0
+    try:
+        while True:
+            data = os.read(fd, 4096)
+            if not data:
+                break
+            for record in decoder.feed(data):
+                counts[record.name] += 1
+                if decoder.lost != lost and not args.summary:
+                    print("{:>23} {} records lost".format("", decoder.lost - lost))
+                lost = decoder.lost
+                if not args.summary:
+                    print(record)
+    except KeyboardInterrupt:
+        pass
+
+    print()
+    for name, n in counts.most_common():
+        print("{:<32} {:>8}".format(name, n))
+    print("{:<32} {:>8}".format("total", decoder.records))
+    print("{:<32} {:>8}".format("lost (at least)", decoder.lost))
+    print("{:<32} {:>8}".format("bad frames", decoder.bad_frames))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Per-module flash/RAM report for the armgcc build.
+
+Reads the section headers and the symbol table (with source lines) of the
+linked ELF and sums symbol sizes per source module. Initialized data counts
+against both flash (load image) and RAM, zero-initialized and no-init data
+against RAM only.
+
+Functions on the BLE event path (SoftDevice event dispatch, observers and
+the handlers they call) are listed separately together with the section
+they ended up in, so code left in flash instead of `.fast` RAM is visible
+at a glance.
+
+Usage: size_report.py --elf _build/nrf52840_xxaa.out --src ../../../src
+"""
+
+import argparse
+import collections
+import os
+import re
+import subprocess
+import sys
+
+# Symbols treated as part of the BLE event path.
+BLE_EVT_PATH = [
+    r"^SWI2_EGU2_IRQHandler$",
+    r"^nrf_sdh_evts_poll$",
+    r"^nrf_sdh_ble_evts_poll$",
+    r"^ble_evt_dispatch$",
+    r"(^|_)on_ble_evt$",
+    r"(^|_)on_(hvx|read_rsp|write_rsp|connected|disconnected)$",
+    r"evt_handler$",
+]
+
+# Suffixes added by LTO and interprocedural optimizations.
+LTO_SUFFIX = re.compile(r"\.(lto_priv|constprop|isra|part|cold)\.\d+")
+
+RAM_START = 0x20000000
+
+
+def read_sections(elf, prefix):
+    """Returns a list of (name, addr, size, nobits)."""
+    out = subprocess.check_output([prefix + "readelf", "-S", "-W", elf],
+                                  universal_newlines=True)
+    sections = []
+    for line in out.splitlines():
+        m = re.match(r"\s*\[\s*\d+\]\s+(\S+)\s+(\S+)\s+([0-9a-f]+)\s+[0-9a-f]+"
+                     r"\s+([0-9a-f]+)\s+\S+\s+(\S*)", line)
+        if not m:
+            continue
+        name, stype, addr, size, flags = m.groups()
+        if "A" not in flags:
+            continue
+        sections.append((name, int(addr, 16), int(size, 16), stype == "NOBITS"))
+    return sections
+
+
+def section_of(sections, addr):
+    for name, start, size, nobits in sections:
+        if start <= addr < start + size:
+            return name, nobits
+    return None, False
+
+
+def read_symbols(elf, prefix):
+    """Yields (name, addr, size, type, path)."""
+    out = subprocess.check_output([prefix + "nm", "-S", "-l", elf],
+                                  universal_newlines=True)
+    for line in out.splitlines():
+        head, _, location = line.partition("\t")
+        parts = head.split()
+        if len(parts) != 4:
+            continue
+        addr, size, stype, name = parts
+        path = location.rsplit(":", 1)[0] if location else ""
+        yield name, int(addr, 16), int(size, 16), stype, path
+
+
+def module_name(path, src_root):
+    if not path:
+        return "(unknown)"
+    path = os.path.normpath(path)
+    if src_root:
+        rel = os.path.relpath(path, src_root)
+        if not rel.startswith(".."):
+            return os.path.splitext(rel)[0]
+    return "sdk/" + os.path.splitext(os.path.basename(path))[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--elf", required=True)
+    parser.add_argument("--src", help="application source root")
+    parser.add_argument("--prefix", default="arm-none-eabi-")
+    parser.add_argument("--top", type=int, default=0,
+                        help="only list the N largest modules")
+    parser.add_argument("--strict", action="store_true",
+                        help="exit with 1 if BLE event path code is in flash")
+    args = parser.parse_args()
+
+    src_root = os.path.normpath(os.path.abspath(args.src)) if args.src else None
+    sections = read_sections(args.elf, args.prefix)
+
+    flash = collections.Counter()
+    ram = collections.Counter()
+    evt_path = []
+    patterns = [re.compile(p) for p in BLE_EVT_PATH]
+
+    for name, addr, size, stype, path in read_symbols(args.elf, args.prefix):
+        section, nobits = section_of(sections, addr)
+        if section is None:
+            continue
+        module = module_name(os.path.abspath(path) if path else "", src_root)
+        in_ram = addr >= RAM_START
+        if not in_ram:
+            flash[module] += size
+        else:
+            ram[module] += size
+            if not nobits:
+                flash[module] += size
+
+        if stype in "tT":
+            base = LTO_SUFFIX.sub("", name)
+            if any(p.search(base) for p in patterns):
+                evt_path.append((base, size, section, module))
+
+    modules = sorted(set(flash) | set(ram), key=lambda m: -(flash[m] + ram[m]))
+    if args.top:
+        modules = modules[:args.top]
+
+    width = max([len(m) for m in modules] + [6])
+    print("{:<{w}} {:>8} {:>8}".format("module", "flash", "ram", w=width))
+    for m in modules:
+        print("{:<{w}} {:>8} {:>8}".format(m, flash[m], ram[m], w=width))
+    print("{:<{w}} {:>8} {:>8}".format("total", sum(flash.values()),
+                                       sum(ram.values()), w=width))
+
+    in_flash = [e for e in evt_path if e[2] != ".fast"]
+    print()
+    print("BLE event path ({} functions, {} in flash):".format(len(evt_path),
+                                                            len(in_flash)))
+    for base, size, section, module in sorted(evt_path, key=lambda e: e[2]):
+        flag = "  " if section == ".fast" else "! "
+        print("{}{:<40} {:>6} {:<8} {}".format(flag, base, size, section, module))
+
+    if args.strict and in_flash:
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
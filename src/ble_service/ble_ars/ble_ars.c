@@ -0,0 +1,62 @@
+#include "ble_ars.h"
+
+#include "sdk_common.h"
+
+#define NRF_LOG_MODULE_NAME ble_ars
+
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+NRF_LOG_MODULE_REGISTER();
+
+
+void ble_ars_on_write(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ble_ars_t*                   p_ars       = (ble_ars_t*)p_context;
+    const ble_gatts_evt_write_t* p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
+
+    if (p_evt_write->handle == p_ars->relay_char_handles.value_handle &&
+        p_ars->relay_write_handler != NULL)
+    {
+        p_ars->relay_write_handler(p_ble_evt->evt.gatts_evt.conn_handle, p_evt_write->data, p_evt_write->len);
+    }
+}
+
+
+uint32_t ble_ars_init(ble_ars_t* p_ars, const ble_ars_init_t* p_ars_init)
+{
+    uint32_t              err_code;
+    ble_uuid_t            ble_uuid;
+    ble_uuid128_t         ars_base_uuid = {ARS_UUID_BASE};
+    ble_add_char_params_t add_char_params;
+
+    VERIFY_PARAM_NOT_NULL(p_ars);
+    VERIFY_PARAM_NOT_NULL(p_ars_init);
+
+    p_ars->relay_write_handler = p_ars_init->relay_write_handler;
+
+    // The client registers the same base, in which case the SoftDevice returns the existing type.
+    err_code = sd_ble_uuid_vs_add(&ars_base_uuid, &p_ars->uuid_type);
+    VERIFY_SUCCESS(err_code);
+
+    ble_uuid.type = p_ars->uuid_type;
+    ble_uuid.uuid = ARS_UUID_SERVICE;
+
+    err_code = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &ble_uuid, &p_ars->service_handle);
+    VERIFY_SUCCESS(err_code);
+
+    // Add Relay characteristic.
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid                     = ARS_UUID_RELAY_CHAR;
+    add_char_params.uuid_type                = p_ars->uuid_type;
+    add_char_params.init_len                 = 0;
+    add_char_params.max_len                  = BLE_ARS_RELAY_MAX_LEN;
+    add_char_params.is_var_len               = true;
+    add_char_params.char_props.write         = 1;
+    add_char_params.char_props.write_wo_resp = 1;
+
+    add_char_params.read_access  = SEC_NO_ACCESS;
+    add_char_params.write_access = SEC_OPEN;
+
+    NRF_LOG_DEBUG("Adding Relay characteristic.");
+    return characteristic_add(p_ars->service_handle, &add_char_params, &p_ars->relay_char_handles);
+}
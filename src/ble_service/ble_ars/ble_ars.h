@@ -0,0 +1,92 @@
+/**@file
+ *
+ * @defgroup ble_ars Assistance Request Service Server
+ * @{
+ * @brief    The Assistance Request Service server is hosted by station servers to receive the
+ *           events relayed by edge servers.
+ *
+ * @details  The service shares the UUIDs of the Assistance Request Service hosted by wearables,
+ *           but only carries the Relay characteristic. Edge servers discover it with the
+ *           Assistance Request Service client and write relay records to it.
+ */
+
+#ifndef BLE_ARS_H__
+#define BLE_ARS_H__
+
+#include <stdint.h>
+#include "ble.h"
+#include "ble_srv_common.h"
+#include "ble_service/ble_evt_router.h"
+#include "ble_service/ble_ars_c/ble_ars_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_ARS_BLE_OBSERVER_PRIO 2
+
+#define BLE_ARS_RELAY_MAX_LEN     (BLE_GATT_ATT_MTU_DEFAULT - 3)  /**< Maximum length of a relay record write. */
+
+/**@brief   Macro for defining a ble_ars instance.
+ *
+ * @param   _name   Name of the instance.
+ * @hideinitializer
+ */
+#define BLE_ARS_DEF(_name)                                                      \
+static ble_ars_t _name;                                                        \
+BLE_EVT_ROUTE(_name ## _write_route, BLE_GATTS_EVT_WRITE,                      \
+              BLE_ARS_BLE_OBSERVER_PRIO, ble_ars_on_write, &_name)
+
+
+/**@brief   Relay write handler type.
+ *
+ * @param[in] conn_handle  Connection handle of the edge server.
+ * @param[in] p_data       Relay record written by the edge server.
+ * @param[in] length       Record length.
+ */
+typedef void (* ble_ars_relay_write_handler_t)(uint16_t conn_handle, const uint8_t* p_data, uint16_t length);
+
+/**@brief Assistance Request Service init structure. */
+typedef struct
+{
+    ble_ars_relay_write_handler_t relay_write_handler;  /**< Handler called when an edge server writes the Relay characteristic. */
+} ble_ars_init_t;
+
+/**@brief Assistance Request Service structure. */
+typedef struct
+{
+    uint16_t                      service_handle;       /**< Handle of the Assistance Request Service as provided by the SoftDevice. */
+    ble_gatts_char_handles_t      relay_char_handles;   /**< Handles related to the Relay characteristic. */
+    uint8_t                       uuid_type;            /**< UUID type. */
+    ble_ars_relay_write_handler_t relay_write_handler;  /**< Handler called when an edge server writes the Relay characteristic. */
+} ble_ars_t;
+
+
+/**@brief Function for initializing the Assistance Request Service.
+ *
+ * @param[out] p_ars       Assistance Request Service structure.
+ * @param[in]  p_ars_init  Information needed to initialize the service.
+ *
+ * @retval NRF_SUCCESS If the service was initialized successfully.
+ * @retval err_code    Otherwise, the error code returned by the SoftDevice.
+ */
+uint32_t ble_ars_init(ble_ars_t* p_ars, const ble_ars_init_t* p_ars_init);
+
+
+/**@brief Function for handling the Write event from the SoftDevice.
+ *
+ * @details If the Relay characteristic was written, the record is passed to the relay write handler.
+ *
+ * @param[in] p_ble_evt     Pointer to the BLE_GATTS_EVT_WRITE event.
+ * @param[in] p_context     Pointer to the Assistance Request Service structure.
+ */
+void ble_ars_on_write(const ble_evt_t* p_ble_evt, void* p_context);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLE_ARS_H__
+
+/** @} */
@@ -36,18 +36,34 @@ static void gatt_error_handler(uint32_t   nrf_error,
 }
 
 
-/**@brief Function for handling Handle Value Notification received from the SoftDevice.
+/**@brief Function for handling an error of the GATT queue on a Relay characteristic write.
  *
- * @details This function uses the Handle Value Notification received from the SoftDevice
- *          and checks whether it is a notification of Button state from the peer. If
- *          it is, this function decodes the state of the button and sends it to the
- *          application.
+ * @details No Write Response follows, so the application is told to not wait for it.
  *
- * @param[in] p_ble_ars_c Pointer to the Led Button Client structure.
- * @param[in] p_ble_evt   Pointer to the BLE event received.
+ * @param[in] nrf_error   Error code.
+ * @param[in] p_ctx       Parameter from the event handler.
+ * @param[in] conn_handle Connection handle.
  */
-static void on_hvx(ble_ars_c_t* p_ble_ars_c, const ble_evt_t* p_ble_evt)
+static void relay_write_error_handler(uint32_t nrf_error,
+                                      void*    p_ctx,
+                                      uint16_t conn_handle)
 {
+    ble_ars_c_t*    p_ble_ars_c = (ble_ars_c_t*)p_ctx;
+    ble_ars_c_evt_t ble_ars_c_evt;
+
+    gatt_error_handler(nrf_error, p_ctx, conn_handle);
+
+    ble_ars_c_evt.evt_type         = BLE_ARS_C_EVT_RELAY_WRITE_ERROR;
+    ble_ars_c_evt.conn_handle      = conn_handle;
+    ble_ars_c_evt.params.nrf_error = nrf_error;
+    p_ble_ars_c->evt_handler(p_ble_ars_c, &ble_ars_c_evt);
+}
+
+
+void ble_ars_c_on_hvx(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ble_ars_c_t* p_ble_ars_c = (ble_ars_c_t*)p_context;
+
     // Check if the event is on the link for this instance.
     if (p_ble_ars_c->conn_handle != p_ble_evt->evt.gattc_evt.conn_handle)
     {
@@ -69,22 +85,69 @@ static void on_hvx(ble_ars_c_t* p_ble_ars_c, const ble_evt_t* p_ble_evt)
 }
 
 
-/**@brief Function for handling the Disconnected event received from the SoftDevice.
- *
- * @details This function checks whether the disconnect event is happening on the link
- *          associated with the current instance of the module. If the event is happening, the function sets the instance's
- *          conn_handle to invalid.
- *
- * @param[in] p_ble_ars_c Pointer to the Led Button Client structure.
- * @param[in] p_ble_evt   Pointer to the BLE event received.
- */
-static void on_disconnected(ble_ars_c_t* p_ble_ars_c, const ble_evt_t* p_ble_evt)
+void ble_ars_c_on_read_rsp(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ble_ars_c_t*                    p_ble_ars_c = (ble_ars_c_t*)p_context;
+    const ble_gattc_evt_read_rsp_t* p_read_rsp  = &p_ble_evt->evt.gattc_evt.params.read_rsp;
+
+    if (p_ble_ars_c->conn_handle != p_ble_evt->evt.gattc_evt.conn_handle ||
+        p_ble_evt->evt.gattc_evt.gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        return;
+    }
+
+    if (p_read_rsp->handle == p_ble_ars_c->peer_ars_db.assist_req_handle && p_read_rsp->len >= 1)
+    {
+        ble_ars_c_evt_t ble_ars_c_evt;
+
+        ble_ars_c_evt.evt_type                 = BLE_ARS_C_EVT_ASSIST_REQ_READ;
+        ble_ars_c_evt.conn_handle              = p_ble_ars_c->conn_handle;
+        ble_ars_c_evt.params.request.req_state = p_read_rsp->data[0];
+        p_ble_ars_c->evt_handler(p_ble_ars_c, &ble_ars_c_evt);
+    }
+}
+
+
+void ble_ars_c_on_write_rsp(const ble_evt_t* p_ble_evt, void* p_context)
 {
+    ble_ars_c_t* p_ble_ars_c = (ble_ars_c_t*)p_context;
+
+    if (p_ble_ars_c->conn_handle != p_ble_evt->evt.gattc_evt.conn_handle)
+    {
+        return;
+    }
+
+    if (p_ble_evt->evt.gattc_evt.params.write_rsp.handle == p_ble_ars_c->peer_ars_db.assist_req_handle)
+    {
+        ble_ars_c_evt_t ble_ars_c_evt;
+
+        ble_ars_c_evt.evt_type           = BLE_ARS_C_EVT_ASSIST_REQ_WRITE_RSP;
+        ble_ars_c_evt.conn_handle        = p_ble_ars_c->conn_handle;
+        ble_ars_c_evt.params.gatt_status = p_ble_evt->evt.gattc_evt.gatt_status;
+        p_ble_ars_c->evt_handler(p_ble_ars_c, &ble_ars_c_evt);
+    }
+    else if (p_ble_evt->evt.gattc_evt.params.write_rsp.handle == p_ble_ars_c->peer_ars_db.relay_handle)
+    {
+        ble_ars_c_evt_t ble_ars_c_evt;
+
+        ble_ars_c_evt.evt_type           = BLE_ARS_C_EVT_RELAY_WRITE_RSP;
+        ble_ars_c_evt.conn_handle        = p_ble_ars_c->conn_handle;
+        ble_ars_c_evt.params.gatt_status = p_ble_evt->evt.gattc_evt.gatt_status;
+        p_ble_ars_c->evt_handler(p_ble_ars_c, &ble_ars_c_evt);
+    }
+}
+
+
+void ble_ars_c_on_disconnected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ble_ars_c_t* p_ble_ars_c = (ble_ars_c_t*)p_context;
+
     if (p_ble_ars_c->conn_handle == p_ble_evt->evt.gap_evt.conn_handle)
     {
         p_ble_ars_c->conn_handle                        = BLE_CONN_HANDLE_INVALID;
         p_ble_ars_c->peer_ars_db.assist_req_cccd_handle = BLE_GATT_HANDLE_INVALID;
         p_ble_ars_c->peer_ars_db.assist_req_handle      = BLE_GATT_HANDLE_INVALID;
+        p_ble_ars_c->peer_ars_db.relay_handle           = BLE_GATT_HANDLE_INVALID;
     }
 }
 
@@ -98,8 +161,11 @@ void ble_ars_on_db_disc_evt(ble_ars_c_t* p_ble_ars_c, const ble_db_discovery_evt
     {
         ble_ars_c_evt_t evt;
 
-        evt.evt_type    = BLE_ARS_C_EVT_DISCOVERY_COMPLETE;
-        evt.conn_handle = p_evt->conn_handle;
+        evt.evt_type                              = BLE_ARS_C_EVT_DISCOVERY_COMPLETE;
+        evt.conn_handle                           = p_evt->conn_handle;
+        evt.params.peer_db.assist_req_handle      = BLE_GATT_HANDLE_INVALID;
+        evt.params.peer_db.assist_req_cccd_handle = BLE_GATT_HANDLE_INVALID;
+        evt.params.peer_db.relay_handle           = BLE_GATT_HANDLE_INVALID;
 
         for (uint32_t i = 0; i < p_evt->params.discovered_db.char_count; i++)
         {
@@ -111,6 +177,10 @@ void ble_ars_on_db_disc_evt(ble_ars_c_t* p_ble_ars_c, const ble_db_discovery_evt
                     evt.params.peer_db.assist_req_cccd_handle = p_char->cccd_handle;
                     break;
 
+                case ARS_UUID_RELAY_CHAR:
+                    evt.params.peer_db.relay_handle = p_char->characteristic.handle_value;
+                    break;
+
                 default:
                     break;
             }
@@ -121,7 +191,8 @@ void ble_ars_on_db_disc_evt(ble_ars_c_t* p_ble_ars_c, const ble_db_discovery_evt
         if (p_ble_ars_c->conn_handle != BLE_CONN_HANDLE_INVALID)
         {
             if ((p_ble_ars_c->peer_ars_db.assist_req_handle      == BLE_GATT_HANDLE_INVALID) &&
-                (p_ble_ars_c->peer_ars_db.assist_req_cccd_handle == BLE_GATT_HANDLE_INVALID))
+                (p_ble_ars_c->peer_ars_db.assist_req_cccd_handle == BLE_GATT_HANDLE_INVALID) &&
+                (p_ble_ars_c->peer_ars_db.relay_handle           == BLE_GATT_HANDLE_INVALID))
             {
                 p_ble_ars_c->peer_ars_db = evt.params.peer_db;
             }
@@ -146,6 +217,7 @@ uint32_t ble_ars_c_init(ble_ars_c_t* p_ble_ars_c, ble_ars_c_init_t* p_ble_ars_c_
 
     p_ble_ars_c->peer_ars_db.assist_req_cccd_handle = BLE_GATT_HANDLE_INVALID;
     p_ble_ars_c->peer_ars_db.assist_req_handle      = BLE_GATT_HANDLE_INVALID;
+    p_ble_ars_c->peer_ars_db.relay_handle           = BLE_GATT_HANDLE_INVALID;
     p_ble_ars_c->conn_handle                        = BLE_CONN_HANDLE_INVALID;
     p_ble_ars_c->evt_handler                        = p_ble_ars_c_init->evt_handler;
     p_ble_ars_c->p_gatt_queue                       = p_ble_ars_c_init->p_gatt_queue;
@@ -171,16 +243,22 @@ void ble_ars_c_on_ble_evt(const ble_evt_t* p_ble_evt, void* p_context)
         return;
     }
 
-    ble_ars_c_t* p_ble_ars_c = (ble_ars_c_t*)p_context;
-
     switch (p_ble_evt->header.evt_id)
     {
         case BLE_GATTC_EVT_HVX:
-            on_hvx(p_ble_ars_c, p_ble_evt);
+            ble_ars_c_on_hvx(p_ble_evt, p_context);
+            break;
+
+        case BLE_GATTC_EVT_READ_RSP:
+            ble_ars_c_on_read_rsp(p_ble_evt, p_context);
+            break;
+
+        case BLE_GATTC_EVT_WRITE_RSP:
+            ble_ars_c_on_write_rsp(p_ble_evt, p_context);
             break;
 
         case BLE_GAP_EVT_DISCONNECTED:
-            on_disconnected(p_ble_ars_c, p_ble_evt);
+            ble_ars_c_on_disconnected(p_ble_evt, p_context);
             break;
 
         default:
@@ -261,7 +339,13 @@ uint32_t ble_ars_c_assist_req_get(ble_ars_c_t* p_ble_ars_c)
 }
 
 
-uint32_t ble_ars_c_assist_req_send(ble_ars_c_t* p_ble_ars_c, uint8_t status)
+/**@brief Function for writing the Assistance Request characteristic.
+ *
+ * @param[in] p_ble_ars_c Pointer to the Assistance Request Client structure.
+ * @param[in] status      Assistance Request status to write.
+ * @param[in] write_op    Write operation, BLE_GATT_OP_WRITE_CMD or BLE_GATT_OP_WRITE_REQ.
+ */
+static uint32_t assist_req_write(ble_ars_c_t* p_ble_ars_c, uint8_t status, uint8_t write_op)
 {
     VERIFY_PARAM_NOT_NULL(p_ble_ars_c);
 
@@ -283,7 +367,46 @@ uint32_t ble_ars_c_assist_req_send(ble_ars_c_t* p_ble_ars_c, uint8_t status)
     write_req.params.gattc_write.len      = sizeof(status);
     write_req.params.gattc_write.p_value  = &status;
     write_req.params.gattc_write.offset   = 0;
-    write_req.params.gattc_write.write_op = BLE_GATT_OP_WRITE_CMD; 
+    write_req.params.gattc_write.write_op = write_op;
+
+    return nrf_ble_gq_item_add(p_ble_ars_c->p_gatt_queue, &write_req, p_ble_ars_c->conn_handle);
+}
+
+
+uint32_t ble_ars_c_assist_req_send(ble_ars_c_t* p_ble_ars_c, uint8_t status)
+{
+    return assist_req_write(p_ble_ars_c, status, BLE_GATT_OP_WRITE_CMD);
+}
+
+
+uint32_t ble_ars_c_assist_req_write(ble_ars_c_t* p_ble_ars_c, uint8_t status)
+{
+    return assist_req_write(p_ble_ars_c, status, BLE_GATT_OP_WRITE_REQ);
+}
+
+uint32_t ble_ars_c_relay_write(ble_ars_c_t* p_ble_ars_c, const uint8_t* p_data, uint16_t length)
+{
+    VERIFY_PARAM_NOT_NULL(p_ble_ars_c);
+    VERIFY_PARAM_NOT_NULL(p_data);
+
+    if (p_ble_ars_c->conn_handle == BLE_CONN_HANDLE_INVALID ||
+        p_ble_ars_c->peer_ars_db.relay_handle == BLE_GATT_HANDLE_INVALID)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    nrf_ble_gq_req_t write_req;
+
+    memset(&write_req, 0, sizeof(nrf_ble_gq_req_t));
+
+    write_req.type                        = NRF_BLE_GQ_REQ_GATTC_WRITE;
+    write_req.error_handler.cb            = relay_write_error_handler;
+    write_req.error_handler.p_ctx         = p_ble_ars_c;
+    write_req.params.gattc_write.handle   = p_ble_ars_c->peer_ars_db.relay_handle;
+    write_req.params.gattc_write.len      = length;
+    write_req.params.gattc_write.p_value  = p_data;
+    write_req.params.gattc_write.offset   = 0;
+    write_req.params.gattc_write.write_op = BLE_GATT_OP_WRITE_REQ;
 
     return nrf_ble_gq_item_add(p_ble_ars_c->p_gatt_queue, &write_req, p_ble_ars_c->conn_handle);
 }
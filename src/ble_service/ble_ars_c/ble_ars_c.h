@@ -9,8 +9,9 @@
  *           module. The application can use these APIs and types to perform the discovery of
  *           Assistance Request Service at the peer and to interact with it.
  *
- * @note    The application must register this module as the BLE event observer by using the
- *          NRF_SDH_BLE_OBSERVER macro. Example:
+ * @note    Instances defined with @ref BLE_ARS_C_DEF or @ref BLE_ARS_C_ARRAY_DEF subscribe to
+ *          the BLE events they handle through the BLE event router. To register an instance as a
+ *          plain SoftDevice BLE observer instead, use @ref ble_ars_c_on_ble_evt. Example:
  *          @code
  *              ble_ars_c_t instance;
  *              NRF_SDH_BLE_OBSERVER(anything, BLE_ARS_C_BLE_OBSERVER_PRIO,
@@ -27,6 +28,7 @@
 #include "ble_srv_common.h"
 #include "nrf_ble_gq.h"
 #include "nrf_sdh_ble.h"
+#include "ble_service/ble_evt_router.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,36 +41,54 @@ extern "C" {
  * @param   _name   Name of the instance.
  * @hideinitializer
  */
-#define BLE_ARS_C_DEF(_name)                         \
-static ble_ars_c_t _name;                           \
-NRF_SDH_BLE_OBSERVER(_name ## _obs,                 \
-                     BLE_ARS_C_BLE_OBSERVER_PRIO,   \
-                     ble_ars_c_on_ble_evt, &_name)
+#define BLE_ARS_C_DEF(_name)                                                    \
+static ble_ars_c_t _name;                                                      \
+BLE_EVT_ROUTE(_name ## _hvx_route, BLE_GATTC_EVT_HVX,                          \
+              BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_hvx, &_name);          \
+BLE_EVT_ROUTE(_name ## _read_rsp_route, BLE_GATTC_EVT_READ_RSP,                \
+              BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_read_rsp, &_name);     \
+BLE_EVT_ROUTE(_name ## _write_rsp_route, BLE_GATTC_EVT_WRITE_RSP,              \
+              BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_write_rsp, &_name);    \
+BLE_EVT_ROUTE(_name ## _disconnected_route, BLE_GAP_EVT_DISCONNECTED,          \
+              BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_disconnected, &_name)
 
 /**@brief   Macro for defining multiple ble_ars_c instances.
  *
  * @param   _name   Name of the array of instances.
  * @param   _cnt    Number of instances to define.
  */
-#define BLE_ARS_C_ARRAY_DEF(_name, _cnt)                    \
-static ble_ars_c_t _name[_cnt];                            \
-NRF_SDH_BLE_OBSERVERS(_name ## _obs,                       \
-                      BLE_ARS_C_BLE_OBSERVER_PRIO,         \
-                      ble_ars_c_on_ble_evt, &_name, _cnt)
-
+#define BLE_ARS_C_ARRAY_DEF(_name, _cnt)                                                    \
+static ble_ars_c_t _name[_cnt];                                                            \
+BLE_EVT_ROUTES(_name ## _hvx_routes, BLE_GATTC_EVT_HVX,                                    \
+               BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_hvx, &_name, _cnt);               \
+BLE_EVT_ROUTES(_name ## _read_rsp_routes, BLE_GATTC_EVT_READ_RSP,                          \
+               BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_read_rsp, &_name, _cnt);          \
+BLE_EVT_ROUTES(_name ## _write_rsp_routes, BLE_GATTC_EVT_WRITE_RSP,                        \
+               BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_write_rsp, &_name, _cnt);         \
+BLE_EVT_ROUTES(_name ## _disconnected_routes, BLE_GAP_EVT_DISCONNECTED,                    \
+               BLE_ARS_C_BLE_OBSERVER_PRIO, ble_ars_c_on_disconnected, &_name, _cnt)
 
 #define ARS_UUID_BASE {0xD2, 0x5F, 0xC5, 0xB3, 0xD6, 0xBA, 0xCF, 0x84, \
                        0x1E, 0x45, 0x13, 0x14, 0x6A, 0x66, 0xD7, 0xBA}
 
 #define ARS_UUID_SERVICE         0x1000
 #define ARS_UUID_ASSIST_REQ_CHAR 0x1001
+#define ARS_UUID_RELAY_CHAR      0x1002  /**< Relay characteristic, hosted by station servers only. */
+
+#define ARS_REQ_PRIORITY_MASK     0x3F  /**< Bits of the Assistance Request value holding the request priority. Zero means no request. */
+#define ARS_REQ_FLAG_ACKNOWLEDGED 0x40  /**< Set by the server once staff acknowledged the request. */
+#define ARS_REQ_FLAG_RECEIVED     0x80  /**< Set by the server once it received the request. */
 
 
 /**@brief ARS Client event type. */
 typedef enum
 {
     BLE_ARS_C_EVT_DISCOVERY_COMPLETE = 1,  /**< Event indicating that the Assistance Request Service was discovered at the peer. */
-    BLE_ARS_C_EVT_BUTTON_NOTIFICATION      /**< Event indicating that a notification of the Assistance Request characteristic was received from the peer. */
+    BLE_ARS_C_EVT_BUTTON_NOTIFICATION,     /**< Event indicating that a notification of the Assistance Request characteristic was received from the peer. */
+    BLE_ARS_C_EVT_ASSIST_REQ_READ,         /**< Event indicating that the Assistance Request characteristic was read from the peer. */
+    BLE_ARS_C_EVT_ASSIST_REQ_WRITE_RSP,    /**< Event indicating that the peer confirmed a write of the Assistance Request characteristic made with @ref ble_ars_c_assist_req_write. */
+    BLE_ARS_C_EVT_RELAY_WRITE_RSP,         /**< Event indicating that the peer confirmed a write of the Relay characteristic made with @ref ble_ars_c_relay_write. */
+    BLE_ARS_C_EVT_RELAY_WRITE_ERROR        /**< Event indicating that the GATT queue failed to send a write of the Relay characteristic made with @ref ble_ars_c_relay_write. No response follows. */
 } ble_ars_c_evt_type_t;
 
 /**@brief Structure containing the Assistance Request state received from the peer. */
@@ -82,6 +102,7 @@ typedef struct
 {
     uint16_t assist_req_cccd_handle;  /**< Handle of the CCCD of the Assistance Request characteristic. */
     uint16_t assist_req_handle;       /**< Handle of the Assistance Request characteristic as provided by the SoftDevice. */
+    uint16_t relay_handle;            /**< Handle of the Relay characteristic, or BLE_GATT_HANDLE_INVALID if the peer is not a station server. */
 } ars_db_t;
 
 /**@brief Assistance Request Event structure. */
@@ -91,8 +112,10 @@ typedef struct
     uint16_t             conn_handle;  /**< Connection handle on which the event occured.*/
     union
     {
-        ble_assist_req_t request;      /**< Assistance Request value received. This is filled if the evt_type is @ref BLE_ARS_C_EVT_BUTTON_NOTIFICATION. */
+        ble_assist_req_t request;      /**< Assistance Request value received. This is filled if the evt_type is @ref BLE_ARS_C_EVT_BUTTON_NOTIFICATION or @ref BLE_ARS_C_EVT_ASSIST_REQ_READ. */
         ars_db_t         peer_db;      /**< Handles related to the Assistance Request Service found on the peer device. This is filled if the evt_type is @ref BLE_ARS_C_EVT_DISCOVERY_COMPLETE.*/
+        uint16_t         gatt_status;  /**< GATT status of the write. This is filled if the evt_type is @ref BLE_ARS_C_EVT_ASSIST_REQ_WRITE_RSP or @ref BLE_ARS_C_EVT_RELAY_WRITE_RSP. */
+        uint32_t         nrf_error;    /**< Error of the GATT queue. This is filled if the evt_type is @ref BLE_ARS_C_EVT_RELAY_WRITE_ERROR. */
     } params;
 } ble_ars_c_evt_t;
 
@@ -155,6 +178,47 @@ uint32_t ble_ars_c_init(ble_ars_c_t* p_ble_ars_c, ble_ars_c_init_t* p_ble_ars_c_
 void ble_ars_c_on_ble_evt(const ble_evt_t* p_ble_evt, void* p_context);
 
 
+/**@brief Function for handling Handle Value Notifications from the SoftDevice.
+ *
+ * @details If the notification is of the Assistance Request characteristic on the link of this
+ *          instance, the new value is sent to the application.
+ *
+ * @param[in] p_ble_evt     Pointer to the BLE_GATTC_EVT_HVX event.
+ * @param[in] p_context     Pointer to the assistance request client structure.
+ */
+void ble_ars_c_on_hvx(const ble_evt_t* p_ble_evt, void* p_context);
+
+
+/**@brief Function for handling Read Response events from the SoftDevice.
+ *
+ * @details If the response is a read of the Assistance Request characteristic on the link of this
+ *          instance, the value is sent to the application.
+ *
+ * @param[in] p_ble_evt     Pointer to the BLE_GATTC_EVT_READ_RSP event.
+ * @param[in] p_context     Pointer to the assistance request client structure.
+ */
+void ble_ars_c_on_read_rsp(const ble_evt_t* p_ble_evt, void* p_context);
+
+
+/**@brief Function for handling Write Response events from the SoftDevice.
+ *
+ * @param[in] p_ble_evt     Pointer to the BLE_GATTC_EVT_WRITE_RSP event.
+ * @param[in] p_context     Pointer to the assistance request client structure.
+ */
+void ble_ars_c_on_write_rsp(const ble_evt_t* p_ble_evt, void* p_context);
+
+
+/**@brief Function for handling the Disconnected event from the SoftDevice.
+ *
+ * @details If the link of this instance was disconnected, the connection handle and the peer
+ *          handles are invalidated.
+ *
+ * @param[in] p_ble_evt     Pointer to the BLE_GAP_EVT_DISCONNECTED event.
+ * @param[in] p_context     Pointer to the assistance request client structure.
+ */
+void ble_ars_c_on_disconnected(const ble_evt_t* p_ble_evt, void* p_context);
+
+
 /**@brief Function for requesting the peer to start sending notification of the Button
  *        Characteristic.
  *
@@ -208,6 +272,8 @@ uint32_t ble_ars_c_handles_assign(ble_ars_c_t*    p_ble_ars_c,
 
 
 /**@brief Function for writing the Assistance Request status to the connected server.
+ *
+ * @details The status is sent as a Write Command, so the peer does not confirm it.
  *
  * @param[in] p_ble_ars_c Pointer to the Assistance Request client structure.
  * @param[in] status      Assistance Request status to send.
@@ -219,6 +285,38 @@ uint32_t ble_ars_c_handles_assign(ble_ars_c_t*    p_ble_ars_c,
 uint32_t ble_ars_c_assist_req_send(ble_ars_c_t* p_ble_ars_c, uint8_t status);
 
 
+/**@brief Function for writing the Assistance Request status to the connected server with confirmation.
+ *
+ * @details The status is sent as a Write Request. When the peer responds, a
+ *          @ref BLE_ARS_C_EVT_ASSIST_REQ_WRITE_RSP event is sent to the application.
+ *
+ * @param[in] p_ble_ars_c Pointer to the Assistance Request client structure.
+ * @param[in] status      Assistance Request status to send.
+ *
+ * @retval NRF_ERROR_INVALID_STATE  If the connection handle is invalid.
+ * @retval err_code                 Otherwise, this API propagates the error code returned by function
+ *                                  @ref nrf_ble_gq_item_add.
+ */
+uint32_t ble_ars_c_assist_req_write(ble_ars_c_t* p_ble_ars_c, uint8_t status);
+
+
+/**@brief Function for writing a relay record to the connected station server.
+ *
+ * @details The record is sent as a Write Request. When the peer responds, a
+ *          @ref BLE_ARS_C_EVT_RELAY_WRITE_RSP event is sent to the application. If the
+ *          GATT queue fails to send it, a @ref BLE_ARS_C_EVT_RELAY_WRITE_ERROR event is sent instead.
+ *
+ * @param[in] p_ble_ars_c Pointer to the Assistance Request client structure.
+ * @param[in] p_data      Record to send. Copied by the GATT queue.
+ * @param[in] length      Record length.
+ *
+ * @retval NRF_ERROR_INVALID_STATE  If the connection handle is invalid or the peer has no Relay characteristic.
+ * @retval err_code                 Otherwise, this API propagates the error code returned by function
+ *                                  @ref nrf_ble_gq_item_add.
+ */
+uint32_t ble_ars_c_relay_write(ble_ars_c_t* p_ble_ars_c, const uint8_t* p_data, uint16_t length);
+
+
 /**@brief Function for reading the Assistance Request status from the connected server.
  *
  * @param[in] p_ble_ars_c Pointer to the Assistance Request client structure.
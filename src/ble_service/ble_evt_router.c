@@ -0,0 +1,96 @@
+#include "ble_evt_router.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "nrf_sdh_ble.h"
+#include "ble_evt_trace.h"
+#include "system_service/cycle_profile.h"
+#include "system_service/stack_monitor.h"
+
+
+NRF_SECTION_DEF(ble_evt_routes, const ble_evt_route_t);
+
+#define ROUTE_COUNT     NRF_SECTION_ITEM_COUNT(ble_evt_routes, const ble_evt_route_t)
+#define ROUTE_GET(i)    NRF_SECTION_ITEM_GET(ble_evt_routes, const ble_evt_route_t, (i))
+
+
+// Run of routes subscribed to an event id
+typedef struct {
+    uint8_t start;  // Index of the first route in the section
+    uint8_t count;  // Number of routes
+} route_run_t;
+
+static route_run_t m_index[BLE_EVT_ROUTER_EVT_ID_COUNT];
+
+
+/**@brief Function for dispatching a BLE event to the routes subscribed to its id.
+ *
+ * @param[in] p_ble_evt  Bluetooth stack event.
+ * @param[in] p_context  Unused.
+ */
+static void ble_evt_dispatch(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    uint16_t evt_id = p_ble_evt->header.evt_id;
+
+    stack_monitor_sample();
+
+#if BLE_EVT_TRACE_ENABLED
+    ble_evt_trace_record(p_ble_evt);
+#endif
+
+    if (evt_id >= BLE_EVT_ROUTER_EVT_ID_COUNT)
+    {
+        return;
+    }
+
+    const route_run_t*     p_run   = &m_index[evt_id];
+    const ble_evt_route_t* p_route = ROUTE_GET(p_run->start);
+    uint32_t               begin   = CYCLE_PROFILE_BEGIN();
+
+    for (uint32_t i = 0; i < p_run->count; i++, p_route++)
+    {
+        p_route->handler(p_ble_evt, p_route->p_context);
+    }
+
+    CYCLE_PROFILE_END(CYCLE_PROFILE_POINT_BLE_EVT, begin);
+}
+
+NRF_SDH_BLE_OBSERVER(m_ble_evt_router_obs, BLE_EVT_ROUTER_OBSERVER_PRIO, ble_evt_dispatch, NULL);
+
+
+ret_code_t ble_evt_router_init(void)
+{
+    uint32_t count = ROUTE_COUNT;
+
+    memset(m_index, 0, sizeof(m_index));
+
+    if (count > UINT8_MAX)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint16_t     evt_id = ROUTE_GET(i)->evt_id;
+        route_run_t* p_run;
+
+        if (evt_id >= BLE_EVT_ROUTER_EVT_ID_COUNT)
+        {
+            return NRF_ERROR_INVALID_DATA;
+        }
+
+        p_run = &m_index[evt_id];
+        if (p_run->count == 0)
+        {
+            p_run->start = i;
+        }
+        else if (p_run->start + p_run->count != i)
+        {
+            // The linker sorts routes by section name, which starts with the event name
+            return NRF_ERROR_INVALID_DATA;
+        }
+        p_run->count++;
+    }
+
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "ble.h"
+#include "app_util.h"
+#include "nrf_section.h"
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define BLE_EVT_ROUTER_OBSERVER_PRIO    3                        /**< Priority of the router's SoftDevice BLE observer. Routes run after the SDK modules' observers. */
+#define BLE_EVT_ROUTE_PRIO_LEVELS       5                        /**< Number of route priority levels. Must be below 10 so that the section names sort by level. */
+#define BLE_EVT_ROUTER_EVT_ID_COUNT     (BLE_L2CAP_EVT_LAST + 1) /**< Size of the event id index. Covers every BLE event of the SoftDevice. */
+
+
+/**@brief BLE event route handler type.
+ *
+ * @param[in] p_ble_evt  Bluetooth stack event.
+ * @param[in] p_context  Context registered with the route.
+ */
+typedef void (*ble_evt_route_handler_t)(const ble_evt_t* p_ble_evt, void* p_context);
+
+
+/**@brief BLE event route. Subscribes one handler to one event id. */
+typedef struct {
+    uint16_t                evt_id;     /**< Event id the handler subscribes to */
+    ble_evt_route_handler_t handler;    /**< Event handler */
+    void*                   p_context;  /**< Context passed to the handler */
+} ble_evt_route_t;
+
+
+/**@brief Macro for registering a BLE event route.
+ *
+ * @details Routes are placed in the ble_evt_routes section. The section name carries the event
+ *          name and the priority, so the linker sorts the routes of each event into one
+ *          contiguous run, ordered by priority. Lower priorities are called first.
+ *
+ * @param[in] _name     Name of the route.
+ * @param[in] _evt_id   BLE event id, given as the enumerator name (e.g. BLE_GAP_EVT_CONNECTED).
+ * @param[in] _prio     Priority of the route.
+ * @param[in] _handler  Event handler.
+ * @param[in] _context  Context passed to the handler.
+ * @hideinitializer
+ */
+#define BLE_EVT_ROUTE(_name, _evt_id, _prio, _handler, _context)                                \
+STATIC_ASSERT(_prio < BLE_EVT_ROUTE_PRIO_LEVELS, "Priority level unavailable.");                \
+NRF_SECTION_ITEM_REGISTER(CONCAT_3(ble_evt_routes_, _evt_id, CONCAT_2(_, _prio)),               \
+                          static const ble_evt_route_t _name) =                                 \
+{                                                                                               \
+    .evt_id    = _evt_id,                                                                       \
+    .handler   = _handler,                                                                      \
+    .p_context = _context                                                                       \
+}
+
+
+/**@brief Macro for registering a BLE event route for each instance of an array.
+ *
+ * @param[in] _name     Name of the route array.
+ * @param[in] _evt_id   BLE event id, given as the enumerator name.
+ * @param[in] _prio     Priority of the routes.
+ * @param[in] _handler  Event handler.
+ * @param[in] _context  Pointer to the array of instances. Each route gets one instance as context.
+ * @param[in] _cnt      Number of instances.
+ * @hideinitializer
+ */
+#define BLE_EVT_ROUTES(_name, _evt_id, _prio, _handler, _context, _cnt)                         \
+STATIC_ASSERT(_prio < BLE_EVT_ROUTE_PRIO_LEVELS, "Priority level unavailable.");                \
+NRF_SECTION_ITEM_REGISTER(CONCAT_3(ble_evt_routes_, _evt_id, CONCAT_2(_, _prio)),               \
+                          static const ble_evt_route_t _name[_cnt]) =                           \
+{                                                                                               \
+    MACRO_REPEAT_FOR(_cnt, BLE_EVT_ROUTE_SET, _evt_id, _handler, _context)                      \
+}
+
+#define BLE_EVT_ROUTE_SET(_idx, _evt_id, _handler, _context)                                    \
+{                                                                                               \
+    .evt_id    = _evt_id,                                                                       \
+    .handler   = _handler,                                                                      \
+    .p_context = _context[_idx],                                                                \
+},
+
+
+
+/**@brief Function for initializing the BLE event router.
+ *
+ * @details Builds the event id index over the registered routes. Must be called before the
+ *          first BLE event is dispatched.
+ *
+ * @retval NRF_SUCCESS            If the index was built.
+ * @retval NRF_ERROR_NO_MEM       If more routes are registered than the index can address.
+ * @retval NRF_ERROR_INVALID_DATA If the routes of an event are not contiguous in the section.
+ */
+ret_code_t ble_evt_router_init(void);
+
+
+#ifdef __cplusplus
+}
+#endif
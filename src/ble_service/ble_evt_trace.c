@@ -0,0 +1,91 @@
+#include "ble_evt_trace.h"
+#include "config.h"
+
+#include "sdk_common.h"
+
+#if BLE_EVT_TRACE_ENABLED
+#include "SEGGER_RTT.h"
+#include "time_service/wall_clock.h"
+
+
+STATIC_ASSERT(BLE_EVT_TRACE_PARAM_SIZE <= UINT8_MAX);
+
+
+static uint8_t               m_buffer[BLE_EVT_TRACE_BUFFER_SIZE];
+static uint8_t               m_seq;
+static ble_evt_trace_stats_t m_stats;
+
+
+ret_code_t ble_evt_trace_init(void)
+{
+    const uint32_t stream_hdr[] = { BLE_EVT_TRACE_MAGIC, BLE_EVT_TRACE_VERSION };
+
+    m_seq = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    // Skip mode writes a record whole or not at all, so the stream stays parseable
+    if (SEGGER_RTT_ConfigUpBuffer(BLE_EVT_TRACE_RTT_CHANNEL, "ble_evt", m_buffer, sizeof(m_buffer),
+                                  SEGGER_RTT_MODE_NO_BLOCK_SKIP) < 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    (void)SEGGER_RTT_Write(BLE_EVT_TRACE_RTT_CHANNEL, stream_hdr, sizeof(stream_hdr));
+
+    return NRF_SUCCESS;
+}
+
+
+void ble_evt_trace_record(const ble_evt_t* p_ble_evt)
+{
+    uint8_t              record[sizeof(ble_evt_trace_hdr_t) + BLE_EVT_TRACE_PARAM_SIZE];
+    ble_evt_trace_hdr_t* p_hdr     = (ble_evt_trace_hdr_t*)record;
+    uint16_t             param_len = 0;
+
+    if (p_ble_evt->header.evt_len > sizeof(ble_evt_hdr_t))
+    {
+        param_len = MIN(p_ble_evt->header.evt_len - sizeof(ble_evt_hdr_t), BLE_EVT_TRACE_PARAM_SIZE);
+    }
+
+    p_hdr->len    = (uint8_t)param_len;
+    p_hdr->seq    = m_seq++;
+    p_hdr->evt_id = p_ble_evt->header.evt_id;
+    p_hdr->ticks  = (uint32_t)wall_clock_ticks_get();
+    memcpy(&record[sizeof(ble_evt_trace_hdr_t)], &p_ble_evt->evt, param_len);
+
+    // BLE events are dispatched from a single context, so the records are written in order
+    if (SEGGER_RTT_Write(BLE_EVT_TRACE_RTT_CHANNEL, record, sizeof(ble_evt_trace_hdr_t) + param_len) == 0)
+    {
+        m_stats.dropped++;
+        return;
+    }
+    m_stats.records++;
+}
+
+
+void ble_evt_trace_stats_get(ble_evt_trace_stats_t* p_stats)
+{
+    *p_stats = m_stats;
+}
+
+
+#else
+
+
+ret_code_t ble_evt_trace_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+void ble_evt_trace_record(const ble_evt_t* p_ble_evt)
+{
+}
+
+
+void ble_evt_trace_stats_get(ble_evt_trace_stats_t* p_stats)
+{
+    memset(p_stats, 0, sizeof(*p_stats));
+}
+
+#endif
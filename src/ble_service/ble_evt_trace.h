@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "ble.h"
+#include "app_util.h"
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define BLE_EVT_TRACE_MAGIC     0x54455642  /**< "BVET", first word of the stream, followed by the trace version */
+#define BLE_EVT_TRACE_VERSION   1           /**< Version of the record layout */
+
+
+/**@brief Trace record header.
+ *
+ * @details Each BLE event is written to the RTT channel as this header followed by the first
+ *          len bytes of the event parameters (the union following ble_evt_hdr_t). For all GAP,
+ *          GATT and L2CAP events these start with the connection handle. A host replay rebuilds
+ *          the ble_evt_t from the header and the parameters, and uses the ticks as its virtual clock.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  len;       /**< Number of parameter bytes that follow, at most BLE_EVT_TRACE_PARAM_SIZE */
+    uint8_t  seq;       /**< Sequence number. A gap means records were dropped */
+    uint16_t evt_id;    /**< BLE event id */
+    uint32_t ticks;     /**< Time of the event in app_timer ticks since boot (low 32 bits), see @ref wall_clock_ticks_get */
+} ble_evt_trace_hdr_t;
+
+STATIC_ASSERT(sizeof(ble_evt_trace_hdr_t) == 8);
+
+
+/**@brief Trace statistics */
+typedef struct {
+    uint32_t records;   /**< Number of records written */
+    uint32_t dropped;   /**< Number of records dropped because the RTT buffer was full */
+} ble_evt_trace_stats_t;
+
+
+
+/**@brief Function for setting up the RTT channel of the trace and writing the stream header.
+ *
+ * @details Does nothing unless BLE_EVT_TRACE_ENABLED is set. Records are never blocked on: when
+ *          the host does not read fast enough, whole records are dropped and the sequence number
+ *          shows the gap.
+ *
+ * @retval NRF_SUCCESS              If the trace was set up or is disabled.
+ * @retval NRF_ERROR_INVALID_PARAM  If the RTT channel does not exist.
+ */
+ret_code_t ble_evt_trace_init(void);
+
+
+/**@brief Function for recording a BLE event.
+ *
+ * @details Called by the event router for every event, before the routes run.
+ *
+ * @param[in] p_ble_evt  Bluetooth stack event.
+ */
+void ble_evt_trace_record(const ble_evt_t* p_ble_evt);
+
+
+/**@brief Function for getting the trace statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void ble_evt_trace_stats_get(ble_evt_trace_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,6 @@
 #include "ble_services.h"
+#include "ble_evt_router.h"
+#include "ble_evt_trace.h"
 #include "config.h"
 
 #include "nrf.h"
@@ -19,9 +21,14 @@
 #include "peer_manager.h"
 #include "peer_manager_handler.h"
 
+#include "system_service/boot_profile.h"
+#include "system_service/error_budget.h"
+
+#define NRF_LOG_MODULE_NAME ble_services
+
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
-#include "nrf_log_default_backends.h"
+NRF_LOG_MODULE_REGISTER();
 
 
 // BLE services config storage
@@ -33,12 +40,17 @@ static struct {
     nrf_ble_qwr_t*              p_ble_qwr;
 
     ble_adv_evt_handler_t       adv_evt_handler;
-    ble_evt_handler_t           ble_evt_handler;
     db_discovery_evt_handler_t  db_disc_evt_handler;
 } ble_services_config;
 
 
-static uint16_t m_conn_handle = BLE_CONN_HANDLE_INVALID; /**< Handle of the current connection. */
+static uint16_t m_conn_handle = BLE_CONN_HANDLE_INVALID; /**< Handle of the latest peripheral connection. */
+static bool     m_advertising;                              /**< True while advertising, to restart it when a link is freed. */
+static bool     m_deferred_init_pending;                    /**< True while the connection parameters and Peer Manager are not initialized. */
+
+static ble_advdata_t            m_advdata;                                      /**< Advertising data, kept for updates. */
+static ble_advdata_manuf_data_t m_adv_manuf_data;                               /**< Manufacturer specific advertising data. */
+static uint8_t                  m_adv_manuf_payload[ADV_MANUF_DATA_MAX_SIZE];   /**< Manufacturer specific advertising data payload. */
 
 
 /**@brief Function for handling BLE-related BSP events.
@@ -149,7 +161,7 @@ static void gatt_init(void)
  */
 static void nrf_qwr_error_handler(uint32_t nrf_error)
 {
-    APP_ERROR_HANDLER(nrf_error);
+    error_budget_handler(nrf_error);
 }
 
 
@@ -159,11 +171,14 @@ static void services_init(const ble_services_init_t* p_init)
 {
     ret_code_t         err_code;
  
-    // Initialize Queued Write Module
+    // Initialize Queued Write Module, one instance per link
     nrf_ble_qwr_init_t qwr_init = {0};
     qwr_init.error_handler = nrf_qwr_error_handler;
-    err_code = nrf_ble_qwr_init(ble_services_config.p_ble_qwr, &qwr_init);
-    APP_ERROR_CHECK(err_code);
+    for (uint32_t i = 0; i < NRF_SDH_BLE_TOTAL_LINK_COUNT; i++)
+    {
+        err_code = nrf_ble_qwr_init(&ble_services_config.p_ble_qwr[i], &qwr_init);
+        APP_ERROR_CHECK(err_code);
+    }
 
     // Initialize user services
     for (unsigned int i = 0; i < p_init->gatts_init_func_count; ++i) {
@@ -191,8 +206,8 @@ static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
 
     if (p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
     {
-        err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
-        APP_ERROR_CHECK(err_code);
+        err_code = sd_ble_gap_disconnect(p_evt->conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
+        ERROR_BUDGET_CHECK(err_code, p_evt->conn_handle);
     }
 }
 
@@ -203,7 +218,7 @@ static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
  */
 static void conn_params_error_handler(uint32_t nrf_error)
 {
-    APP_ERROR_HANDLER(nrf_error);
+    error_budget_handler(nrf_error);
 }
 
 
@@ -244,10 +259,15 @@ static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
     {
         case BLE_ADV_EVT_FAST:
             NRF_LOG_INFO("Fast advertising.");
+            m_advertising = true;
             err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
             APP_ERROR_CHECK(err_code);
             break;
 
+        case BLE_ADV_EVT_IDLE:
+            m_advertising = false;
+            break;
+
         default:
             break;
     }
@@ -258,75 +278,141 @@ static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
 }
 
 
-/**@brief Function for handling BLE events.
+/**@brief Function for restarting advertising while a peripheral link is free.
+ */
+static void advertising_restart(void)
+{
+    ret_code_t err_code;
+
+    if (m_advertising || ble_conn_state_peripheral_conn_count() >= NRF_SDH_BLE_PERIPHERAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    err_code = ble_advertising_start(ble_services_config.p_ble_advertising, BLE_ADV_MODE_FAST);
+    ERROR_BUDGET_CHECK(err_code, BLE_CONN_HANDLE_INVALID);
+}
+
+
+/**@brief Function for handling the Connected event.
+ *
+ * @details Advertising continues while peripheral links are free, so that further wearables can
+ *          connect.
  *
  * @param[in]   p_ble_evt   Bluetooth stack event.
  * @param[in]   p_context   Unused.
  */
-static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
+static void on_connected(const ble_evt_t* p_ble_evt, void* p_context)
 {
-    ret_code_t err_code = NRF_SUCCESS;
-
-    // For readability
+    ret_code_t           err_code;
     const ble_gap_evt_t* p_gap_evt = &p_ble_evt->evt.gap_evt;
 
-    switch (p_ble_evt->header.evt_id)
+    // The uplink of an edge server to the station is handled by the relay
+    if (p_gap_evt->params.connected.role != BLE_GAP_ROLE_PERIPH)
     {
-        case BLE_GAP_EVT_DISCONNECTED:
-            NRF_LOG_INFO("Disconnected.");
-            break;
-
-        case BLE_GAP_EVT_CONNECTED:
-        {
-            NRF_LOG_INFO("Connected.");
-            m_conn_handle = p_gap_evt->conn_handle;
+        return;
+    }
 
-            err_code = nrf_ble_qwr_conn_handle_assign(ble_services_config.p_ble_qwr, m_conn_handle);
-            APP_ERROR_CHECK(err_code);
+    NRF_LOG_INFO("Connected, %d links.", ble_conn_state_peripheral_conn_count());
+    m_conn_handle = p_gap_evt->conn_handle;
+    m_advertising = false;  // Stopped by the connection
 
-            err_code = ble_db_discovery_start(ble_services_config.p_ble_db_discovery, p_gap_evt->conn_handle);
-            APP_ERROR_CHECK(err_code);
-        } break;
+    err_code = nrf_ble_qwr_conn_handle_assign(&ble_services_config.p_ble_qwr[ble_conn_state_conn_idx(p_gap_evt->conn_handle)],
+                                              p_gap_evt->conn_handle);
+    ERROR_BUDGET_CHECK(err_code, p_gap_evt->conn_handle);
 
-        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
-        {
-            NRF_LOG_DEBUG("PHY update request.");
-            ble_gap_phys_t const phys =
-            {
-                .rx_phys = BLE_GAP_PHY_AUTO,
-                .tx_phys = BLE_GAP_PHY_AUTO,
-            };
-            err_code = sd_ble_gap_phy_update(p_gap_evt->conn_handle, &phys);
-            APP_ERROR_CHECK(err_code);
-        } break;
+    err_code = ble_db_discovery_start(&ble_services_config.p_ble_db_discovery[ble_conn_state_conn_idx(p_gap_evt->conn_handle)],
+                                      p_gap_evt->conn_handle);
+    ERROR_BUDGET_CHECK(err_code, p_gap_evt->conn_handle);
 
-        case BLE_GATTC_EVT_TIMEOUT:
-            // Disconnect on GATT Client timeout event.
-            NRF_LOG_DEBUG("GATT Client Timeout.");
-            err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gattc_evt.conn_handle,
-                                             BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-            APP_ERROR_CHECK(err_code);
-            break;
+    advertising_restart();
+}
 
-        case BLE_GATTS_EVT_TIMEOUT:
-            // Disconnect on GATT Server timeout event.
-            NRF_LOG_DEBUG("GATT Server Timeout.");
-            err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gatts_evt.conn_handle,
-                                             BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-            APP_ERROR_CHECK(err_code);
-            break;
 
-        default:
-            // No implementation needed.
-            break;
+/**@brief Function for handling the Disconnected event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_disconnected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    if (ble_conn_state_role(p_ble_evt->evt.gap_evt.conn_handle) != BLE_GAP_ROLE_PERIPH)
+    {
+        return;
     }
 
-    if (ble_services_config.ble_evt_handler != NULL) {
-        ble_services_config.ble_evt_handler(p_ble_evt, p_context);
+    NRF_LOG_INFO("Disconnected, %d links.", ble_conn_state_peripheral_conn_count());
+    if (p_ble_evt->evt.gap_evt.conn_handle == m_conn_handle)
+    {
+        m_conn_handle = BLE_CONN_HANDLE_INVALID;
     }
+
+    // Advertising stopped when the last free link was taken
+    advertising_restart();
+}
+
+
+/**@brief Function for handling the PHY Update Request event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_phy_update_request(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ret_code_t err_code;
+
+    NRF_LOG_DEBUG("PHY update request.");
+    ble_gap_phys_t const phys =
+    {
+        .rx_phys = BLE_GAP_PHY_AUTO,
+        .tx_phys = BLE_GAP_PHY_AUTO,
+    };
+    err_code = sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &phys);
+    ERROR_BUDGET_CHECK(err_code, p_ble_evt->evt.gap_evt.conn_handle);
+}
+
+
+/**@brief Function for handling the GATT Client Timeout event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_gattc_timeout(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ret_code_t err_code;
+
+    // Disconnect on GATT Client timeout event.
+    NRF_LOG_DEBUG("GATT Client Timeout.");
+    err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gattc_evt.conn_handle,
+                                     BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+    ERROR_BUDGET_CHECK(err_code, p_ble_evt->evt.gattc_evt.conn_handle);
+}
+
+
+/**@brief Function for handling the GATT Server Timeout event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_gatts_timeout(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ret_code_t err_code;
+
+    // Disconnect on GATT Server timeout event.
+    NRF_LOG_DEBUG("GATT Server Timeout.");
+    err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gatts_evt.conn_handle,
+                                     BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+    ERROR_BUDGET_CHECK(err_code, p_ble_evt->evt.gatts_evt.conn_handle);
 }
 
 
+BLE_EVT_ROUTE(m_connected_route,          BLE_GAP_EVT_CONNECTED,          APP_BLE_OBSERVER_PRIO, on_connected,          NULL);
+BLE_EVT_ROUTE(m_disconnected_route,       BLE_GAP_EVT_DISCONNECTED,       APP_BLE_OBSERVER_PRIO, on_disconnected,       NULL);
+BLE_EVT_ROUTE(m_phy_update_request_route, BLE_GAP_EVT_PHY_UPDATE_REQUEST, APP_BLE_OBSERVER_PRIO, on_phy_update_request, NULL);
+BLE_EVT_ROUTE(m_gattc_timeout_route,      BLE_GATTC_EVT_TIMEOUT,          APP_BLE_OBSERVER_PRIO, on_gattc_timeout,      NULL);
+BLE_EVT_ROUTE(m_gatts_timeout_route,      BLE_GATTS_EVT_TIMEOUT,          APP_BLE_OBSERVER_PRIO, on_gatts_timeout,      NULL);
+
+
 /**@brief Function for initializing the BLE stack.
  *
  * @details Initializes the SoftDevice and the BLE event interrupt.
@@ -348,8 +434,12 @@ static void ble_stack_init(void)
     err_code = nrf_sdh_ble_enable(&ram_start);
     APP_ERROR_CHECK(err_code);
 
-    // Register a handler for BLE events.
-    NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, ble_evt_handler, NULL);
+    // Index the BLE event routes. The router is the application's only BLE observer.
+    err_code = ble_evt_router_init();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ble_evt_trace_init();
+    APP_ERROR_CHECK(err_code);
 }
 
 
@@ -441,30 +531,49 @@ static void advertising_init(const ble_services_init_t* p_init)
 
     memset(&init, 0, sizeof(init));
 
+    // The manufacturer specific data takes the place of the appearance to stay within 31 bytes
+    m_adv_manuf_data.company_identifier = ADV_COMPANY_ID;
+    m_adv_manuf_data.data.p_data        = m_adv_manuf_payload;
+    m_adv_manuf_data.data.size          = 0;
+
     init.advdata.name_type               = BLE_ADVDATA_FULL_NAME;
-    init.advdata.include_appearance      = true;
+    init.advdata.include_appearance      = false;
     init.advdata.flags                   = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+    init.advdata.p_manuf_specific_data   = &m_adv_manuf_data;
     //init.advdata.uuids_complete.uuid_cnt = p_init->adv_uuid_count;
     //init.advdata.uuids_complete.p_uuids  = p_init->adv_uuids;
 
-    /*
-    ble_advdata_manuf_data_t m_manuf_adv_assistance_data;
-    m_manuf_adv_assistance_data.company_identifier = COMPANY_UUID;
-    m_manuf_adv_assistance_data.data.p_data = m_assistance_adv_data;
-    m_manuf_adv_assistance_data.data.size = sizeof(m_assistance_adv_data) / sizeof(m_assistance_adv_data[0]);
-    init.advdata.p_manuf_specific_data = &m_manuf_assistance_data;
-    */
-
     init.config.ble_adv_fast_enabled  = true;
     init.config.ble_adv_fast_interval = APP_ADV_INTERVAL;
     init.config.ble_adv_fast_timeout  = APP_ADV_DURATION;
 
+    // Restarted by on_disconnected for any link, the module only restarts for the latest one
+    init.config.ble_adv_on_disconnect_disabled = true;
+
     init.evt_handler = on_adv_evt;
 
     err_code = ble_advertising_init(ble_services_config.p_ble_advertising, &init);
     APP_ERROR_CHECK(err_code);
 
     ble_advertising_conn_cfg_tag_set(ble_services_config.p_ble_advertising, APP_BLE_CONN_CFG_TAG);
+
+    m_advdata = init.advdata;
+}
+
+
+ret_code_t advertising_manuf_data_set(const uint8_t* p_data, uint8_t size)
+{
+    VERIFY_PARAM_NOT_NULL(p_data);
+
+    if (size > sizeof(m_adv_manuf_payload))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    memcpy(m_adv_manuf_payload, p_data, size);
+    m_adv_manuf_data.data.size = size;
+
+    return ble_advertising_advdata_update(ble_services_config.p_ble_advertising, &m_advdata, NULL);
 }
 
 
@@ -481,6 +590,7 @@ void advertising_start(bool erase_bonds)
     {
         ret_code_t err_code = ble_advertising_start(ble_services_config.p_ble_advertising, BLE_ADV_MODE_FAST);
         APP_ERROR_CHECK(err_code);
+        boot_profile_mark(BOOT_STAGE_FIRST_ADVERTISEMENT);
     }
 }
 
@@ -509,15 +619,38 @@ void ble_services_init(const ble_services_init_t* p_init) {
     ble_services_config.p_ble_qatt_queue    = p_init->p_ble_qatt_queue;
     ble_services_config.p_ble_qwr           = p_init->p_ble_qwr;
     ble_services_config.adv_evt_handler     = p_init->adv_evt_handler;
-    ble_services_config.ble_evt_handler     = p_init->ble_evt_handler;
     ble_services_config.db_disc_evt_handler = p_init->db_disc_evt_handler;
 
     ble_stack_init();
+    boot_profile_mark(BOOT_STAGE_BLE_STACK);
     gap_params_init();
+    boot_profile_mark(BOOT_STAGE_GAP);
     gatt_init();
+    boot_profile_mark(BOOT_STAGE_GATT);
     db_discovery_init();
+    boot_profile_mark(BOOT_STAGE_DB_DISCOVERY);
     services_init(p_init);
+    boot_profile_mark(BOOT_STAGE_SERVICES);
     advertising_init(p_init);
+    boot_profile_mark(BOOT_STAGE_ADVERTISING_INIT);
+
+    m_deferred_init_pending = true;
+    if (!p_init->fast_start) {
+        ble_services_deferred_init();
+    }
+}
+
+
+/**@brief Function for finishing the initialization of BLE services in fast start mode.
+ */
+void ble_services_deferred_init(void) {
+    if (!m_deferred_init_pending) {
+        return;
+    }
+    m_deferred_init_pending = false;
+
     conn_params_init();
+    boot_profile_mark(BOOT_STAGE_CONN_PARAMS);
     peer_manager_init();
+    boot_profile_mark(BOOT_STAGE_PEER_MANAGER);
 }
\ No newline at end of file
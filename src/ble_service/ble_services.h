@@ -23,14 +23,6 @@ extern "C" {
 typedef void (*ble_adv_evt_handler_t)(ble_adv_evt_t ble_adv_evt);
 
 
-/**@brief Function for handling BLE events.
- *
- * @param[in]   p_ble_evt   Bluetooth stack event
- * @param[in]   p_context   Unused
- */
-typedef void (*ble_evt_handler_t)(const ble_evt_t* p_ble_evt, void* p_context);
-
-
 /**@brief Function for handling database discovery events.
  *
  * @details This function is callback function to handle events from the database discovery module.
@@ -52,13 +44,12 @@ typedef void (*ble_gattc_service_init_func_t)(nrf_ble_gq_t* p_gatt_queue);
 /**@brief BLE services init structure */
 typedef struct {
     ble_advertising_t*              p_ble_advertising;      /**< Pointer to the advertising module */
-    ble_db_discovery_t*             p_ble_db_discovery;     /**< Pointer to the database discovery module */
+    ble_db_discovery_t*             p_ble_db_discovery;     /**< Pointer to an array of NRF_SDH_BLE_TOTAL_LINK_COUNT database discovery instances, one per link */
     nrf_ble_gatt_t*                 p_ble_gatt;             /**< Pointer to the GATT module */
     nrf_ble_gq_t*                   p_ble_qatt_queue;       /**< Pointer to the GATT queue module */
-    nrf_ble_qwr_t*                  p_ble_qwr;              /**< Pointer to the queued write module */
+    nrf_ble_qwr_t*                  p_ble_qwr;              /**< Pointer to an array of NRF_SDH_BLE_TOTAL_LINK_COUNT queued write module instances, one per link */
 
     ble_adv_evt_handler_t           adv_evt_handler;        /**< User event handler for advertising events */
-    ble_evt_handler_t               ble_evt_handler;        /**< User event handler for BLE events */
     db_discovery_evt_handler_t      db_disc_evt_handler;    /**< User event handler for database discovery events */
 
     ble_gatts_service_init_func_t*  gatts_init_funcs;       /**< GATT Server service init functions */
@@ -66,6 +57,8 @@ typedef struct {
 
     ble_gattc_service_init_func_t*  gattc_init_funcs;       /**< GATT Client service init functions */
     unsigned int                    gattc_init_func_count;  /**< Number of GATT Client init functions */
+
+    bool                            fast_start;             /**< Leave the connection parameters and Peer Manager to @ref ble_services_deferred_init, so that advertising can start earlier */
 } ble_services_init_t;
 
 
@@ -77,6 +70,16 @@ typedef struct {
 void ble_services_init(const ble_services_init_t* p_init);
 
 
+/**@brief Function for finishing the initialization of BLE services.
+ *
+ * @details Initializes the connection parameters module and the Peer Manager if
+ *          @ref ble_services_init_t::fast_start was set. Does nothing otherwise. Wearables that
+ *          connect before this call are not tracked by these modules, so they are not bonded and
+ *          their connection parameters are not negotiated until they reconnect.
+ */
+void ble_services_deferred_init(void);
+
+
 /**@brief Function for starting BLE advertising.
  *
  * @param[in] erase_bonds  True if existing bonds should be erased.
@@ -84,6 +87,21 @@ void ble_services_init(const ble_services_init_t* p_init);
 void advertising_start(bool erase_bonds);
 
 
+/**@brief Function for setting the payload of the manufacturer specific advertising data.
+ *
+ * @details The payload follows the company identifier @ref ADV_COMPANY_ID. The advertising data is
+ *          updated in place, also while advertising.
+ *
+ * @param[in] p_data  Payload.
+ * @param[in] size    Payload size, at most @ref ADV_MANUF_DATA_MAX_SIZE bytes.
+ *
+ * @retval NRF_SUCCESS               If the advertising data was updated.
+ * @retval NRF_ERROR_INVALID_LENGTH  If the payload is too large.
+ * @retval err_code                  Otherwise, the error returned by @ref ble_advertising_advdata_update.
+ */
+ret_code_t advertising_manuf_data_set(const uint8_t* p_data, uint8_t size);
+
+
 /**@brief Function for handling BLE-related BSP events.
  *
  * @param[in] event  BSP event.
@@ -0,0 +1,169 @@
+#include "ble_stats.h"
+
+#include "sdk_common.h"
+#include "ble_conn_state.h"
+#include "ble_service/ble_ars_c/ble_ars_c.h"
+#include "system_service/error_budget.h"
+
+#define NRF_LOG_MODULE_NAME ble_stats
+
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+NRF_LOG_MODULE_REGISTER();
+
+
+/**@brief Function for filling the Statistics characteristic value.
+ */
+static void value_get(ble_stats_t* p_stats, ble_stats_value_t* p_value)
+{
+    memset(p_value, 0, sizeof(*p_value));
+    p_stats->value_handler(p_value);
+    p_value->version = BLE_STATS_VERSION;
+}
+
+
+void ble_stats_on_write(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ble_stats_t*                 p_stats     = (ble_stats_t*)p_context;
+    const ble_gatts_evt_write_t* p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
+
+    if (p_evt_write->handle != p_stats->ctrl_char_handles.value_handle || p_evt_write->len != 1)
+    {
+        return;
+    }
+
+    switch (p_evt_write->data[0])
+    {
+        case BLE_STATS_CTRL_RESET:
+            NRF_LOG_INFO("Statistics reset by conn_handle 0x%x", p_ble_evt->evt.gatts_evt.conn_handle);
+            p_stats->reset_handler(p_ble_evt->evt.gatts_evt.conn_handle);
+            break;
+
+        default:
+            NRF_LOG_DEBUG("Unknown Control Point opcode 0x%x", p_evt_write->data[0]);
+            break;
+    }
+}
+
+
+void ble_stats_on_rw_authorize_request(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    uint32_t                                    err_code;
+    ble_stats_t*                                p_stats = (ble_stats_t*)p_context;
+    const ble_gatts_evt_rw_authorize_request_t* p_req   = &p_ble_evt->evt.gatts_evt.params.authorize_request;
+    ble_gatts_rw_authorize_reply_params_t       reply;
+    ble_stats_value_t                           value;
+
+    if (p_req->type != BLE_GATTS_AUTHORIZE_TYPE_READ ||
+        p_req->request.read.handle != p_stats->stats_char_handles.value_handle)
+    {
+        return;
+    }
+
+    value_get(p_stats, &value);
+
+    memset(&reply, 0, sizeof(reply));
+    reply.type                    = BLE_GATTS_AUTHORIZE_TYPE_READ;
+    reply.params.read.gatt_status = BLE_GATT_STATUS_SUCCESS;
+    reply.params.read.update      = 1;
+    reply.params.read.len         = sizeof(value);
+    reply.params.read.p_data      = (const uint8_t*)&value;
+
+    err_code = sd_ble_gatts_rw_authorize_reply(p_ble_evt->evt.gatts_evt.conn_handle, &reply);
+    ERROR_BUDGET_CHECK(err_code, p_ble_evt->evt.gatts_evt.conn_handle);
+}
+
+
+uint32_t ble_stats_notify(ble_stats_t* p_stats)
+{
+    uint32_t                          err_code;
+    ble_stats_value_t                 value;
+    uint16_t                          len          = sizeof(value);
+    ble_gatts_hvx_params_t            hvx_params;
+    ble_conn_state_conn_handle_list_t conn_handles = ble_conn_state_periph_handles();
+
+    value_get(p_stats, &value);
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = p_stats->stats_char_handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.p_len  = &len;
+    hvx_params.p_data = (const uint8_t*)&value;
+
+    for (uint32_t i = 0; i < conn_handles.len; i++)
+    {
+        len      = sizeof(value);
+        err_code = sd_ble_gatts_hvx(conn_handles.conn_handles[i], &hvx_params);
+
+        // Notifications not enabled, or no free buffer
+        if (err_code != NRF_SUCCESS &&
+            err_code != NRF_ERROR_INVALID_STATE &&
+            err_code != BLE_ERROR_GATTS_SYS_ATTR_MISSING &&
+            err_code != NRF_ERROR_RESOURCES)
+        {
+            return err_code;
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_stats_init(ble_stats_t* p_stats, const ble_stats_init_t* p_stats_init)
+{
+    uint32_t              err_code;
+    ble_uuid_t            ble_uuid;
+    ble_uuid128_t         ars_base_uuid = {ARS_UUID_BASE};
+    ble_add_char_params_t add_char_params;
+
+    VERIFY_PARAM_NOT_NULL(p_stats);
+    VERIFY_PARAM_NOT_NULL(p_stats_init);
+    VERIFY_PARAM_NOT_NULL(p_stats_init->value_handler);
+    VERIFY_PARAM_NOT_NULL(p_stats_init->reset_handler);
+
+    p_stats->value_handler = p_stats_init->value_handler;
+    p_stats->reset_handler = p_stats_init->reset_handler;
+
+    // Shares the base of the Assistance Request Service, for which the SoftDevice returns the existing type.
+    err_code = sd_ble_uuid_vs_add(&ars_base_uuid, &p_stats->uuid_type);
+    VERIFY_SUCCESS(err_code);
+
+    ble_uuid.type = p_stats->uuid_type;
+    ble_uuid.uuid = BLE_STATS_UUID_SERVICE;
+
+    err_code = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &ble_uuid, &p_stats->service_handle);
+    VERIFY_SUCCESS(err_code);
+
+    // Add Statistics characteristic, filled on each read.
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = BLE_STATS_UUID_STATS_CHAR;
+    add_char_params.uuid_type         = p_stats->uuid_type;
+    add_char_params.init_len          = sizeof(ble_stats_value_t);
+    add_char_params.max_len           = sizeof(ble_stats_value_t);
+    add_char_params.is_defered_read   = true;
+    add_char_params.char_props.read   = 1;
+    add_char_params.char_props.notify = 1;
+
+    add_char_params.read_access       = SEC_OPEN;
+    add_char_params.cccd_write_access = SEC_OPEN;
+
+    NRF_LOG_DEBUG("Adding Statistics characteristic.");
+    err_code = characteristic_add(p_stats->service_handle, &add_char_params, &p_stats->stats_char_handles);
+    VERIFY_SUCCESS(err_code);
+
+    // Add Control Point characteristic.
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid             = BLE_STATS_UUID_CTRL_CHAR;
+    add_char_params.uuid_type        = p_stats->uuid_type;
+    add_char_params.init_len         = 0;
+    add_char_params.max_len          = 1;
+    add_char_params.is_var_len       = true;
+    add_char_params.char_props.write = 1;
+
+    // Any phone may read the statistics, only a paired one may reset them.
+    add_char_params.read_access  = SEC_NO_ACCESS;
+    add_char_params.write_access = SEC_JUST_WORKS;
+
+    NRF_LOG_DEBUG("Adding Control Point characteristic.");
+    return characteristic_add(p_stats->service_handle, &add_char_params, &p_stats->ctrl_char_handles);
+}
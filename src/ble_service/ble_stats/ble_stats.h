@@ -0,0 +1,157 @@
+/**@file
+ *
+ * @defgroup ble_stats Server Statistics Service Server
+ * @{
+ * @brief    The Server Statistics Service exposes the live counters of the server, so that staff
+ *           can audit a server from a phone.
+ *
+ * @details  The service uses the vendor specific UUID base of the Assistance Request Service. The
+ *           Statistics characteristic is read and notified as a @ref ble_stats_value_t, which is
+ *           filled when it is read. Writing @ref BLE_STATS_CTRL_RESET to the Control Point
+ *           characteristic resets the counters. The write requires an encrypted link.
+ */
+
+#ifndef BLE_STATS_H__
+#define BLE_STATS_H__
+
+#include <stdint.h>
+#include "ble.h"
+#include "ble_srv_common.h"
+#include "ble_service/ble_evt_router.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_STATS_BLE_OBSERVER_PRIO 2
+
+#define BLE_STATS_UUID_SERVICE      0x1010
+#define BLE_STATS_UUID_STATS_CHAR   0x1011
+#define BLE_STATS_UUID_CTRL_CHAR    0x1012
+
+#define BLE_STATS_VERSION           1       /**< Version of the @ref ble_stats_value_t layout. */
+#define BLE_STATS_CTRL_RESET        0x01    /**< Control Point opcode resetting the counters. */
+
+/**@brief   Macro for defining a ble_stats instance.
+ *
+ * @param   _name   Name of the instance.
+ * @hideinitializer
+ */
+#define BLE_STATS_DEF(_name)                                                            \
+static ble_stats_t _name;                                                              \
+BLE_EVT_ROUTE(_name ## _write_route, BLE_GATTS_EVT_WRITE,                              \
+              BLE_STATS_BLE_OBSERVER_PRIO, ble_stats_on_write, &_name);                \
+BLE_EVT_ROUTE(_name ## _authorize_route, BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST,           \
+              BLE_STATS_BLE_OBSERVER_PRIO, ble_stats_on_rw_authorize_request, &_name)
+
+
+/**@brief Statistics characteristic value.
+ *
+ * @details Little endian, sized to fit a notification at the default ATT MTU. Counters saturate
+ *          and count from the last reset. Latencies saturate at UINT16_MAX ms.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  version;       /**< @ref BLE_STATS_VERSION */
+    uint8_t  links;         /**< Links currently up */
+    uint16_t connections;   /**< Links established */
+    uint16_t requests;      /**< Assistance requests queued */
+    uint16_t acks;          /**< Acknowledgements confirmed by the wearables */
+    uint16_t gatt_errors;   /**< Transient GATT and link errors handled without a reset */
+    uint16_t drops;         /**< Requests, work items, export and relay records dropped because a queue was full or a transfer failed */
+    uint16_t ack_p50_ms;    /**< Median acknowledgement latency */
+    uint16_t ack_p90_ms;    /**< 90th percentile acknowledgement latency */
+    uint16_t ack_p99_ms;    /**< 99th percentile acknowledgement latency */
+    uint16_t period_min;    /**< Minutes since the counters were reset */
+} ble_stats_value_t;
+
+STATIC_ASSERT(sizeof(ble_stats_value_t) <= BLE_GATT_ATT_MTU_DEFAULT - 3);
+
+
+/**@brief   Statistics value handler type.
+ *
+ * @details Called from the SoftDevice event handler when a peer reads the Statistics
+ *          characteristic.
+ *
+ * @param[out] p_value  Value to fill, version set.
+ */
+typedef void (* ble_stats_value_handler_t)(ble_stats_value_t* p_value);
+
+/**@brief   Reset handler type.
+ *
+ * @details Called from the SoftDevice event handler when a peer writes @ref BLE_STATS_CTRL_RESET.
+ *
+ * @param[in] conn_handle  Connection handle of the peer.
+ */
+typedef void (* ble_stats_reset_handler_t)(uint16_t conn_handle);
+
+/**@brief Server Statistics Service init structure. */
+typedef struct
+{
+    ble_stats_value_handler_t value_handler;    /**< Handler filling the Statistics characteristic value. */
+    ble_stats_reset_handler_t reset_handler;    /**< Handler resetting the counters. */
+} ble_stats_init_t;
+
+/**@brief Server Statistics Service structure. */
+typedef struct
+{
+    uint16_t                  service_handle;       /**< Handle of the Server Statistics Service as provided by the SoftDevice. */
+    ble_gatts_char_handles_t  stats_char_handles;   /**< Handles related to the Statistics characteristic. */
+    ble_gatts_char_handles_t  ctrl_char_handles;    /**< Handles related to the Control Point characteristic. */
+    uint8_t                   uuid_type;            /**< UUID type. */
+    ble_stats_value_handler_t value_handler;        /**< Handler filling the Statistics characteristic value. */
+    ble_stats_reset_handler_t reset_handler;        /**< Handler resetting the counters. */
+} ble_stats_t;
+
+
+/**@brief Function for initializing the Server Statistics Service.
+ *
+ * @param[out] p_stats       Server Statistics Service structure.
+ * @param[in]  p_stats_init  Information needed to initialize the service.
+ *
+ * @retval NRF_SUCCESS     If the service was initialized successfully.
+ * @retval NRF_ERROR_NULL  If a parameter or handler is NULL.
+ * @retval err_code        Otherwise, the error code returned by the SoftDevice.
+ */
+uint32_t ble_stats_init(ble_stats_t* p_stats, const ble_stats_init_t* p_stats_init);
+
+
+/**@brief Function for notifying the current statistics to the peers that enabled notifications.
+ *
+ * @details Only peers in the peripheral role are notified, the wearables never subscribe. A peer
+ *          without a free notification buffer is skipped until the next call.
+ *
+ * @param[in] p_stats  Server Statistics Service structure.
+ *
+ * @retval NRF_SUCCESS  If the peers that enabled notifications were notified.
+ * @retval err_code     Otherwise, the error code returned by the SoftDevice.
+ */
+uint32_t ble_stats_notify(ble_stats_t* p_stats);
+
+
+/**@brief Function for handling the Write event from the SoftDevice.
+ *
+ * @details If the Control Point characteristic was written, the opcode is executed.
+ *
+ * @param[in] p_ble_evt     Pointer to the BLE_GATTS_EVT_WRITE event.
+ * @param[in] p_context     Pointer to the Server Statistics Service structure.
+ */
+void ble_stats_on_write(const ble_evt_t* p_ble_evt, void* p_context);
+
+
+/**@brief Function for handling the Read/Write Authorization Request event from the SoftDevice.
+ *
+ * @details A read of the Statistics characteristic is answered with a freshly filled value.
+ *
+ * @param[in] p_ble_evt     Pointer to the BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST event.
+ * @param[in] p_context     Pointer to the Server Statistics Service structure.
+ */
+void ble_stats_on_rw_authorize_request(const ble_evt_t* p_ble_evt, void* p_context);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLE_STATS_H__
+
+/** @} */
@@ -0,0 +1,407 @@
+#include "roaming.h"
+#include "ble_evt_router.h"
+#include "ble_services.h"
+#include "system_service/error_budget.h"
+#include "system_service/work_queue.h"
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "ble.h"
+#include "ble_advdata.h"
+#include "ble_conn_state.h"
+#include "ble_hci.h"
+#include "nrf_atomic.h"
+#include "nrf_sdh_ble.h"
+
+#include "nrf_log.h"
+
+
+#define RSSI_SCALE          16  // Fixed point scale of the averaged RSSI
+
+
+/**@brief Roaming state of a link */
+typedef struct {
+    int16_t  rssi_avg;          /**< Averaged RSSI in dBm, scaled by RSSI_SCALE */
+    bool     rssi_valid;        /**< True once the first sample arrived */
+    uint8_t  below_count;       /**< Consecutive samples below the handover threshold */
+    uint32_t connected_ticks;   /**< app_timer tick count at which the link was established */
+    bool     settled;           /**< True once the link is older than ROAMING_MIN_LINK_TIME_MS */
+    bool     handover;          /**< True while a handover is in progress */
+    bool     wearable;          /**< True if the link is a wearable. Uplinks to other servers are not handed over */
+} link_t;
+
+
+static link_t                     m_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static roaming_handover_handler_t m_handover_handler;
+static uint8_t                    m_load;
+static int8_t                     m_adv_link_rssi = ROAMING_RSSI_NONE;
+static nrf_atomic_flag_t          m_adv_update_posted;  // An update is waiting in the work queue
+
+static bool                       m_scanning;
+static bool                       m_peer_seen;          // Another server with free links was heard
+static uint32_t                   m_peer_seen_ticks;
+static uint8_t                    m_scan_buffer_data[BLE_GAP_SCAN_BUFFER_MIN];
+static ble_data_t                 m_scan_buffer = {m_scan_buffer_data, BLE_GAP_SCAN_BUFFER_MIN};
+
+static const ble_gap_scan_params_t m_scan_params =
+{
+    .active        = 0,
+    .interval      = ROAMING_SCAN_INTERVAL,
+    .window        = ROAMING_SCAN_WINDOW,
+    .timeout       = BLE_GAP_SCAN_TIMEOUT_UNLIMITED,
+    .scan_phys     = BLE_GAP_PHY_1MBPS,
+    .filter_policy = BLE_GAP_SCAN_FP_ACCEPT_ALL,
+};
+
+
+static link_t* link_get(uint16_t conn_handle)
+{
+    uint16_t conn_idx = ble_conn_state_conn_idx(conn_handle);
+
+    if (conn_idx >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return NULL;
+    }
+    return &m_links[conn_idx];
+}
+
+
+/**@brief Function for getting the averaged RSSI of the weakest link.
+ */
+static int8_t weakest_link_rssi(void)
+{
+    int16_t rssi = ROAMING_RSSI_NONE;
+
+    for (uint32_t i = 0; i < NRF_SDH_BLE_TOTAL_LINK_COUNT; i++)
+    {
+        if (m_links[i].rssi_valid)
+        {
+            rssi = MIN(rssi, m_links[i].rssi_avg / RSSI_SCALE);
+        }
+    }
+    return (int8_t)rssi;
+}
+
+
+/**@brief Function for updating the roaming advertising data.
+ *
+ * @details Only called from the main loop, so the payload is never encoded from two contexts at once.
+ */
+static void adv_data_update(void)
+{
+    ret_code_t         err_code;
+    uint32_t           links = ble_conn_state_peripheral_conn_count();
+    roaming_adv_data_t data;
+
+    m_adv_link_rssi = weakest_link_rssi();
+
+    data.id         = ROAMING_ADV_ID;
+    data.load       = m_load;
+    data.free_links = (links < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT) ? NRF_SDH_BLE_PERIPHERAL_LINK_COUNT - links : 0;
+    data.link_rssi  = m_adv_link_rssi;
+    data.admit_rssi = ROAMING_HANDOVER_RSSI_DBM + ROAMING_ADMIT_MARGIN_DB;
+
+    err_code = advertising_manuf_data_set((const uint8_t*)&data, sizeof(data));
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Roaming advertising data not updated: 0x%x", err_code);
+    }
+}
+
+
+/**@brief Function for requesting an update of the roaming advertising data from the BLE event handlers.
+ *
+ * @details Requests are coalesced until the main loop runs the update.
+ */
+static void adv_data_update_post(void)
+{
+    if (nrf_atomic_flag_set_fetch(&m_adv_update_posted) == 0 &&
+        work_queue_post(WORK_QUEUE_TYPE_ROAMING_ADV_UPDATE, BLE_CONN_HANDLE_INVALID, 0, 0) != NRF_SUCCESS)
+    {
+        (void)nrf_atomic_flag_clear(&m_adv_update_posted);
+        NRF_LOG_WARNING("Work queue full, roaming advertising data not updated");
+    }
+}
+
+
+static void adv_update_work(const work_queue_item_t* p_item)
+{
+    (void)nrf_atomic_flag_clear(&m_adv_update_posted);
+    adv_data_update();
+}
+
+
+/**@brief Function for checking whether another server with free links was heard recently.
+ */
+static bool peer_available(void)
+{
+    if (m_peer_seen &&
+        app_timer_cnt_diff_compute(app_timer_cnt_get(), m_peer_seen_ticks) >= APP_TIMER_TICKS(ROAMING_PEER_TIMEOUT_MS))
+    {
+        m_peer_seen = false;
+    }
+    return m_peer_seen;
+}
+
+
+static void scan_start(void)
+{
+    ret_code_t err_code;
+
+    if (m_scanning)
+    {
+        return;
+    }
+
+    err_code = sd_ble_gap_scan_start(&m_scan_params, &m_scan_buffer);
+    if (err_code == NRF_SUCCESS)
+    {
+        m_scanning = true;
+    }
+    else
+    {
+        NRF_LOG_WARNING("Scanning for other servers failed: 0x%x", err_code);
+    }
+}
+
+
+static void scan_stop(void)
+{
+    if (m_scanning)
+    {
+        (void)sd_ble_gap_scan_stop();
+        m_scanning  = false;
+        m_peer_seen = false;
+    }
+}
+
+
+/**@brief Function for scanning for other servers while a link is below the handover threshold.
+ *
+ * @details Leaves the scanner to other users, such as the relay uplink, while all links are good.
+ */
+static void scan_update(void)
+{
+    for (uint32_t i = 0; i < NRF_SDH_BLE_TOTAL_LINK_COUNT; i++)
+    {
+        if (m_links[i].below_count > 0)
+        {
+            scan_start();
+            return;
+        }
+    }
+    scan_stop();
+}
+
+
+/**@brief Function for handling the Connected event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_connected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    ret_code_t err_code;
+    uint16_t   conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+    link_t*    p_link      = link_get(conn_handle);
+
+    if (p_link == NULL ||
+        m_handover_handler == NULL ||
+        p_ble_evt->evt.gap_evt.params.connected.role != BLE_GAP_ROLE_PERIPH)
+    {
+        return;
+    }
+
+    memset(p_link, 0, sizeof(link_t));
+    p_link->connected_ticks = app_timer_cnt_get();
+    p_link->wearable        = true;
+
+    err_code = sd_ble_gap_rssi_start(conn_handle, ROAMING_RSSI_THRESHOLD_DBM, ROAMING_RSSI_SKIP_COUNT);
+    ERROR_BUDGET_CHECK(err_code, conn_handle);
+
+    adv_data_update_post();
+}
+
+
+/**@brief Function for handling the Disconnected event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_disconnected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    link_t* p_link = link_get(p_ble_evt->evt.gap_evt.conn_handle);
+
+    if (p_link == NULL || !p_link->wearable)
+    {
+        return;
+    }
+
+    memset(p_link, 0, sizeof(link_t));
+
+    scan_update();
+    adv_data_update_post();
+}
+
+
+/**@brief Function for handling the RSSI Changed event.
+ *
+ * @details Averages the RSSI of the link and starts a handover once the average stayed below the
+ *          threshold for ROAMING_HANDOVER_SAMPLES samples.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_rssi_changed(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    uint16_t conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+    int16_t  rssi        = p_ble_evt->evt.gap_evt.params.rssi_changed.rssi;
+    link_t*  p_link      = link_get(conn_handle);
+
+    if (p_link == NULL || !p_link->wearable)
+    {
+        return;
+    }
+
+    if (!p_link->rssi_valid)
+    {
+        p_link->rssi_avg   = rssi * RSSI_SCALE;
+        p_link->rssi_valid = true;
+    }
+    else
+    {
+        p_link->rssi_avg += (rssi * RSSI_SCALE - p_link->rssi_avg) / (1 << ROAMING_RSSI_EWMA_SHIFT);
+    }
+
+    if (p_link->rssi_avg / RSSI_SCALE < ROAMING_HANDOVER_RSSI_DBM)
+    {
+        p_link->below_count = MIN(p_link->below_count + 1, UINT8_MAX);
+    }
+    else
+    {
+        p_link->below_count = 0;
+    }
+    scan_update();
+
+    // Keep the advertised hint current without updating the advertising data on every sample
+    if (abs(weakest_link_rssi() - m_adv_link_rssi) >= ROAMING_RSSI_HINT_STEP_DB)
+    {
+        adv_data_update_post();
+    }
+
+    if (!p_link->settled &&
+        app_timer_cnt_diff_compute(app_timer_cnt_get(), p_link->connected_ticks) >= APP_TIMER_TICKS(ROAMING_MIN_LINK_TIME_MS))
+    {
+        p_link->settled = true;
+    }
+
+    if (p_link->handover ||
+        !p_link->settled ||
+        p_link->below_count < ROAMING_HANDOVER_SAMPLES ||
+        !peer_available())
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Handing over conn_handle 0x%x (RSSI %d dBm)", conn_handle, p_link->rssi_avg / RSSI_SCALE);
+    p_link->handover = true;
+    m_handover_handler(conn_handle, (int8_t)(p_link->rssi_avg / RSSI_SCALE));
+}
+
+
+/**@brief Function for handling advertising reports of other servers.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_adv_report(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    const ble_gap_evt_adv_report_t* p_report = &p_ble_evt->evt.gap_evt.params.adv_report;
+    uint16_t                        offset   = 0;
+    uint16_t                        len;
+
+    len = ble_advdata_search(p_report->data.p_data, p_report->data.len, &offset,
+                             BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA);
+    if (len >= sizeof(uint16_t) + sizeof(roaming_adv_data_t))
+    {
+        const uint8_t*            p_data = &p_report->data.p_data[offset];
+        const roaming_adv_data_t* p_peer = (const roaming_adv_data_t*)&p_data[sizeof(uint16_t)];
+
+        if (uint16_decode(p_data) == ADV_COMPANY_ID &&
+            p_peer->id == ROAMING_ADV_ID &&
+            p_peer->free_links > 0)
+        {
+            m_peer_seen       = true;
+            m_peer_seen_ticks = app_timer_cnt_get();
+        }
+    }
+
+    // The SoftDevice pauses scanning after each report
+    if (m_scanning)
+    {
+        (void)sd_ble_gap_scan_start(NULL, &m_scan_buffer);
+    }
+}
+
+BLE_EVT_ROUTE(m_connected_route,    BLE_GAP_EVT_CONNECTED,    APP_BLE_OBSERVER_PRIO, on_connected,    NULL);
+BLE_EVT_ROUTE(m_disconnected_route, BLE_GAP_EVT_DISCONNECTED, APP_BLE_OBSERVER_PRIO, on_disconnected, NULL);
+BLE_EVT_ROUTE(m_rssi_changed_route, BLE_GAP_EVT_RSSI_CHANGED, APP_BLE_OBSERVER_PRIO, on_rssi_changed, NULL);
+BLE_EVT_ROUTE(m_adv_report_route,   BLE_GAP_EVT_ADV_REPORT,   APP_BLE_OBSERVER_PRIO, on_adv_report,   NULL);
+
+
+ret_code_t roaming_init(roaming_handover_handler_t handover_handler)
+{
+    VERIFY_PARAM_NOT_NULL(handover_handler);
+
+    memset(m_links, 0, sizeof(m_links));
+    m_handover_handler = handover_handler;
+    m_load             = 0;
+
+    work_queue_handler_set(WORK_QUEUE_TYPE_ROAMING_ADV_UPDATE, adv_update_work);
+    adv_data_update();
+
+    return NRF_SUCCESS;
+}
+
+
+void roaming_load_set(uint32_t load)
+{
+    uint8_t new_load = (uint8_t)MIN(load, UINT8_MAX);
+
+    if (new_load != m_load)
+    {
+        m_load = new_load;
+        adv_data_update();
+    }
+}
+
+
+bool roaming_handover_pending(uint16_t conn_handle)
+{
+    link_t* p_link = link_get(conn_handle);
+
+    return (p_link != NULL) && p_link->handover;
+}
+
+
+void roaming_handover_complete(uint16_t conn_handle)
+{
+    ret_code_t err_code;
+
+    err_code = sd_ble_gap_disconnect(conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+    ERROR_BUDGET_CHECK(err_code, conn_handle);
+}
+
+
+void roaming_handover_defer(uint16_t conn_handle)
+{
+    link_t* p_link = link_get(conn_handle);
+
+    if (p_link != NULL)
+    {
+        p_link->handover = false;
+    }
+}
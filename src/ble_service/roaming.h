@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "app_util.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define ROAMING_ADV_ID          0xA1    /**< First payload byte of a server's manufacturer specific advertising data. Identifies assistance servers and the payload version. */
+#define ROAMING_RSSI_NONE       INT8_MAX /**< Link RSSI advertised while the server has no links */
+
+
+/**@brief Roaming payload of the manufacturer specific advertising data
+ *
+ * @details Follows the company identifier (@ref ADV_COMPANY_ID). Wearables pick the server with the
+ *          most free links and the lowest load among those they receive at @ref admit_rssi or better.
+ */
+typedef PACKED_STRUCT {
+    uint8_t id;             /**< @ref ROAMING_ADV_ID */
+    uint8_t load;           /**< Number of pending requests */
+    uint8_t free_links;     /**< Number of wearables the server can still accept */
+    int8_t  link_rssi;      /**< Averaged RSSI of the server's weakest link in dBm, or @ref ROAMING_RSSI_NONE */
+    int8_t  admit_rssi;     /**< Minimum advertising RSSI in dBm at which a wearable should connect */
+} roaming_adv_data_t;
+
+STATIC_ASSERT(sizeof(roaming_adv_data_t) == 5);
+
+
+/**@brief Handover handler type.
+ *
+ * @details Called once the averaged RSSI of a link stayed below @ref ROAMING_HANDOVER_RSSI_DBM and
+ *          another server with free links was heard recently. The application saves the link's
+ *          state on the wearable and then calls @ref roaming_handover_complete, or calls
+ *          @ref roaming_handover_defer to try again on the next RSSI sample.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] rssi_dbm     Averaged RSSI of the link.
+ */
+typedef void (*roaming_handover_handler_t)(uint16_t conn_handle, int8_t rssi_dbm);
+
+
+
+/**@brief Function for initializing roaming.
+ *
+ * @details Must be called from main after the BLE services and the work queue are initialized.
+ *          Sets the roaming advertising data, which is only updated from the main loop afterwards.
+ *          RSSI monitoring starts with the first wearable link. Other servers are scanned for
+ *          while a link is below the handover threshold.
+ *
+ * @param[in] handover_handler  Handover handler.
+ */
+ret_code_t roaming_init(roaming_handover_handler_t handover_handler);
+
+
+/**@brief Function for setting the load advertised to wearables.
+ *
+ * @details Must be called from the main loop, which owns the roaming advertising data.
+ *
+ * @param[in] load  Number of pending requests.
+ */
+void roaming_load_set(uint32_t load);
+
+
+/**@brief Function for checking whether a handover of a link is in progress.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ */
+bool roaming_handover_pending(uint16_t conn_handle);
+
+
+/**@brief Function for completing a handover by disconnecting the wearable.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ */
+void roaming_handover_complete(uint16_t conn_handle);
+
+
+/**@brief Function for postponing a handover to the next RSSI sample.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ */
+void roaming_handover_defer(uint16_t conn_handle);
+
+
+#ifdef __cplusplus
+}
+#endif
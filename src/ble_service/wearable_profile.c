@@ -0,0 +1,403 @@
+#include "wearable_profile.h"
+#include "ble_evt_router.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "ble.h"
+#include "ble_bas_c.h"
+#include "ble_dis_c.h"
+#include "ble_conn_state.h"
+#include "nrf_sdh_ble.h"
+#include "time_service/wall_clock.h"
+
+#include "nrf_log.h"
+
+
+/**@brief Initial reads of a wearable, issued back to back once the discovery finished */
+typedef enum {
+    READ_ASSIST_REQ,
+    READ_BATTERY_LEVEL,
+    READ_MODEL,
+    READ_FW_REV,
+    READ_COUNT
+} read_t;
+
+
+/**@brief Profile state of a link */
+typedef struct {
+    bool               wearable;                    /**< True if the link is a wearable. Uplinks to other servers have no profile */
+    bool               ready;                       /**< True once the profile was reported */
+    uint64_t           connected_ticks;             /**< Wall clock tick count at which the link was established */
+    uint16_t           handles[READ_COUNT];         /**< Handles of the initial reads, BLE_GATT_HANDLE_INVALID if the peer lacks the characteristic */
+    uint8_t            pending;                     /**< Bit mask of the reads awaiting a response */
+    wearable_profile_t profile;
+} link_t;
+
+
+BLE_ARS_C_ARRAY_DEF(m_ars_c, NRF_SDH_BLE_TOTAL_LINK_COUNT);
+
+static ble_bas_c_t m_bas_c[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+BLE_EVT_ROUTES(m_bas_c_hvx_routes,          BLE_GATTC_EVT_HVX,        BLE_BAS_C_BLE_OBSERVER_PRIO, ble_bas_c_on_ble_evt, &m_bas_c, NRF_SDH_BLE_TOTAL_LINK_COUNT);
+BLE_EVT_ROUTES(m_bas_c_read_rsp_routes,     BLE_GATTC_EVT_READ_RSP,   BLE_BAS_C_BLE_OBSERVER_PRIO, ble_bas_c_on_ble_evt, &m_bas_c, NRF_SDH_BLE_TOTAL_LINK_COUNT);
+BLE_EVT_ROUTES(m_bas_c_disconnected_routes, BLE_GAP_EVT_DISCONNECTED, BLE_BAS_C_BLE_OBSERVER_PRIO, ble_bas_c_on_ble_evt, &m_bas_c, NRF_SDH_BLE_TOTAL_LINK_COUNT);
+
+static ble_dis_c_t m_dis_c[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+BLE_EVT_ROUTES(m_dis_c_read_rsp_routes,     BLE_GATTC_EVT_READ_RSP,   BLE_DIS_C_BLE_OBSERVER_PRIO, ble_dis_c_on_ble_evt, &m_dis_c, NRF_SDH_BLE_TOTAL_LINK_COUNT);
+BLE_EVT_ROUTES(m_dis_c_disconnected_routes, BLE_GAP_EVT_DISCONNECTED, BLE_DIS_C_BLE_OBSERVER_PRIO, ble_dis_c_on_ble_evt, &m_dis_c, NRF_SDH_BLE_TOTAL_LINK_COUNT);
+
+static ble_dis_c_char_type_t m_dis_char_types[] = {BLE_DIS_C_MODEL_NUM, BLE_DIS_C_FW_REV};
+
+static link_t                           m_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static ble_ars_c_evt_handler_t          m_ars_evt_handler;
+static wearable_profile_ready_handler_t m_ready_handler;
+static ble_srv_error_handler_t          m_error_handler;
+
+
+static link_t* link_get(uint16_t conn_handle)
+{
+    uint16_t conn_idx = ble_conn_state_conn_idx(conn_handle);
+
+    if (conn_idx >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return NULL;
+    }
+    return &m_links[conn_idx];
+}
+
+
+static uint32_t ms_since_connect(const link_t* p_link)
+{
+    return (uint32_t)wall_clock_ticks_to_ms(wall_clock_ticks_get() - p_link->connected_ticks);
+}
+
+
+static void error_report(ret_code_t err_code)
+{
+    if (err_code != NRF_SUCCESS && m_error_handler != NULL)
+    {
+        m_error_handler(err_code);
+    }
+}
+
+
+/**@brief Function for reporting the profile of a link once no read is pending.
+ */
+static void ready_check(link_t* p_link)
+{
+    if (p_link->pending != 0 || p_link->ready)
+    {
+        return;
+    }
+
+    p_link->ready            = true;
+    p_link->profile.ready_ms = ms_since_connect(p_link);
+
+    if (m_ready_handler != NULL)
+    {
+        m_ready_handler(&p_link->profile);
+    }
+}
+
+
+/**@brief Function for issuing the initial reads of a link back to back.
+ *
+ * @details All reads go into the GATT queue at once, so the peer answers them in consecutive
+ *          connection events instead of one read per application round trip.
+ */
+static void reads_queue(uint16_t conn_handle, link_t* p_link)
+{
+    uint16_t   conn_idx = ble_conn_state_conn_idx(conn_handle);
+    ret_code_t err_code;
+
+    p_link->profile.discovery_ms = ms_since_connect(p_link);
+
+    for (uint32_t read = 0; read < READ_COUNT; read++)
+    {
+        if (p_link->handles[read] == BLE_GATT_HANDLE_INVALID)
+        {
+            continue;
+        }
+
+        switch (read)
+        {
+            case READ_ASSIST_REQ:
+                err_code = ble_ars_c_assist_req_get(&m_ars_c[conn_idx]);
+                break;
+
+            case READ_BATTERY_LEVEL:
+                err_code = ble_bas_c_bl_read(&m_bas_c[conn_idx]);
+                break;
+
+            case READ_MODEL:
+                err_code = ble_dis_c_read(&m_dis_c[conn_idx], BLE_DIS_C_MODEL_NUM);
+                break;
+
+            default:
+                err_code = ble_dis_c_read(&m_dis_c[conn_idx], BLE_DIS_C_FW_REV);
+                break;
+        }
+
+        if (err_code == NRF_SUCCESS)
+        {
+            p_link->pending |= 1 << read;
+        }
+        else
+        {
+            error_report(err_code);
+        }
+    }
+
+    ready_check(p_link);
+}
+
+
+static void string_copy(char* p_dst, const ble_dis_c_string_t* p_src)
+{
+    uint32_t len = MIN(p_src->len, WEARABLE_PROFILE_STR_SIZE - 1);
+
+    memcpy(p_dst, p_src->p_data, len);
+    p_dst[len] = '\0';
+}
+
+
+static void ars_c_evt_handler(ble_ars_c_t* p_ars_c, ble_ars_c_evt_t* p_evt)
+{
+    link_t* p_link = link_get(p_evt->conn_handle);
+
+    if (p_evt->evt_type == BLE_ARS_C_EVT_DISCOVERY_COMPLETE)
+    {
+        error_report(ble_ars_c_handles_assign(p_ars_c, p_evt->conn_handle, &p_evt->params.peer_db));
+
+        if (p_link != NULL && p_link->wearable)
+        {
+            p_link->handles[READ_ASSIST_REQ] = p_evt->params.peer_db.assist_req_handle;
+        }
+    }
+
+    m_ars_evt_handler(p_ars_c, p_evt);
+}
+
+
+static void bas_c_evt_handler(ble_bas_c_t* p_bas_c, ble_bas_c_evt_t* p_evt)
+{
+    link_t* p_link = link_get(p_evt->conn_handle);
+
+    switch (p_evt->evt_type)
+    {
+        case BLE_BAS_C_EVT_DISCOVERY_COMPLETE:
+            error_report(ble_bas_c_handles_assign(p_bas_c, p_evt->conn_handle, &p_evt->params.bas_db));
+
+            if (p_link != NULL && p_link->wearable)
+            {
+                p_link->handles[READ_BATTERY_LEVEL] = p_evt->params.bas_db.bl_handle;
+            }
+            break;
+
+        case BLE_BAS_C_EVT_BATT_READ_RESP:
+        case BLE_BAS_C_EVT_BATT_NOTIFICATION:
+            if (p_link != NULL)
+            {
+                p_link->profile.battery_level = p_evt->params.battery_level;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+static void dis_c_evt_handler(ble_dis_c_t* p_dis_c, const ble_dis_c_evt_t* p_evt)
+{
+    link_t* p_link = link_get(p_evt->conn_handle);
+
+    switch (p_evt->evt_type)
+    {
+        case BLE_DIS_C_EVT_DISCOVERY_COMPLETE:
+            error_report(ble_dis_c_handles_assign(p_dis_c, p_evt->conn_handle,
+                                                  p_evt->params.disc_complete.handles));
+
+            if (p_link != NULL && p_link->wearable)
+            {
+                p_link->handles[READ_MODEL]  = p_evt->params.disc_complete.handles[BLE_DIS_C_MODEL_NUM];
+                p_link->handles[READ_FW_REV] = p_evt->params.disc_complete.handles[BLE_DIS_C_FW_REV];
+            }
+            break;
+
+        case BLE_DIS_C_EVT_DIS_C_READ_RSP:
+            if (p_link == NULL)
+            {
+                break;
+            }
+            if (p_evt->params.read_rsp.char_type == BLE_DIS_C_MODEL_NUM)
+            {
+                string_copy(p_link->profile.model, &p_evt->params.read_rsp.content.string);
+            }
+            else if (p_evt->params.read_rsp.char_type == BLE_DIS_C_FW_REV)
+            {
+                string_copy(p_link->profile.fw_rev, &p_evt->params.read_rsp.content.string);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+static void on_connected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    uint16_t conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+    uint16_t conn_idx    = ble_conn_state_conn_idx(conn_handle);
+    link_t*  p_link      = link_get(conn_handle);
+
+    if (p_link == NULL)
+    {
+        return;
+    }
+
+    memset(p_link, 0, sizeof(link_t));
+    p_link->wearable              = (p_ble_evt->evt.gap_evt.params.connected.role == BLE_GAP_ROLE_PERIPH);
+    p_link->connected_ticks       = wall_clock_ticks_get();
+    p_link->profile.conn_handle   = conn_handle;
+    p_link->profile.battery_level = WEARABLE_PROFILE_BATTERY_UNKNOWN;
+
+    for (uint32_t read = 0; read < READ_COUNT; read++)
+    {
+        p_link->handles[read] = BLE_GATT_HANDLE_INVALID;
+    }
+
+    // Registers the link with the GATT queue. The peer handles follow the discovery
+    error_report(ble_ars_c_handles_assign(&m_ars_c[conn_idx], conn_handle, NULL));
+    error_report(ble_bas_c_handles_assign(&m_bas_c[conn_idx], conn_handle, NULL));
+    error_report(ble_dis_c_handles_assign(&m_dis_c[conn_idx], conn_handle, NULL));
+}
+
+
+static void on_disconnected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    link_t* p_link = link_get(p_ble_evt->evt.gap_evt.conn_handle);
+
+    if (p_link != NULL)
+    {
+        memset(p_link, 0, sizeof(link_t));
+    }
+}
+
+
+/**@brief Function for clearing the pending read of a response. Failed reads count as done.
+ */
+static void on_read_rsp(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    const ble_gattc_evt_t* p_gattc_evt = &p_ble_evt->evt.gattc_evt;
+    link_t*                p_link      = link_get(p_gattc_evt->conn_handle);
+    uint16_t               handle;
+
+    if (p_link == NULL || p_link->pending == 0)
+    {
+        return;
+    }
+
+    handle = (p_gattc_evt->gatt_status == BLE_GATT_STATUS_SUCCESS) ? p_gattc_evt->params.read_rsp.handle
+                                                                     : p_gattc_evt->error_handle;
+
+    for (uint32_t read = 0; read < READ_COUNT; read++)
+    {
+        if ((p_link->pending & (1 << read)) && p_link->handles[read] == handle)
+        {
+            p_link->pending &= ~(1 << read);
+            ready_check(p_link);
+            break;
+        }
+    }
+}
+
+// Runs after the clients, which store the read values
+BLE_EVT_ROUTE(m_connected_route,    BLE_GAP_EVT_CONNECTED,    APP_BLE_OBSERVER_PRIO, on_connected,    NULL);
+BLE_EVT_ROUTE(m_disconnected_route, BLE_GAP_EVT_DISCONNECTED, APP_BLE_OBSERVER_PRIO, on_disconnected, NULL);
+BLE_EVT_ROUTE(m_read_rsp_route,     BLE_GATTC_EVT_READ_RSP,   APP_BLE_OBSERVER_PRIO, on_read_rsp,     NULL);
+
+
+ret_code_t wearable_profile_init(const wearable_profile_init_t* p_init)
+{
+    ret_code_t       err_code;
+    ble_ars_c_init_t ars_c_init;
+    ble_bas_c_init_t bas_c_init;
+    ble_dis_c_init_t dis_c_init;
+
+    VERIFY_PARAM_NOT_NULL(p_init);
+    VERIFY_PARAM_NOT_NULL(p_init->ars_evt_handler);
+
+    m_ars_evt_handler = p_init->ars_evt_handler;
+    m_ready_handler   = p_init->ready_handler;
+    m_error_handler   = p_init->error_handler;
+
+    ars_c_init.evt_handler   = ars_c_evt_handler;
+    ars_c_init.p_gatt_queue  = p_init->p_gatt_queue;
+    ars_c_init.error_handler = p_init->error_handler;
+
+    bas_c_init.evt_handler   = bas_c_evt_handler;
+    bas_c_init.p_gatt_queue  = p_init->p_gatt_queue;
+    bas_c_init.error_handler = p_init->error_handler;
+
+    memset(&dis_c_init, 0, sizeof(dis_c_init));
+    dis_c_init.evt_handler            = dis_c_evt_handler;
+    dis_c_init.p_gatt_queue           = p_init->p_gatt_queue;
+    dis_c_init.error_handler          = p_init->error_handler;
+    dis_c_init.char_group.p_char_type = m_dis_char_types;
+    dis_c_init.char_group.size        = ARRAY_SIZE(m_dis_char_types);
+
+    // Every client registers its service UUID with the discovery module up front, so a single
+    // discovery pass per link finds all of them
+    for (uint32_t i = 0; i < NRF_SDH_BLE_TOTAL_LINK_COUNT; i++)
+    {
+        err_code = ble_ars_c_init(&m_ars_c[i], &ars_c_init);
+        VERIFY_SUCCESS(err_code);
+
+        err_code = ble_bas_c_init(&m_bas_c[i], &bas_c_init);
+        VERIFY_SUCCESS(err_code);
+
+        err_code = ble_dis_c_init(&m_dis_c[i], &dis_c_init);
+        VERIFY_SUCCESS(err_code);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+void wearable_profile_on_db_disc_evt(ble_db_discovery_evt_t* p_evt)
+{
+    uint16_t conn_idx = ble_conn_state_conn_idx(p_evt->conn_handle);
+    link_t*  p_link   = link_get(p_evt->conn_handle);
+
+    if (p_link == NULL)
+    {
+        return;
+    }
+
+    if (p_evt->evt_type == BLE_DB_DISCOVERY_AVAILABLE)
+    {
+        // Every registered service was searched for, so all present handles are known
+        if (p_link->wearable)
+        {
+            reads_queue(p_evt->conn_handle, p_link);
+        }
+        return;
+    }
+
+    ble_ars_on_db_disc_evt(&m_ars_c[conn_idx], p_evt);
+    ble_bas_on_db_disc_evt(&m_bas_c[conn_idx], p_evt);
+    ble_dis_c_on_db_disc_evt(&m_dis_c[conn_idx], p_evt);
+}
+
+
+ble_ars_c_t* wearable_profile_ars_c_get(uint16_t conn_handle)
+{
+    uint16_t conn_idx = ble_conn_state_conn_idx(conn_handle);
+
+    if (conn_idx >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return NULL;
+    }
+    return &m_ars_c[conn_idx];
+}
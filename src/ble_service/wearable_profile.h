@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "ble_db_discovery.h"
+#include "ble_srv_common.h"
+#include "nrf_ble_gq.h"
+#include "ble_service/ble_ars_c/ble_ars_c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define WEARABLE_PROFILE_STR_SIZE           21      /**< Size of the string buffers, including the terminator. Fits a default MTU read. */
+#define WEARABLE_PROFILE_BATTERY_UNKNOWN    0xFF    /**< Battery level of wearables without a Battery Service */
+
+
+/**@brief Wearable profile */
+typedef struct {
+    uint16_t conn_handle;                           /**< Connection handle of the wearable */
+    uint8_t  battery_level;                         /**< Battery level in percent, or @ref WEARABLE_PROFILE_BATTERY_UNKNOWN */
+    char     model[WEARABLE_PROFILE_STR_SIZE];      /**< Model number, empty if unknown */
+    char     fw_rev[WEARABLE_PROFILE_STR_SIZE];     /**< Firmware revision, empty if unknown */
+    uint32_t discovery_ms;                          /**< Time from connect until the discovery of all services finished */
+    uint32_t ready_ms;                              /**< Time from connect until all initial reads completed */
+} wearable_profile_t;
+
+/**@brief Profile ready handler type.
+ *
+ * @param[in] p_profile  Profile of the wearable. Only valid during the call.
+ */
+typedef void (*wearable_profile_ready_handler_t)(const wearable_profile_t* p_profile);
+
+/**@brief Wearable profile init structure */
+typedef struct {
+    nrf_ble_gq_t*                    p_gatt_queue;      /**< GATT queue shared by the clients */
+    ble_ars_c_evt_handler_t          ars_evt_handler;   /**< Handler for the Assistance Request client events */
+    wearable_profile_ready_handler_t ready_handler;     /**< Handler called once the profile of a wearable is known */
+    ble_srv_error_handler_t          error_handler;     /**< Handler for client errors */
+} wearable_profile_init_t;
+
+
+
+/**@brief Function for initializing the wearable profile clients.
+ *
+ * @details Registers the Assistance Request, Battery and Device Information services with the
+ *          database discovery, so that one discovery pass finds all of them. When it finishes, the
+ *          assistance request, battery level, model number and firmware revision are read back to
+ *          back through the GATT queue.
+ *
+ * @param[in] p_init  Init structure.
+ */
+ret_code_t wearable_profile_init(const wearable_profile_init_t* p_init);
+
+
+/**@brief Function for handling database discovery events.
+ *
+ * @param[in] p_evt  Database discovery event.
+ */
+void wearable_profile_on_db_disc_evt(ble_db_discovery_evt_t* p_evt);
+
+
+/**@brief Function for getting the Assistance Request client of a link.
+ *
+ * @param[in] conn_handle  Connection handle of the link.
+ *
+ * @return Pointer to the client instance, or NULL if the connection handle is not valid.
+ */
+ble_ars_c_t* wearable_profile_ars_c_get(uint16_t conn_handle);
+
+
+#ifdef __cplusplus
+}
+#endif
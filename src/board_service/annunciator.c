@@ -0,0 +1,196 @@
+#include "annunciator.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "nrfx_pwm.h"
+#include "boards.h"
+
+
+#define PWM_PERIOD_MS       10                                  /**< Duration of one PWM period. Pattern steps are multiples of this. */
+#define PWM_TOP_VALUE       (125 * PWM_PERIOD_MS)               /**< PWM countertop at 125 kHz for one PWM period */
+
+// A value equal to the countertop keeps the output high for the whole period, a value of zero keeps it low
+#if LEDS_ACTIVE_STATE
+#define LED_ON              PWM_TOP_VALUE
+#define LED_OFF             0
+#else
+#define LED_ON              0
+#define LED_OFF             PWM_TOP_VALUE
+#endif
+
+#define STEPS_TO_REPEATS(_ms)   (((_ms) / PWM_PERIOD_MS) - 1)   /**< Number of extra PWM periods that a pattern step of _ms is held for */
+
+
+/**@brief Annunciation pattern */
+typedef struct {
+    nrf_pwm_values_common_t* p_steps;   /**< Pattern steps. Must be in RAM as the PWM reads them with EasyDMA. */
+    uint16_t                 step_count;
+    uint16_t                 step_ms;   /**< Duration of each step */
+} pattern_t;
+
+
+static nrf_pwm_values_common_t m_request_steps[]        = { LED_ON, LED_OFF, LED_OFF, LED_OFF };
+static nrf_pwm_values_common_t m_request_urgent_steps[] = { LED_ON, LED_OFF };
+static nrf_pwm_values_common_t m_escalated_steps[]      = { LED_ON, LED_OFF, LED_ON, LED_OFF, LED_OFF, LED_OFF, LED_OFF, LED_OFF };
+
+static const pattern_t m_patterns[ANNUNCIATOR_STATE_COUNT] = {
+    [ANNUNCIATOR_STATE_IDLE]           = { NULL, 0, 0 },
+    [ANNUNCIATOR_STATE_REQUEST]        = { m_request_steps,        ARRAY_SIZE(m_request_steps),        500 },
+    [ANNUNCIATOR_STATE_REQUEST_URGENT] = { m_request_urgent_steps, ARRAY_SIZE(m_request_urgent_steps), 150 },
+    [ANNUNCIATOR_STATE_ESCALATED]      = { m_escalated_steps,      ARRAY_SIZE(m_escalated_steps),      100 },
+};
+
+static const nrfx_pwm_t m_pwm = NRFX_PWM_INSTANCE(ANNUNCIATOR_PWM_INSTANCE);
+
+static uint32_t            m_state_counts[ANNUNCIATOR_STATE_COUNT];    /**< Number of times each state is queued */
+static annunciator_state_t m_state = ANNUNCIATOR_STATE_IDLE;           /**< State being annunciated */
+static uint32_t            m_pattern_changes;
+
+
+/**@brief Function for starting the pattern of the most urgent queued state.
+ */
+static void pattern_update(void)
+{
+    annunciator_state_t state = ANNUNCIATOR_STATE_IDLE;
+
+    for (int i = ANNUNCIATOR_STATE_COUNT - 1; i > ANNUNCIATOR_STATE_IDLE; i--)
+    {
+        if (m_state_counts[i] > 0)
+        {
+            state = (annunciator_state_t)i;
+            break;
+        }
+    }
+
+    if (state == m_state)
+    {
+        return;
+    }
+
+    m_state = state;
+    m_pattern_changes++;
+
+    // Stopping returns the pin to its idle level, which is LED off
+    (void)nrfx_pwm_stop(&m_pwm, true);
+
+    if (state != ANNUNCIATOR_STATE_IDLE)
+    {
+        const pattern_t*   p_pattern = &m_patterns[state];
+        nrf_pwm_sequence_t seq       = {
+            .values.p_common = p_pattern->p_steps,
+            .length          = p_pattern->step_count,
+            .repeats         = STEPS_TO_REPEATS(p_pattern->step_ms),
+            .end_delay       = 0
+        };
+
+        // Looping is done with the PWM LOOPSDONE->SEQSTART shortcut, so no interrupt is needed
+        (void)nrfx_pwm_simple_playback(&m_pwm, &seq, 1, NRFX_PWM_FLAG_LOOP);
+    }
+}
+
+
+ret_code_t annunciator_init(uint32_t led_idx)
+{
+    uint32_t pin = bsp_board_led_idx_to_pin(led_idx);
+
+    nrfx_pwm_config_t const config = {
+        .output_pins  = {
+#if LEDS_ACTIVE_STATE
+            pin,
+#else
+            pin | NRFX_PWM_PIN_INVERTED,    // Idle level high keeps an active low LED off
+#endif
+            NRFX_PWM_PIN_NOT_USED,
+            NRFX_PWM_PIN_NOT_USED,
+            NRFX_PWM_PIN_NOT_USED
+        },
+        .irq_priority = APP_IRQ_PRIORITY_LOWEST,
+        .base_clock   = NRF_PWM_CLK_125kHz,
+        .count_mode   = NRF_PWM_MODE_UP,
+        .top_value    = PWM_TOP_VALUE,
+        .load_mode    = NRF_PWM_LOAD_COMMON,
+        .step_mode    = NRF_PWM_STEP_AUTO
+    };
+
+    memset(m_state_counts, 0, sizeof(m_state_counts));
+    m_state           = ANNUNCIATOR_STATE_IDLE;
+    m_pattern_changes = 0;
+
+    // No handler is given, so the driver never enables the PWM interrupt
+    return nrfx_pwm_init(&m_pwm, &config, NULL);
+}
+
+
+void annunciator_state_push(annunciator_state_t state)
+{
+    if (state <= ANNUNCIATOR_STATE_IDLE || state >= ANNUNCIATOR_STATE_COUNT)
+    {
+        return;
+    }
+
+    m_state_counts[state]++;
+    pattern_update();
+}
+
+
+void annunciator_state_pop(annunciator_state_t state)
+{
+    if (state <= ANNUNCIATOR_STATE_IDLE || state >= ANNUNCIATOR_STATE_COUNT || m_state_counts[state] == 0)
+    {
+        return;
+    }
+
+    m_state_counts[state]--;
+    pattern_update();
+}
+
+
+annunciator_state_t annunciator_state_get(void)
+{
+    return m_state;
+}
+
+
+uint32_t annunciator_state_count(annunciator_state_t state)
+{
+    if (state >= ANNUNCIATOR_STATE_COUNT)
+    {
+        return 0;
+    }
+    return m_state_counts[state];
+}
+
+
+void annunciator_pattern_info_get(annunciator_state_t state, annunciator_pattern_info_t* p_info)
+{
+    if (p_info == NULL)
+    {
+        return;
+    }
+
+    memset(p_info, 0, sizeof(*p_info));
+    if (state <= ANNUNCIATOR_STATE_IDLE || state >= ANNUNCIATOR_STATE_COUNT)
+    {
+        return;
+    }
+
+    const pattern_t* p_pattern = &m_patterns[state];
+
+    p_info->period_ms          = p_pattern->step_count * p_pattern->step_ms;
+    p_info->wakeups_per_period = 0;
+
+    // A timer driven pattern wakes up on every on/off transition
+    for (uint16_t i = 0; i < p_pattern->step_count; i++)
+    {
+        if (p_pattern->p_steps[i] != p_pattern->p_steps[(i + 1) % p_pattern->step_count])
+        {
+            p_info->timer_wakeups_per_period++;
+        }
+    }
+}
+
+
+uint32_t annunciator_pattern_change_count(void)
+{
+    return m_pattern_changes;
+}
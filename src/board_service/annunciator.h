@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Annunciation states, in increasing order of urgency */
+typedef enum {
+    ANNUNCIATOR_STATE_IDLE,             /**< Nothing to annunciate, LED off */
+    ANNUNCIATOR_STATE_REQUEST,          /**< Request pending: slow blink */
+    ANNUNCIATOR_STATE_REQUEST_URGENT,   /**< High priority request pending: fast blink */
+    ANNUNCIATOR_STATE_ESCALATED,        /**< Request left unacknowledged for too long: double flash */
+    ANNUNCIATOR_STATE_COUNT
+} annunciator_state_t;
+
+/**@brief Annunciation pattern information */
+typedef struct {
+    uint32_t period_ms;                 /**< Duration of one pattern cycle */
+    uint32_t wakeups_per_period;        /**< CPU wakeups per cycle while the pattern plays */
+    uint32_t timer_wakeups_per_period;  /**< CPU wakeups per cycle the pattern would cost if driven from app_timer */
+} annunciator_pattern_info_t;
+
+
+
+/**@brief Function for initializing the annunciator.
+ *
+ * @details The LED is driven by a PWM peripheral that loops the pattern sequence in hardware, so
+ *          the CPU is not woken up while a pattern plays. Only state changes cost CPU time.
+ *
+ * @param[in] led_idx  Index of the board LED to drive.
+ *
+ * @retval NRF_SUCCESS  If the annunciator was initialized.
+ * @retval err_code     Otherwise, the error returned by @ref nrfx_pwm_init.
+ */
+ret_code_t annunciator_init(uint32_t led_idx);
+
+
+/**@brief Function for adding an annunciation state to the queue.
+ *
+ * @details The most urgent queued state is the one being annunciated. Each push must be matched by
+ *          a @ref annunciator_state_pop of the same state.
+ *
+ * @param[in] state  State to add.
+ */
+void annunciator_state_push(annunciator_state_t state);
+
+
+/**@brief Function for removing an annunciation state from the queue.
+ *
+ * @param[in] state  State to remove.
+ */
+void annunciator_state_pop(annunciator_state_t state);
+
+
+/**@brief Function for getting the state currently being annunciated. */
+annunciator_state_t annunciator_state_get(void);
+
+
+/**@brief Function for getting the number of times a state is queued.
+ *
+ * @param[in] state  State to count.
+ */
+uint32_t annunciator_state_count(annunciator_state_t state);
+
+
+/**@brief Function for getting the timing and wakeup cost of a state's pattern.
+ *
+ * @param[in]  state   Annunciation state.
+ * @param[out] p_info  Pattern information.
+ */
+void annunciator_pattern_info_get(annunciator_state_t state, annunciator_pattern_info_t* p_info);
+
+
+/**@brief Function for getting the number of pattern changes, each of which costs one CPU wakeup. */
+uint32_t annunciator_pattern_change_count(void);
+
+
+#ifdef __cplusplus
+}
+#endif
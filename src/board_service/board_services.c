@@ -4,14 +4,19 @@
 
 #include "nrf.h"
 #include "nrf_pwr_mgmt.h"
-#include "nrf_log.h"
-#include "nrf_log_ctrl.h"
-#include "nrf_log_default_backends.h"
 
 #include "bsp.h"
 #include "bsp_btn_ble.h"
 #include "app_timer.h"
 #include "fds.h"
+#include "system_service/boot_profile.h"
+#include "system_service/log_routing.h"
+
+#define NRF_LOG_MODULE_NAME board_services
+
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+NRF_LOG_MODULE_REGISTER();
 
 
 // Board services config storage
@@ -73,13 +78,15 @@ static void buttons_leds_init(bool* p_erase_bonds)
 
 
 /**@brief Function for initializing the nrf log module.
+ *
+ * @details Diagnostics go to RTT, the UART only carries warnings and errors.
  */
 static void log_init(void)
 {
     ret_code_t err_code = NRF_LOG_INIT(NULL);
     APP_ERROR_CHECK(err_code);
 
-    NRF_LOG_DEFAULT_BACKENDS_INIT();
+    log_routing_init();
 }
 
 
@@ -106,7 +113,11 @@ void board_services_init(board_services_init_t* p_init) {
     board_services_config.bsp_evt_handler = p_init->bsp_evt_handler;
 
     log_init();
+    boot_profile_mark(BOOT_STAGE_LOG);
     timers_init();
+    boot_profile_mark(BOOT_STAGE_TIMERS);
     buttons_leds_init(p_init->erase_bonds);
+    boot_profile_mark(BOOT_STAGE_BUTTONS_LEDS);
     power_management_init();
+    boot_profile_mark(BOOT_STAGE_POWER_MANAGEMENT);
 }
\ No newline at end of file
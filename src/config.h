@@ -11,7 +11,10 @@
 #define APP_ADV_INTERVAL                300                                     /**< The advertising interval (in units of 0.625 ms. This value corresponds to 187.5 ms). */
 
 #define APP_ADV_DURATION                18000                                   /**< The advertising duration (180 seconds) in units of 10 milliseconds. */
+#define ADV_COMPANY_ID                  0x0059                                  /**< Company identifier of the manufacturer specific advertising data (Nordic Semiconductor). */
+#define ADV_MANUF_DATA_MAX_SIZE         5                                       /**< Maximum manufacturer specific data payload. The advertising data is full with the device name. */
 #define APP_BLE_OBSERVER_PRIO           3                                       /**< Application's BLE observer priority. You shouldn't need to modify this value. */
+#define APP_BLE_USER_ROUTE_PRIO         4                                       /**< BLE event route priority of the application handlers in main.c. Runs after the BLE services. */
 #define APP_BLE_CONN_CFG_TAG            1                                       /**< A tag identifying the SoftDevice BLE configuration. */
 
 #define MIN_CONN_INTERVAL               MSEC_TO_UNITS(100, UNIT_1_25_MS)        /**< Minimum acceptable connection interval (0.1 seconds). */
@@ -37,4 +40,123 @@
 
 // BLE Assist Service Config
 #define ASSISTANCE_REQUEST_ACK_BUTTON   BSP_EVENT_KEY_0                         /**< The button event fired when the assistance request acknowledgement button is pressed */
-#define ASSISTANCE_REQUEST_LED          BSP_BOARD_LED_0                         /**< The LED that indicates a request for assistance was made */
\ No newline at end of file
+#define ASSISTANCE_REQUEST_LED          BSP_BOARD_LED_0                         /**< The LED that indicates a request for assistance was made */
+#define ASSISTANCE_REQUEST_URGENT_PRIO  2                                       /**< Requests of this priority or higher are annunciated as urgent */
+#define ANNUNCIATOR_PWM_INSTANCE        0                                       /**< PWM instance driving the assistance request LED */
+
+
+// Roaming Config
+#define ROAMING_HANDOVER_RSSI_DBM       -80                                     /**< A link is handed over once its averaged RSSI stays below this level */
+#define ROAMING_HANDOVER_SAMPLES        5                                       /**< Number of consecutive averaged RSSI samples below the threshold before a handover */
+#define ROAMING_ADMIT_MARGIN_DB         8                                       /**< Wearables should only connect to servers they receive this far above the handover threshold */
+#define ROAMING_MIN_LINK_TIME_MS        15000                                   /**< Minimum link time before a handover. Prevents wearables from bouncing between servers */
+#define ROAMING_PEER_TIMEOUT_MS         10000                                   /**< Another server counts as available for this long after its last advertisement */
+#define ROAMING_RSSI_THRESHOLD_DBM      1                                       /**< Minimum RSSI change reported by the SoftDevice */
+#define ROAMING_RSSI_SKIP_COUNT         8                                       /**< Number of RSSI samples the SoftDevice skips between reports */
+#define ROAMING_RSSI_EWMA_SHIFT         3                                       /**< RSSI averaging weight of a new sample, 1/2^shift */
+#define ROAMING_RSSI_HINT_STEP_DB       4                                       /**< Change of the weakest link RSSI that triggers an advertising data update */
+#define ROAMING_SCAN_INTERVAL           MSEC_TO_UNITS(1000, UNIT_0_625_MS)      /**< Interval of the scan for other servers */
+#define ROAMING_SCAN_WINDOW             MSEC_TO_UNITS(50, UNIT_0_625_MS)        /**< Window of the scan for other servers */
+
+
+// Relay Config
+#define RELAY_ROLE_NONE                 0                                       /**< Relay disabled */
+#define RELAY_ROLE_EDGE                 1                                       /**< Forward assistance events to the station. Needs NRF_SDH_BLE_CENTRAL_LINK_COUNT 1 */
+#define RELAY_ROLE_STATION              2                                       /**< Receive the events of edge servers. Needs one more NRF_SDH_BLE_PERIPHERAL_LINK_COUNT per edge server */
+#define RELAY_ROLE                      RELAY_ROLE_NONE                         /**< Relay role of this server */
+#define RELAY_STATION_ADDR              {0x00, 0x00, 0x00, 0x00, 0x00, 0xC0}    /**< Random static address of the station, least significant byte first. Logged by the station at startup */
+#define RELAY_BUFFER_SIZE               32                                      /**< Number of records an edge server buffers while the uplink is down */
+#define RELAY_RECONNECT_INTERVAL_MS     5000                                    /**< Delay before the uplink connection is retried */
+#define RELAY_CONNECT_TIMEOUT           MSEC_TO_UNITS(3000, UNIT_10_MS)         /**< Time an uplink connection attempt scans for the station */
+#define RELAY_SCAN_INTERVAL             MSEC_TO_UNITS(100, UNIT_0_625_MS)       /**< Scan interval of an uplink connection attempt */
+#define RELAY_SCAN_WINDOW               MSEC_TO_UNITS(50, UNIT_0_625_MS)        /**< Scan window of an uplink connection attempt */
+#define RELAY_MIN_CONN_INTERVAL         MSEC_TO_UNITS(30, UNIT_1_25_MS)         /**< Minimum uplink connection interval */
+#define RELAY_MAX_CONN_INTERVAL         MSEC_TO_UNITS(60, UNIT_1_25_MS)         /**< Maximum uplink connection interval */
+#define RELAY_CONN_SUP_TIMEOUT          MSEC_TO_UNITS(4000, UNIT_10_MS)         /**< Uplink supervision timeout */
+
+
+// Wall Clock Config
+#define WALL_CLOCK_EXTEND_INTERVAL_MS   60000                                   /**< Interval at which the 24-bit app_timer counter is extended. Must be shorter than its wrap period */
+#define WALL_CLOCK_RESYNC_INTERVAL_MS   3600000                                 /**< Interval at which the time is read again from the peer */
+#define WALL_CLOCK_DRIFT_MIN_INTERVAL_MS 600000                                 /**< Minimum time between the syncs a drift is measured from */
+#define WALL_CLOCK_DRIFT_MAX_PPM        1000                                    /**< Larger drift measurements are taken as time adjustments of the peer and ignored */
+
+
+// BLE Event Trace Config
+#define BLE_EVT_TRACE_ENABLED           0                                       /**< Stream every BLE event to the host over RTT for capture and replay */
+#define BLE_EVT_TRACE_RTT_CHANNEL       1                                       /**< RTT up channel of the trace. Channel 0 carries the log. Must be below SEGGER_RTT_CONFIG_MAX_NUM_UP_BUFFERS */
+#define BLE_EVT_TRACE_BUFFER_SIZE       2048                                    /**< Size of the RTT buffer of the trace in bytes */
+#define BLE_EVT_TRACE_PARAM_SIZE        32                                      /**< Event parameter bytes recorded per event. Longer events, such as large notifications, are truncated */
+
+
+// Request Queue Config
+#define REQUEST_QUEUE_CAPACITY          32                                      /**< Number of request records in the pool, the maximum number of pending assistance requests */
+#define REQUEST_FILTER_HOLD_MS          1000                                    /**< Minimum time between two request state transitions of a wearable. Changes within are collapsed */
+#define REQUEST_FILTER_DEBOUNCE_MS      250                                     /**< Time a collapsed request state must be stable before it is passed on */
+#define REQUEST_ESCALATION_TIMEOUT_MS   120000                                  /**< Time a request may go unacknowledged before its annunciation is escalated */
+
+
+// Error Budget Config
+#define ERROR_BUDGET_LINK_MAX           8                                       /**< Transient errors a link may cause within ERROR_BUDGET_WINDOW_MS before it is disconnected */
+#define ERROR_BUDGET_WINDOW_MS          10000                                   /**< Length of the error budget window of a link */
+#define ERROR_BUDGET_INJECT_INTERVAL_MS 0                                       /**< Interval at which a transient error is injected. 0 disables the fault injection */
+
+
+// Work Queue Config
+#define WORK_QUEUE_SIZE                 16                                      /**< Number of work items the event handlers can post before the main loop runs */
+
+
+// Timer Wheel Config
+#define TIMER_WHEEL_TICK_MS             250                                     /**< Resolution of the timer wheel. A two level wheel of 64 slots spans 4096 ticks */
+
+
+// Load Generator Config
+#define LOAD_GENERATOR_WEARABLES        0                                       /**< Number of virtual wearables driven through the request pipeline, at most REQUEST_QUEUE_CAPACITY / 2. 0 disables the load generator */
+#define LOAD_GENERATOR_RAMP_STEP        4                                       /**< Virtual wearables added at each ramp step */
+#define LOAD_GENERATOR_RAMP_INTERVAL_MS 60000                                   /**< Duration of a ramp step. The load of each step is reported in the log */
+#define LOAD_GENERATOR_REQUEST_INTERVAL_MS 30000                                /**< Mean time between the requests of a virtual wearable, exponentially distributed */
+#define LOAD_GENERATOR_ACK_INTERVAL_MS  2000                                    /**< Mean time between simulated staff acknowledgements, exponentially distributed */
+#define LOAD_GENERATOR_STORM_INTERVAL_MS 0                                      /**< Interval of request storms, in which every idle virtual wearable raises a request. 0 disables the storms */
+#define LOAD_GENERATOR_FLAP_PERCENT     10                                      /**< Chance that the link of a virtual wearable drops and reconnects while its request is pending */
+#define LOAD_GENERATOR_DISCONNECT_PERCENT 30                                    /**< Chance that a virtual wearable disconnects once its request was acknowledged */
+#define LOAD_GENERATOR_GATT_LATENCY_MS  50                                      /**< Time a virtual wearable takes to confirm a write and notify its new state */
+
+
+// Stack Monitor Config
+#define STACK_MONITOR_SCAN_INTERVAL_MS  1000                                    /**< Interval of the stack high-water scans */
+
+
+// Cycle Profile Config
+#define CYCLE_PROFILE_ENABLED           0                                       /**< Measure the handlers and main loop stages in CPU cycles and stream snapshots over RTT */
+#define CYCLE_PROFILE_RTT_CHANNEL       2                                       /**< RTT up channel of the snapshots. Must be below SEGGER_RTT_CONFIG_MAX_NUM_UP_BUFFERS */
+#define CYCLE_PROFILE_BUFFER_SIZE       512                                     /**< Size of the RTT buffer of the snapshots in bytes */
+#define CYCLE_PROFILE_REPORT_INTERVAL_MS 5000                                   /**< Interval of the snapshots */
+
+
+// Flight Recorder Config
+#define FLIGHT_RECORDER_SIZE            256                                     /**< Records kept in no-init RAM, 12 bytes each. Must be a power of two */
+#define FLIGHT_RECORDER_LOG_COUNT       16                                      /**< Newest records logged after a warm reset */
+#define FLIGHT_RECORDER_RTT_CHANNEL     3                                       /**< RTT up and down channel of the dumps. Must be below SEGGER_RTT_CONFIG_MAX_NUM_UP_BUFFERS and SEGGER_RTT_CONFIG_MAX_NUM_DOWN_BUFFERS */
+#define FLIGHT_RECORDER_RTT_BUFFER_SIZE 512                                     /**< Size of the RTT buffer of the dumps in bytes */
+
+
+// Log Routing Config
+#define LOG_ROUTING_RTT_LEVEL           NRF_LOG_SEVERITY_DEBUG                  /**< Initial severity filter of all log modules on RTT */
+#define LOG_ROUTING_UART_LEVEL          NRF_LOG_SEVERITY_WARNING                /**< Initial severity filter of all log modules on the UART, which is kept for critical events */
+
+
+// Boot Config
+#define BOOT_FAST_START                 0                                       /**< Start advertising before the connection parameters, Peer Manager, relay and USB export are initialized */
+#define BOOT_PROFILE_TIMER              NRF_TIMER4                              /**< Timer measuring the boot stages. Stopped once the boot is complete */
+
+
+// Retained State Config
+#define RETAINED_REATTACH_TIMEOUT_MS    30000                                   /**< Restored requests are dropped if their wearable does not reconnect within this time */
+
+
+// Event Export Config
+#define EVENT_EXPORT_BUFFER_SIZE        256                                     /**< Size of each of the two export transmit buffers */
+#define EVENT_EXPORT_STATS_INTERVAL_MS  10000                                   /**< Interval between statistics records */
+#define EVENT_EXPORT_UARTE_INSTANCE     1                                       /**< UARTE instance used for event export. UARTE0 is used by the log backend. */
+#define EVENT_EXPORT_UARTE_BAUDRATE     NRF_UARTE_BAUDRATE_1000000              /**< Event export baud rate */
+#define EVENT_EXPORT_UARTE_TX_PIN       NRF_GPIO_PIN_MAP(1, 1)                  /**< Event export TX pin. Boards with APP_USBD_CDC_ACM_ENABLED export over USB instead. */
@@ -0,0 +1,162 @@
+#include "event_export.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_util_platform.h"
+#include "crc16.h"
+#include "slip.h"
+#include "system_service/flight_recorder.h"
+#include "time_service/wall_clock.h"
+
+
+#define FRAME_MAX_SIZE  (2 * (sizeof(event_export_record_t) + sizeof(uint16_t)) + 1)   /**< Worst case SLIP frame size, every byte escaped plus END */
+
+
+/**@brief Transmit buffer */
+typedef struct {
+    uint8_t  data[EVENT_EXPORT_BUFFER_SIZE];
+    uint32_t length;
+    uint32_t record_count;
+} tx_buffer_t;
+
+
+static event_export_tx_func_t m_tx_func;
+static tx_buffer_t            m_buffers[2];
+static tx_buffer_t* volatile  m_p_fill;         /**< Buffer that records are framed into */
+static volatile bool          m_tx_in_progress; /**< True while the other buffer is owned by the transport */
+static uint16_t               m_seq;
+static event_export_stats_t   m_stats;
+
+
+ret_code_t event_export_init(event_export_tx_func_t tx_func)
+{
+    VERIFY_PARAM_NOT_NULL(tx_func);
+
+    m_tx_func         = tx_func;
+    m_p_fill               = &m_buffers[0];
+    m_p_fill->length       = 0;
+    m_p_fill->record_count = 0;
+    m_tx_in_progress       = false;
+    m_seq                  = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    return NRF_SUCCESS;
+}
+
+
+void event_export_record(event_export_type_t type,
+                         uint16_t            conn_handle,
+                         uint8_t             arg0,
+                         uint8_t             arg1,
+                         uint32_t            value)
+{
+    uint8_t  frame[sizeof(event_export_record_t) + sizeof(uint16_t)];
+    uint16_t crc;
+    uint32_t encoded_length;
+
+    flight_recorder_record(FLIGHT_RECORDER_SOURCE_EXPORT, (uint8_t)type, arg0, conn_handle, value);
+
+    if (m_tx_func == NULL)
+    {
+        return;
+    }
+
+    event_export_record_t record = {
+        .version     = EVENT_EXPORT_VERSION,
+        .type        = type,
+        .time_ms     = wall_clock_time_ms_get(),
+        .conn_handle = conn_handle,
+        .arg0        = arg0,
+        .arg1        = arg1,
+        .value       = value
+    };
+
+    CRITICAL_REGION_ENTER();
+
+    tx_buffer_t* p_fill = m_p_fill;
+
+    if (p_fill->length + FRAME_MAX_SIZE > sizeof(p_fill->data))
+    {
+        m_stats.records_dropped++;
+    }
+    else
+    {
+        record.seq = m_seq++;
+        memcpy(frame, &record, sizeof(record));
+        crc = crc16_compute(frame, sizeof(record), NULL);
+        frame[sizeof(record)]     = LSB_16(crc);
+        frame[sizeof(record) + 1] = MSB_16(crc);
+
+        (void)slip_encode(&p_fill->data[p_fill->length], frame, sizeof(frame), &encoded_length);
+        p_fill->length += encoded_length;
+        p_fill->record_count++;
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+
+void event_export_process(void)
+{
+    tx_buffer_t* p_send = NULL;
+
+    CRITICAL_REGION_ENTER();
+    if (!m_tx_in_progress && m_p_fill->length > 0)
+    {
+        // Hand the filled buffer to the transport and keep filling the other one
+        p_send                 = m_p_fill;
+        m_p_fill               = (p_send == &m_buffers[0]) ? &m_buffers[1] : &m_buffers[0];
+        m_p_fill->length       = 0;
+        m_p_fill->record_count = 0;
+        m_tx_in_progress       = true;
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (p_send == NULL)
+    {
+        return;
+    }
+
+    if (m_tx_func(p_send->data, p_send->length) == NRF_SUCCESS)
+    {
+        m_stats.batches_sent++;
+        m_stats.bytes_sent += p_send->length;
+    }
+    else
+    {
+        // The batch is lost
+        m_stats.records_dropped += p_send->record_count;
+        m_tx_in_progress         = false;
+    }
+}
+
+
+void event_export_tx_done(void)
+{
+    tx_buffer_t* p_sent = (m_p_fill == &m_buffers[0]) ? &m_buffers[1] : &m_buffers[0];
+
+    m_stats.records_sent += p_sent->record_count;
+    m_tx_in_progress      = false;
+}
+
+
+void event_export_tx_failed(void)
+{
+    tx_buffer_t* p_sent = (m_p_fill == &m_buffers[0]) ? &m_buffers[1] : &m_buffers[0];
+
+    m_stats.records_dropped += p_sent->record_count;
+    m_tx_in_progress         = false;
+}
+
+
+void event_export_stats_get(event_export_stats_t* p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+}
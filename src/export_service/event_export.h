@@ -0,0 +1,156 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sdk_errors.h"
+#include "app_util.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define EVENT_EXPORT_VERSION    2       /**< Version of the record layout */
+
+
+/**@brief Event record types */
+typedef enum {
+    EVENT_EXPORT_TYPE_REQUEST = 1,  /**< Request state read from a wearable. arg0: request state */
+    EVENT_EXPORT_TYPE_ACK,          /**< Staff acknowledgement. arg0: priority, value: latency in ms or UINT32_MAX if not confirmed yet */
+    EVENT_EXPORT_TYPE_LINK,         /**< Link event. arg0: 1 on connect, 0 on disconnect, arg1: HCI disconnect reason */
+    EVENT_EXPORT_TYPE_STATS,        /**< Statistics counter. arg0: @ref event_export_stat_t, value: counter value */
+    EVENT_EXPORT_TYPE_HANDOVER,     /**< Handover to another server. arg0: request state saved on the wearable, arg1: averaged link RSSI in -dBm */
+    EVENT_EXPORT_TYPE_RELAY,        /**< Event relayed by an edge server, exported by the station. conn_handle: link to the edge server, arg0: relayed type, arg1: relayed arg0, value: link index on the edge server (bits 31-24), edge sequence number (bits 23-16) and event age in 100 ms (bits 15-0) */
+    EVENT_EXPORT_TYPE_CLOCK_SYNC,   /**< Wall clock synced from a peer's Current Time Service. arg0: 1 if the drift was measured, value: drift in ppm (int32_t), positive if the local clock runs fast */
+    EVENT_EXPORT_TYPE_PROFILE,      /**< Wearable profile known. arg0: battery level in percent or 0xFF if unknown, arg1: discovery time in 10 ms units (saturated at 255), value: time from connect until all initial reads completed in ms */
+    EVENT_EXPORT_TYPE_RESTART,      /**< Server started. arg0: number of requests restored from retained RAM, arg1: low byte of the reset reason (RESETREAS), value: time from main entry until the requests were restored in us */
+    EVENT_EXPORT_TYPE_BOOT,         /**< Boot stage reached. arg0: @ref boot_stage_t (first advertisement, not sent when bonds are erased, or complete), arg1: 1 in fast start mode, value: time from main entry in us */
+    EVENT_EXPORT_TYPE_FAULT,        /**< Hard fault before the last reset. arg0: 1 if it was a stack overflow, arg1: active exception number, value: program counter */
+    EVENT_EXPORT_TYPE_ESCALATION    /**< Request unacknowledged for REQUEST_ESCALATION_TIMEOUT_MS. arg0: priority, value: time pending in ms */
+} event_export_type_t;
+
+/**@brief Statistics counter identifiers */
+typedef enum {
+    EVENT_EXPORT_STAT_PENDING_REQUESTS = 1, /**< Number of pending requests */
+    EVENT_EXPORT_STAT_ACK_COUNT,            /**< Number of confirmed acknowledgements */
+    EVENT_EXPORT_STAT_ACK_P50_MS,           /**< Median acknowledgement latency */
+    EVENT_EXPORT_STAT_ACK_P99_MS,           /**< 99th percentile acknowledgement latency */
+    EVENT_EXPORT_STAT_RECORDS_SENT,         /**< Number of exported records */
+    EVENT_EXPORT_STAT_RECORDS_DROPPED,      /**< Number of records dropped because the buffers were full or their transfer failed */
+    EVENT_EXPORT_STAT_RECORDS_PER_SEC,      /**< Exported records per second over the last statistics interval */
+    EVENT_EXPORT_STAT_RELAY_BUFFERED,       /**< Records an edge server buffers for the station */
+    EVENT_EXPORT_STAT_RELAY_LATENCY_MS,     /**< Mean hop latency of an edge server, from the event to the station's confirmation */
+    EVENT_EXPORT_STAT_TRANSIENT_ERRORS,     /**< Number of transient errors handled without a reset */
+    EVENT_EXPORT_STAT_LINK_RECOVERIES,      /**< Number of links disconnected because they exceeded their error budget */
+    EVENT_EXPORT_STAT_STACK_USED,           /**< High-water mark of the stack in bytes. arg1: deepest interrupt nesting sampled */
+    EVENT_EXPORT_STAT_PENDING_REQUESTS_MAX, /**< Highest number of requests pending at once */
+    EVENT_EXPORT_STAT_REQUESTS_REJECTED,    /**< Number of requests dropped because all request records were in use */
+    EVENT_EXPORT_STAT_WORK_DEPTH_MAX,       /**< Highest number of work items waiting for the main loop */
+    EVENT_EXPORT_STAT_WORK_DROPPED,         /**< Number of work items dropped because the work queue was full */
+    EVENT_EXPORT_STAT_WORK_ENQUEUE_CYCLES,  /**< Mean cost of posting a work item in CPU cycles */
+    EVENT_EXPORT_STAT_REQUEST_STATES_ABSORBED, /**< Number of raw request states the request filter collapsed or dropped as repeats */
+    EVENT_EXPORT_STAT_LOG_BACKLOG_MAX,      /**< Most log entries waiting for the main loop at once */
+    EVENT_EXPORT_STAT_LOG_UART_BUSY_MS,     /**< Time spent writing log messages to the UART */
+    EVENT_EXPORT_STAT_RELAY_LOST            /**< Records an edge server dropped because its buffer was full or the station rejected them */
+} event_export_stat_t;
+
+/**@brief Event record
+ *
+ * @details Records are sent little endian, followed by a CRC-16-CCITT of the record bytes, and
+ *          the whole frame is SLIP encoded. Each frame ends with a SLIP END byte (0xC0).
+ */
+typedef PACKED_STRUCT {
+    uint8_t  version;       /**< @ref EVENT_EXPORT_VERSION */
+    uint8_t  type;          /**< @ref event_export_type_t */
+    uint16_t seq;           /**< Record sequence number, used by the host to detect lost frames */
+    uint64_t time_ms;       /**< Time at which the event happened, in ms since 1970 (see @ref wall_clock_time_ms_get). Before the first time sync, ms since boot with bit 63 set */
+    uint16_t conn_handle;   /**< Connection handle the event relates to, or BLE_CONN_HANDLE_INVALID */
+    uint8_t  arg0;          /**< Type specific argument */
+    uint8_t  arg1;          /**< Type specific argument */
+    uint32_t value;         /**< Type specific value */
+} event_export_record_t;
+
+STATIC_ASSERT(sizeof(event_export_record_t) == 20);
+
+/**@brief Export statistics */
+typedef struct {
+    uint32_t records_sent;      /**< Records handed to the transport */
+    uint32_t records_dropped;   /**< Records dropped because both buffers were full or their transfer failed */
+    uint32_t bytes_sent;        /**< Encoded bytes handed to the transport */
+    uint32_t batches_sent;      /**< Number of transport transfers */
+} event_export_stats_t;
+
+
+/**@brief Transport transmit function type.
+ *
+ * @details Starts an asynchronous transfer. The transport must call @ref event_export_tx_done
+ *          when the transfer has completed, or @ref event_export_tx_failed when it was aborted.
+ *          The buffer is not touched until then.
+ *
+ * @param[in] p_data  Data to send.
+ * @param[in] length  Number of bytes to send.
+ */
+typedef ret_code_t (*event_export_tx_func_t)(const uint8_t* p_data, size_t length);
+
+
+
+/**@brief Function for initializing the event export.
+ *
+ * @param[in] tx_func  Transport transmit function.
+ */
+ret_code_t event_export_init(event_export_tx_func_t tx_func);
+
+
+/**@brief Function for adding an event record to the export stream.
+ *
+ * @details The record is framed into the buffer that is being filled. It is sent with the next
+ *          batch, see @ref event_export_process.
+ *
+ * @param[in] type         Record type.
+ * @param[in] conn_handle  Connection handle the event relates to.
+ * @param[in] arg0         Type specific argument.
+ * @param[in] arg1         Type specific argument.
+ * @param[in] value        Type specific value.
+ */
+void event_export_record(event_export_type_t type,
+                         uint16_t            conn_handle,
+                         uint8_t             arg0,
+                         uint8_t             arg1,
+                         uint32_t            value);
+
+
+/**@brief Function for sending the buffered records.
+ *
+ * @details Call this from the main loop. If the transport is idle, the filled buffer is handed to
+ *          it and records are framed into the other buffer in the meantime.
+ */
+void event_export_process(void);
+
+
+/**@brief Function for notifying the event export that a transfer has completed.
+ *
+ * @details Called by the transport, usually from interrupt context.
+ */
+void event_export_tx_done(void);
+
+
+/**@brief Function for notifying the event export that a transfer has failed.
+ *
+ * @details Called by the transport in place of @ref event_export_tx_done, usually from interrupt
+ *          context. The records of the batch are counted as dropped.
+ */
+void event_export_tx_failed(void);
+
+
+/**@brief Function for getting the export statistics.
+ *
+ * @param[out] p_stats  Export statistics.
+ */
+void event_export_stats_get(event_export_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
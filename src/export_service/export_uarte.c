@@ -0,0 +1,66 @@
+#include "export_uarte.h"
+#include "event_export.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_util_platform.h"
+#include "nrfx_uarte.h"
+#include "system_service/cycle_profile.h"
+#include "system_service/stack_monitor.h"
+
+
+static const nrfx_uarte_t m_uarte = NRFX_UARTE_INSTANCE(EVENT_EXPORT_UARTE_INSTANCE);
+
+
+/**@brief Function for handling UARTE driver events.
+ */
+static void uarte_evt_handler(nrfx_uarte_event_t const* p_event, void* p_context)
+{
+    uint32_t begin = CYCLE_PROFILE_BEGIN();
+
+    stack_monitor_sample();
+
+    switch (p_event->type)
+    {
+        case NRFX_UARTE_EVT_TX_DONE:
+            event_export_tx_done();
+            break;
+
+        case NRFX_UARTE_EVT_ERROR:
+            event_export_tx_failed();
+            break;
+
+        default:
+            break;
+    }
+
+    CYCLE_PROFILE_END(CYCLE_PROFILE_POINT_UARTE_EVT, begin);
+}
+
+
+ret_code_t export_uarte_init(void)
+{
+    nrfx_uarte_config_t config = NRFX_UARTE_DEFAULT_CONFIG;
+
+    config.pseltxd            = EVENT_EXPORT_UARTE_TX_PIN;
+    config.pselrxd            = NRF_UARTE_PSEL_DISCONNECTED;
+    config.pselcts            = NRF_UARTE_PSEL_DISCONNECTED;
+    config.pselrts            = NRF_UARTE_PSEL_DISCONNECTED;
+    config.hwfc               = NRF_UARTE_HWFC_DISABLED;
+    config.parity             = NRF_UARTE_PARITY_EXCLUDED;
+    config.baudrate           = EVENT_EXPORT_UARTE_BAUDRATE;
+    config.interrupt_priority = APP_IRQ_PRIORITY_LOWEST;
+
+    return nrfx_uarte_init(&m_uarte, &config, uarte_evt_handler);
+}
+
+
+ret_code_t export_uarte_tx(const uint8_t* p_data, size_t length)
+{
+    if (length > UINT16_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    return nrfx_uarte_tx(&m_uarte, p_data, length);
+}
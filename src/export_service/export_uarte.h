@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Function for initializing the UARTE event export transport.
+ *
+ * @details The transport uses its own UARTE instance, separate from the log backend, and sends
+ *          each batch with a single EasyDMA transfer.
+ *
+ * @retval NRF_SUCCESS  If the transport was initialized.
+ * @retval err_code     Otherwise, the error returned by @ref nrfx_uarte_init.
+ */
+ret_code_t export_uarte_init(void);
+
+
+/**@brief Function for starting a UARTE transfer. Matches @ref event_export_tx_func_t.
+ *
+ * @param[in] p_data  Data to send. Must be in RAM.
+ * @param[in] length  Number of bytes to send.
+ */
+ret_code_t export_uarte_tx(const uint8_t* p_data, size_t length);
+
+
+#ifdef __cplusplus
+}
+#endif
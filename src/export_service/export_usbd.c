@@ -0,0 +1,182 @@
+#include "export_usbd.h"
+#include "event_export.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "nrf_drv_clock.h"
+#include "nrf_drv_usbd.h"
+#include "app_usbd.h"
+#include "app_usbd_core.h"
+#include "app_usbd_cdc_acm.h"
+#include "app_usbd_serial_num.h"
+
+
+#define CDC_ACM_COMM_INTERFACE  0
+#define CDC_ACM_COMM_EPIN       NRF_DRV_USBD_EPIN2
+
+#define CDC_ACM_DATA_INTERFACE  1
+#define CDC_ACM_DATA_EPIN       NRF_DRV_USBD_EPIN1
+#define CDC_ACM_DATA_EPOUT      NRF_DRV_USBD_EPOUT1
+
+
+static void cdc_acm_user_evt_handler(app_usbd_class_inst_t const* p_inst,
+                                     app_usbd_cdc_acm_user_event_t event);
+
+APP_USBD_CDC_ACM_GLOBAL_DEF(m_cdc_acm,
+                            cdc_acm_user_evt_handler,
+                            CDC_ACM_COMM_INTERFACE,
+                            CDC_ACM_DATA_INTERFACE,
+                            CDC_ACM_COMM_EPIN,
+                            CDC_ACM_DATA_EPIN,
+                            CDC_ACM_DATA_EPOUT,
+                            APP_USBD_CDC_COMM_PROTOCOL_NONE);
+
+
+static uint8_t       m_rx_byte;         /**< Data from the host is read and discarded */
+static volatile bool m_port_open;
+static volatile bool m_tx_in_progress;
+
+
+/**@brief Function for releasing the buffer of a transfer that was aborted.
+ */
+static void tx_abort(void)
+{
+    if (m_tx_in_progress)
+    {
+        m_tx_in_progress = false;
+        event_export_tx_failed();
+    }
+}
+
+
+/**@brief Function for handling CDC-ACM class events.
+ */
+static void cdc_acm_user_evt_handler(app_usbd_class_inst_t const* p_inst,
+                                     app_usbd_cdc_acm_user_event_t event)
+{
+    switch (event)
+    {
+        case APP_USBD_CDC_ACM_USER_EVT_PORT_OPEN:
+            m_port_open = true;
+            (void)app_usbd_cdc_acm_read(&m_cdc_acm, &m_rx_byte, sizeof(m_rx_byte));
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_PORT_CLOSE:
+            m_port_open = false;
+            tx_abort();
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_TX_DONE:
+            m_tx_in_progress = false;
+            event_export_tx_done();
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_RX_DONE:
+            // Keep the OUT endpoint armed so the host never stalls on it
+            while (app_usbd_cdc_acm_read(&m_cdc_acm, &m_rx_byte, sizeof(m_rx_byte)) == NRF_SUCCESS)
+            {
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**@brief Function for handling USB device state events.
+ */
+static void usbd_user_evt_handler(app_usbd_event_type_t event)
+{
+    switch (event)
+    {
+        case APP_USBD_EVT_STOPPED:
+            tx_abort();
+            app_usbd_disable();
+            break;
+
+        case APP_USBD_EVT_POWER_DETECTED:
+            if (!nrf_drv_usbd_is_enabled())
+            {
+                app_usbd_enable();
+            }
+            break;
+
+        case APP_USBD_EVT_POWER_REMOVED:
+            // The port may never see a close once the cable is pulled
+            m_port_open = false;
+            tx_abort();
+            app_usbd_stop();
+            break;
+
+        case APP_USBD_EVT_POWER_READY:
+            app_usbd_start();
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+ret_code_t export_usbd_init(void)
+{
+    ret_code_t err_code;
+
+    static const app_usbd_config_t usbd_config = {
+        .ev_state_proc = usbd_user_evt_handler
+    };
+
+    m_port_open      = false;
+    m_tx_in_progress = false;
+
+    // USB needs the clock driver to request the high frequency crystal
+    err_code = nrf_drv_clock_init();
+    if (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED)
+    {
+        VERIFY_SUCCESS(err_code);
+    }
+
+    app_usbd_serial_num_generate();
+
+    err_code = app_usbd_init(&usbd_config);
+    VERIFY_SUCCESS(err_code);
+
+    return app_usbd_class_append(app_usbd_cdc_acm_class_inst_get(&m_cdc_acm));
+}
+
+
+ret_code_t export_usbd_start(void)
+{
+    return app_usbd_power_events_enable();
+}
+
+
+void export_usbd_process(void)
+{
+    while (app_usbd_event_queue_process())
+    {
+        // Process all queued USB events
+    }
+}
+
+
+ret_code_t export_usbd_tx(const uint8_t* p_data, size_t length)
+{
+    ret_code_t err_code;
+
+    if (!m_port_open)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // The whole batch goes out as one bulk transfer, split into packets by the USBD EasyDMA scheduler
+    m_tx_in_progress = true;
+    err_code = app_usbd_cdc_acm_write(&m_cdc_acm, p_data, length);
+    if (err_code != NRF_SUCCESS)
+    {
+        m_tx_in_progress = false;
+    }
+
+    return err_code;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Function for initializing the USB CDC-ACM event export transport.
+ *
+ * @details Must be called before the SoftDevice is enabled. USB power events are enabled by
+ *          @ref export_usbd_start once the SoftDevice is running.
+ *
+ * @retval NRF_SUCCESS  If the transport was initialized.
+ * @retval err_code     Otherwise, the error returned by the USB device library.
+ */
+ret_code_t export_usbd_init(void);
+
+
+/**@brief Function for enabling USB power events, which starts the USB device when VBUS is present.
+ *
+ * @details Must be called after the SoftDevice is enabled.
+ */
+ret_code_t export_usbd_start(void);
+
+
+/**@brief Function for processing queued USB events. Call this from the main loop.
+ *
+ * @details USB events are queued by the USBD interrupt and handled here, so USB enumeration and
+ *          class requests never delay BLE event handling.
+ */
+void export_usbd_process(void);
+
+
+/**@brief Function for starting a bulk IN transfer. Matches @ref event_export_tx_func_t.
+ *
+ * @param[in] p_data  Data to send. Must be in RAM.
+ * @param[in] length  Number of bytes to send.
+ *
+ * @retval NRF_SUCCESS              If the transfer was started.
+ * @retval NRF_ERROR_INVALID_STATE  If no host has the port open.
+ */
+ret_code_t export_usbd_tx(const uint8_t* p_data, size_t length);
+
+
+#ifdef __cplusplus
+}
+#endif
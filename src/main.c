@@ -12,6 +12,7 @@
 #include "config.h"
 
 #include "nrf.h"
+#include "app_util_platform.h"
 #include "nrf_sdh.h"
 #include "nrf_sdh_soc.h"
 #include "nrf_sdh_ble.h"
@@ -19,31 +20,83 @@
 #include "nrf_ble_gq.h"
 #include "nrf_ble_qwr.h"
 #include "nrf_pwr_mgmt.h"
-#include "nrf_log.h"
-#include "nrf_log_ctrl.h"
-#include "nrf_log_default_backends.h"
 
 #include "ble.h"
 #include "ble_advertising.h"
+#include "ble_conn_state.h"
 #include "ble_db_discovery.h"
 
 #include "bsp.h"
 #include "bsp_btn_ble.h"
 
+#include "board_service/annunciator.h"
 #include "board_service/board_services.h"
+#include "ble_service/ble_evt_router.h"
+#include "ble_service/ble_evt_trace.h"
 #include "ble_service/ble_services.h"
+#include "ble_service/ble_ars/ble_ars.h"
+#include "ble_service/roaming.h"
 #include "ble_service/ble_ars_c/ble_ars_c.h"
+#include "ble_service/ble_stats/ble_stats.h"
+#include "ble_service/wearable_profile.h"
+#include "export_service/event_export.h"
+#include "export_service/export_uarte.h"
+#include "export_service/export_usbd.h"
+#include "relay_service/relay.h"
+#include "system_service/boot_profile.h"
+#include "system_service/cycle_profile.h"
+#include "system_service/error_budget.h"
+#include "system_service/flight_recorder.h"
+#include "system_service/load_generator.h"
+#include "system_service/log_routing.h"
+#include "system_service/retained_state.h"
+#include "system_service/stack_monitor.h"
+#include "system_service/timer_wheel.h"
+#include "system_service/work_queue.h"
+#include "time_service/wall_clock.h"
+#include "request_service/ack_latency.h"
+#include "request_service/request_filter.h"
+#include "request_service/request_queue.h"
+
+#define NRF_LOG_MODULE_NAME main
+
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+NRF_LOG_MODULE_REGISTER();
 
 
 NRF_BLE_GATT_DEF(m_gatt);              /**< GATT module instance. */
-NRF_BLE_QWR_DEF(m_qwr);                /**< Context for the Queued Write module.*/
+NRF_BLE_QWRS_DEF(m_qwr,                /**< Context for the Queued Write module, one per link. */
+                 NRF_SDH_BLE_TOTAL_LINK_COUNT);
 BLE_ADVERTISING_DEF(m_advertising);    /**< Advertising module instance. */
-BLE_DB_DISCOVERY_DEF(m_db_disc);       /**< DB discovery module instance. */
+BLE_DB_DISCOVERY_ARRAY_DEF(m_db_disc,   /**< DB discovery module instances, one per link. */
+                           NRF_SDH_BLE_TOTAL_LINK_COUNT);
 NRF_BLE_GQ_DEF(m_gatt_queue,           /**< BLE GATT Queue instance. */
-               NRF_SDH_BLE_PERIPHERAL_LINK_COUNT,
+               NRF_SDH_BLE_TOTAL_LINK_COUNT,
                NRF_BLE_GQ_QUEUE_SIZE);
 
-BLE_ARS_C_DEF(m_ble_ars_c);  /**< Main structure used by the Assistance Request client module. */
+#if RELAY_ROLE == RELAY_ROLE_STATION
+BLE_ARS_DEF(m_ble_ars);                /**< Assistance Request Service instance, receives the events of edge servers. */
+#endif
+
+BLE_STATS_DEF(m_ble_stats);            /**< Server Statistics Service instance, read by staff phones. */
+
+APP_TIMER_DEF(m_stats_timer);          /**< Timer for exporting statistics records. */
+
+
+/**@brief Cumulative counters of the Statistics characteristic */
+typedef struct {
+    uint32_t connections;   /**< Links established */
+    uint32_t requests;      /**< Requests queued */
+    uint32_t gatt_errors;   /**< Transient errors */
+    uint32_t drops;         /**< Requests, work items and export records dropped */
+    uint64_t ticks;         /**< Tick count, see @ref wall_clock_ticks_get */
+} server_stats_t;
+
+static uint32_t          m_connections;    /**< Links established since boot. */
+static uint32_t          m_requests;       /**< Requests queued since boot. */
+static server_stats_t    m_stats_baseline; /**< Counters at the last reset from the Statistics Control Point. */
+static ble_stats_value_t m_stats_value;    /**< Statistics characteristic value, refreshed in the main loop. */
 
 
 /**@brief Callback function for asserts in the SoftDevice.
@@ -63,13 +116,847 @@ void assert_nrf_callback(uint16_t line_num, const uint8_t * p_file_name)
 }
 
 
-/**@brief Function for handling the Assistance Request Service client errors.
+/**@brief Function for handling a fatal error.
+ *
+ * @details Overrides the weak handler of the app_error library. The error is written to the flight
+ *          recorder, which survives the reset and is read out on the next boot.
+ *
+ * @param[in] id    Fault ID, NRF_FAULT_ID_*.
+ * @param[in] pc    Program counter of the fault, if known.
+ * @param[in] info  Fault information, depending on the ID.
+ */
+void app_error_fault_handler(uint32_t id, uint32_t pc, uint32_t info)
+{
+    __disable_irq();
+    flight_recorder_fault(id, pc, info);
+
+    NRF_LOG_ERROR("Fatal error, fault ID 0x%x at PC 0x%x", id, pc);
+    NRF_LOG_FINAL_FLUSH();
+    NRF_BREAKPOINT_COND;
+
+#ifndef DEBUG
+    NVIC_SystemReset();
+#else
+    app_error_save_and_stop(id, pc, info);
+#endif
+}
+
+
+/**@brief Function for recording an assistance event.
+ *
+ * @details The event is exported to the host gateway and, on edge servers, relayed to the station.
+ *
+ * @param[in] type         Record type.
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] arg0         Type specific argument.
+ * @param[in] arg1         Type specific argument.
+ * @param[in] value        Type specific value.
+ */
+static void assistance_event_record(event_export_type_t type,
+                                    uint16_t            conn_handle,
+                                    uint8_t             arg0,
+                                    uint8_t             arg1,
+                                    uint32_t            value)
+{
+    event_export_record(type, conn_handle, arg0, arg1, value);
+#if RELAY_ROLE == RELAY_ROLE_EDGE
+    relay_uplink_record(type, conn_handle, arg0);
+#endif
+}
+
+
+/**@brief Function for handing work from an event handler to the main loop.
+ *
+ * @param[in] type         Work item type.
+ * @param[in] conn_handle  Connection handle of the link, or BLE_CONN_HANDLE_INVALID.
+ * @param[in] arg          Type specific argument.
+ * @param[in] value        Type specific value.
+ */
+static void work_post(work_queue_type_t type, uint16_t conn_handle, uint8_t arg, uint32_t value)
+{
+    if (work_queue_post(type, conn_handle, arg, value) != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Work queue full, work item %d on conn_handle 0x%x dropped", type, conn_handle);
+    }
+}
+
+
+/**@brief Function for writing the request state of a wearable.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] req_state    Request state.
+ * @param[in] confirmed    True for a write request, confirmed by the wearable, false for a write command.
+ */
+static ret_code_t wearable_req_write(uint16_t conn_handle, uint8_t req_state, bool confirmed)
+{
+    if (load_generator_owns(conn_handle))
+    {
+        return load_generator_write(conn_handle, req_state, confirmed);
+    }
+
+    return confirmed ? ble_ars_c_assist_req_write(wearable_profile_ars_c_get(conn_handle), req_state)
+                     : ble_ars_c_assist_req_send(wearable_profile_ars_c_get(conn_handle), req_state);
+}
+
+
+/**@brief Function for getting the annunciation state of a request.
+ *
+ * @param[in] priority  Request priority.
+ */
+static annunciator_state_t request_annunciation(uint8_t priority)
+{
+    return (priority >= ASSISTANCE_REQUEST_URGENT_PRIO) ? ANNUNCIATOR_STATE_REQUEST_URGENT
+                                                        : ANNUNCIATOR_STATE_REQUEST;
+}
+
+
+/**@brief Function for ending the annunciation of a request that left the queue.
+ *
+ * @param[in] p_request  Removed request.
+ */
+static void request_annunciation_pop(const request_queue_item_t* p_request)
+{
+    annunciator_state_pop(request_annunciation(p_request->priority));
+    if (p_request->escalated)
+    {
+        annunciator_state_pop(ANNUNCIATOR_STATE_ESCALATED);
+    }
+}
+
+
+/**@brief Function for propagating a change of the pending request queue.
+ *
+ * @details Advertises the new load and saves the queue to retained RAM. Only called from the
+ *          main loop, which is also where roaming updates its advertising data for BLE events.
+ */
+static void request_queue_changed(void)
+{
+    roaming_load_set(request_queue_count());
+    retained_state_save();
+}
+
+
+/**@brief Function for updating the pending request queue with the request state of a wearable.
+ *
+ * @details A request stays pending until staff acknowledge it. The first time a request is seen,
+ *          the wearable is told that it was received (first acknowledgement phase).
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] req_state    Assistance request state read from the wearable.
+ */
+static void assist_req_state_update(uint16_t conn_handle, uint8_t req_state)
+{
+    ret_code_t           err_code;
+    request_queue_item_t request;
+    uint8_t              priority = req_state & ARS_REQ_PRIORITY_MASK;
+
+    if (req_state & ARS_REQ_FLAG_ACKNOWLEDGED)
+    {
+        priority = 0;
+    }
+
+    err_code = request_queue_find(conn_handle, &request);
+    if (err_code == NRF_SUCCESS && request.priority == priority)
+    {
+        // Unchanged, keep the request's place in the queue
+        return;
+    }
+    if (err_code != NRF_SUCCESS && priority == 0)
+    {
+        // Still idle, nothing to export or relay
+        return;
+    }
+
+    // Drop any older request of this wearable so that it is queued at most once
+    if (request_queue_remove(conn_handle, &request) == NRF_SUCCESS)
+    {
+        request_annunciation_pop(&request);
+        request_queue_changed();
+    }
+
+    assistance_event_record(EVENT_EXPORT_TYPE_REQUEST, conn_handle, req_state, 0, 0);
+
+    if (priority == 0)
+    {
+        return;
+    }
+
+    err_code = request_queue_push(conn_handle, priority);
+    if (err_code == NRF_SUCCESS)
+    {
+        m_requests++;
+        annunciator_state_push(request_annunciation(priority));
+        request_queue_changed();
+    }
+    else
+    {
+        NRF_LOG_WARNING("No free request record, request on conn_handle 0x%x dropped", conn_handle);
+    }
+
+    if (!(req_state & ARS_REQ_FLAG_RECEIVED))
+    {
+        err_code = wearable_req_write(conn_handle, ARS_REQ_FLAG_RECEIVED | priority, false);
+        if (err_code != NRF_SUCCESS)
+        {
+            NRF_LOG_INFO("Failed to send receipt to conn_handle 0x%x", conn_handle);
+        }
+    }
+}
+
+
+/**@brief Function for acknowledging the oldest request of the highest priority.
+ */
+static void assist_req_ack(void)
+{
+    ret_code_t           err_code;
+    request_queue_item_t request;
+
+    if (request_queue_pop(&request) != NRF_SUCCESS)
+    {
+        NRF_LOG_INFO("No pending assistance request");
+        return;
+    }
+    request_annunciation_pop(&request);
+    request_queue_changed();
+
+    NRF_LOG_INFO("Acknowledging assistance request on conn_handle 0x%x (priority %d, %d pending)",
+                 request.conn_handle, request.priority, request_queue_count());
+
+    // Second acknowledgement phase. The write is confirmed by the wearable, which stops the latency measurement.
+    assistance_event_record(EVENT_EXPORT_TYPE_ACK, request.conn_handle, request.priority, 0, UINT32_MAX);
+    ack_latency_start(request.conn_handle);
+    err_code = wearable_req_write(request.conn_handle,
+                                  ARS_REQ_FLAG_RECEIVED | ARS_REQ_FLAG_ACKNOWLEDGED | request.priority, true);
+    if (err_code != NRF_SUCCESS)
+    {
+        ack_latency_cancel(request.conn_handle);
+        NRF_LOG_INFO("Failed to send acknowledgement");
+    }
+}
+
+
+/**@brief Function for handling the wearable's confirmation of a staff acknowledgement.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] gatt_status  GATT status of the acknowledgement write.
+ */
+static void assist_req_ack_confirmed(uint16_t conn_handle, uint16_t gatt_status)
+{
+    uint32_t            latency_ms;
+    ack_latency_stats_t stats;
+
+    if (gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        ack_latency_cancel(conn_handle);
+        NRF_LOG_WARNING("Acknowledgement rejected by conn_handle 0x%x (status 0x%x)", conn_handle, gatt_status);
+        return;
+    }
+
+    latency_ms = ack_latency_stop(conn_handle);
+    if (latency_ms == UINT32_MAX)
+    {
+        return;
+    }
+
+    assistance_event_record(EVENT_EXPORT_TYPE_ACK, conn_handle, 0, 0, latency_ms);
+
+    ack_latency_stats_get(&stats);
+    NRF_LOG_INFO("Acknowledgement confirmed by conn_handle 0x%x after %d ms (p50 %d ms, max %d ms, %d acks)",
+                 conn_handle, latency_ms, stats.p50_ms, stats.max_ms, stats.count);
+}
+
+
+/**@brief Function for handing a wearable over to another server.
+ *
+ * @details The wearable keeps the request state across the handover. A pending request is written
+ *          back as received, so that the next server queues it without sending the receipt again.
+ *          The link is dropped once the wearable confirmed the write. Handovers wait for pending
+ *          staff acknowledgements to be confirmed.
+ *
+ * @param[in] p_item  Handover work item.
+ */
+static void handover_work(const work_queue_item_t* p_item)
+{
+    ret_code_t           err_code;
+    request_queue_item_t request;
+    uint16_t             conn_handle = p_item->conn_handle;
+    uint8_t              req_state   = 0;
+
+    // The link may have dropped since the handover was posted
+    if (!roaming_handover_pending(conn_handle))
+    {
+        return;
+    }
+
+    if (ack_latency_pending(conn_handle))
+    {
+        roaming_handover_defer(conn_handle);
+        return;
+    }
+
+    // The state saved on the wearable must not miss a change still held by the filter
+    request_filter_flush(conn_handle);
+
+    if (request_queue_find(conn_handle, &request) == NRF_SUCCESS)
+    {
+        req_state = ARS_REQ_FLAG_RECEIVED | request.priority;
+    }
+
+    assistance_event_record(EVENT_EXPORT_TYPE_HANDOVER, conn_handle, req_state, p_item->arg, 0);
+
+    if (req_state == 0)
+    {
+        roaming_handover_complete(conn_handle);
+        return;
+    }
+
+    err_code = ble_ars_c_assist_req_write(wearable_profile_ars_c_get(conn_handle), req_state);
+    if (err_code != NRF_SUCCESS)
+    {
+        // The wearable still holds the request and reports it to the next server
+        NRF_LOG_INFO("Failed to save request state on conn_handle 0x%x", conn_handle);
+        roaming_handover_complete(conn_handle);
+    }
+}
+
+
+/**@brief Function for handling a handover of a wearable to another server.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] rssi_dbm     Averaged RSSI of the link.
+ */
+static void roaming_handover_handler(uint16_t conn_handle, int8_t rssi_dbm)
+{
+    work_post(WORK_QUEUE_TYPE_HANDOVER, conn_handle, (uint8_t)(-rssi_dbm), 0);
+}
+
+
+/**@brief Function for dropping a restored request whose wearable did not reconnect.
+ *
+ * @param[in] p_item  Expiry work item, carrying the detached connection handle of the request.
+ */
+static void request_expired_work(const work_queue_item_t* p_item)
+{
+    if (request_queue_find(p_item->conn_handle, NULL) == NRF_SUCCESS)
+    {
+        NRF_LOG_INFO("Restored request 0x%x expired, wearable did not reconnect", p_item->conn_handle);
+        assist_req_state_update(p_item->conn_handle, 0);
+    }
+}
+
+
+/**@brief Function for handling the expiry of a restored request.
+ *
+ * @param[in] conn_handle  Detached connection handle of the request.
+ */
+static void retained_request_expired(uint16_t conn_handle)
+{
+    work_post(WORK_QUEUE_TYPE_REQUEST_EXPIRED, conn_handle, 0, 0);
+}
+
+
+static void request_state_work(const work_queue_item_t* p_item)
+{
+    request_filter_input(p_item->conn_handle, p_item->arg);
+}
+
+
+static void request_ack_work(const work_queue_item_t* p_item)
+{
+    assist_req_ack();
+}
+
+
+/**@brief Function for handling the confirmation of a request state write by a wearable.
+ *
+ * @details The write either saved the request state for a handover or acknowledged the request.
+ *
+ * @param[in] p_item  Write response work item.
+ */
+static void request_write_rsp_work(const work_queue_item_t* p_item)
+{
+    if (roaming_handover_pending(p_item->conn_handle))
+    {
+        roaming_handover_complete(p_item->conn_handle);
+    }
+    else
+    {
+        assist_req_ack_confirmed(p_item->conn_handle, (uint16_t)p_item->value);
+    }
+}
+
+
+/**@brief Function for dropping the request and the pending acknowledgement of a lost link.
+ *
+ * @param[in] p_item  Link work item.
+ */
+static void link_down_work(const work_queue_item_t* p_item)
+{
+    request_filter_reset(p_item->conn_handle);
+    assist_req_state_update(p_item->conn_handle, 0);
+    ack_latency_cancel(p_item->conn_handle);
+}
+
+
+static void relay_ready_work(const work_queue_item_t* p_item)
+{
+    relay_uplink_ready(wearable_profile_ars_c_get(p_item->conn_handle));
+}
+
+
+static void relay_write_rsp_work(const work_queue_item_t* p_item)
+{
+    relay_uplink_confirmed((uint16_t)p_item->value);
+}
+
+
+static void relay_write_error_work(const work_queue_item_t* p_item)
+{
+    relay_uplink_failed(p_item->value);
+}
+
+
+/**@brief Function for getting the cumulative counters of the Statistics characteristic.
+ *
+ * @param[out] p_stats  Counters since boot.
+ */
+static void server_stats_get(server_stats_t* p_stats)
+{
+    event_export_stats_t  export_stats;
+    error_budget_stats_t  error_stats;
+    request_queue_stats_t request_stats;
+    work_queue_stats_t    work_stats;
+    relay_uplink_stats_t  relay_stats;
+
+    event_export_stats_get(&export_stats);
+    error_budget_stats_get(&error_stats);
+    request_queue_stats_get(&request_stats);
+    work_queue_stats_get(&work_stats);
+    relay_uplink_stats_get(&relay_stats);
+
+    p_stats->connections = m_connections;
+    p_stats->requests    = m_requests;
+    p_stats->gatt_errors = error_stats.transient_count;
+    p_stats->drops       = request_stats.exhausted + work_stats.dropped + export_stats.records_dropped +
+                           relay_stats.dropped + relay_stats.rejected;
+    p_stats->ticks       = wall_clock_ticks_get();
+}
+
+
+/**@brief Function for refreshing the Statistics characteristic with the counters since the last reset.
+ *
+ * @details The counters and the acknowledgement latencies are only kept in the main loop, so the
+ *          value is computed here and served from a copy by @ref server_stats_value_get.
+ */
+static void server_stats_value_update(void)
+{
+    server_stats_t      stats;
+    ack_latency_stats_t ack_stats;
+    ble_stats_value_t   value = {0};
+
+    server_stats_get(&stats);
+    ack_latency_stats_get(&ack_stats);
+
+    value.connections = (uint16_t)MIN(stats.connections - m_stats_baseline.connections, UINT16_MAX);
+    value.requests    = (uint16_t)MIN(stats.requests - m_stats_baseline.requests, UINT16_MAX);
+    value.acks        = (uint16_t)MIN(ack_stats.count, UINT16_MAX);
+    value.gatt_errors = (uint16_t)MIN(stats.gatt_errors - m_stats_baseline.gatt_errors, UINT16_MAX);
+    value.drops       = (uint16_t)MIN(stats.drops - m_stats_baseline.drops, UINT16_MAX);
+    value.ack_p50_ms  = (uint16_t)MIN(ack_stats.p50_ms, UINT16_MAX);
+    value.ack_p90_ms  = (uint16_t)MIN(ack_stats.p90_ms, UINT16_MAX);
+    value.ack_p99_ms  = (uint16_t)MIN(ack_stats.p99_ms, UINT16_MAX);
+    value.period_min  = (uint16_t)MIN(wall_clock_ticks_to_ms(stats.ticks - m_stats_baseline.ticks) / 60000,
+                                      UINT16_MAX);
+
+    // Read from the SoftDevice handler
+    CRITICAL_REGION_ENTER();
+    m_stats_value = value;
+    CRITICAL_REGION_EXIT();
+}
+
+
+/**@brief Function for filling the Statistics characteristic on a read.
+ *
+ * @details Called from the SoftDevice handler, serves the value of the last refresh. Only the
+ *          link count, kept by ble_conn_state in the same context, is current.
+ *
+ * @param[out] p_value  Statistics characteristic value.
+ */
+static void server_stats_value_get(ble_stats_value_t* p_value)
+{
+    *p_value       = m_stats_value;
+    p_value->links = (uint8_t)ble_conn_state_conn_count();
+}
+
+
+/**@brief Function for handling a write of the reset opcode to the Statistics Control Point.
+ *
+ * @param[in] conn_handle  Connection handle of the peer.
+ */
+static void server_stats_reset(uint16_t conn_handle)
+{
+    work_post(WORK_QUEUE_TYPE_STATS_RESET, conn_handle, 0, 0);
+}
+
+
+static void stats_reset_work(const work_queue_item_t* p_item)
+{
+    server_stats_get(&m_stats_baseline);
+    ack_latency_reset();
+    server_stats_value_update();
+}
+
+
+/**@brief Function for initializing the work queue and the handlers of the request pipeline.
+ *
+ * @details Requests, their annunciation and the relay uplink are only handled in the main loop.
+ *          The BLE, BSP and timer handlers post work items for them.
+ */
+static void work_queue_start(void)
+{
+    ret_code_t err_code;
+
+    err_code = work_queue_init();
+    APP_ERROR_CHECK(err_code);
+
+    work_queue_handler_set(WORK_QUEUE_TYPE_REQUEST_STATE,     request_state_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_REQUEST_WRITE_RSP, request_write_rsp_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_REQUEST_ACK,       request_ack_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_REQUEST_EXPIRED,   request_expired_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_LINK_DOWN,         link_down_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_HANDOVER,          handover_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_RELAY_READY,       relay_ready_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_RELAY_WRITE_RSP,   relay_write_rsp_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_RELAY_WRITE_ERROR, relay_write_error_work);
+    work_queue_handler_set(WORK_QUEUE_TYPE_STATS_RESET,       stats_reset_work);
+}
+
+
+/**@brief Function for handling a request that went unacknowledged for the escalation timeout.
+ *
+ * @details The request keeps its place in the queue, the annunciation changes to the escalated
+ *          state until the request is acknowledged or withdrawn.
+ *
+ * @param[in] p_request  Escalated request.
+ */
+static void request_escalated(const request_queue_item_t* p_request)
+{
+    uint32_t pending_ms = wall_clock_elapsed_ms(p_request->time_ms);
+
+    NRF_LOG_WARNING("Request on conn_handle 0x%x (priority %d) unacknowledged for %d ms, escalating",
+                    p_request->conn_handle, p_request->priority, pending_ms);
+
+    annunciator_state_push(ANNUNCIATOR_STATE_ESCALATED);
+    assistance_event_record(EVENT_EXPORT_TYPE_ESCALATION, p_request->conn_handle, p_request->priority, 0, pending_ms);
+}
+
+
+/**@brief Function for restoring the pending requests and their annunciation after a reset.
+ *
+ * @details Runs before the BLE stack is enabled. The requests keep their order and arrival time,
+ *          and are reattached to their wearables as these reconnect.
+ */
+static void retained_requests_restore(void)
+{
+    ret_code_t           err_code;
+    request_queue_item_t request;
+    uint32_t             count = retained_state_request_count();
+    uint32_t             restore_us;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        err_code = retained_state_request_get(i, &request);
+        APP_ERROR_CHECK(err_code);
+
+        if (request_queue_restore(&request) == NRF_SUCCESS)
+        {
+            annunciator_state_push(request_annunciation(request.priority));
+        }
+    }
+    retained_state_save();
+
+    boot_profile_mark(BOOT_STAGE_REQUESTS_RESTORED);
+    restore_us = boot_profile_stage_us(BOOT_STAGE_REQUESTS_RESTORED);
+
+    err_code = retained_state_reattach_start(retained_request_expired);
+    APP_ERROR_CHECK(err_code);
+
+    NRF_LOG_INFO("Restart %d (reset reason 0x%x): %d requests restored %d us after reset",
+                 retained_state_restart_count_get(), retained_state_reset_reason_get(),
+                 request_queue_count(), restore_us);
+    event_export_record(EVENT_EXPORT_TYPE_RESTART, BLE_CONN_HANDLE_INVALID, request_queue_count(),
+                        (uint8_t)retained_state_reset_reason_get(), restore_us);
+}
+
+
+/**@brief Function for exporting the fault that caused the last reset, if any.
+ */
+static void stack_fault_report(void)
+{
+    stack_monitor_fault_t fault;
+
+    if (stack_monitor_fault_get(&fault))
+    {
+        event_export_record(EVENT_EXPORT_TYPE_FAULT, BLE_CONN_HANDLE_INVALID, fault.overflow, fault.exception,
+                            fault.pc);
+    }
+}
+
+
+/**@brief Function for reporting the boot profile.
+ *
+ * @details When bonds are erased, advertising only starts once the Peer Manager deleted them,
+ *          after the boot profile ended. The first advertisement is then not reported.
+ *
+ * @param[in] fast_start  True if advertising started before the deferred initialization.
+ */
+static void boot_report(bool fast_start)
+{
+    uint32_t first_adv_us;
+
+    boot_profile_report();
+
+    first_adv_us = boot_profile_stage_us(BOOT_STAGE_FIRST_ADVERTISEMENT);
+    if (first_adv_us == UINT32_MAX)
+    {
+        NRF_LOG_INFO("%s start: advertising not started yet, initialized %d us after reset",
+                     fast_start ? "Fast" : "Normal", boot_profile_stage_us(BOOT_STAGE_COMPLETE));
+    }
+    else
+    {
+        NRF_LOG_INFO("%s start: first advertisement %d us, initialized %d us after reset",
+                     fast_start ? "Fast" : "Normal", first_adv_us, boot_profile_stage_us(BOOT_STAGE_COMPLETE));
+
+        event_export_record(EVENT_EXPORT_TYPE_BOOT, BLE_CONN_HANDLE_INVALID, BOOT_STAGE_FIRST_ADVERTISEMENT,
+                            fast_start, first_adv_us);
+    }
+    event_export_record(EVENT_EXPORT_TYPE_BOOT, BLE_CONN_HANDLE_INVALID, BOOT_STAGE_COMPLETE,
+                        fast_start, boot_profile_stage_us(BOOT_STAGE_COMPLETE));
+}
+
+
+/**@brief Function for handling a wall clock sync.
+ *
+ * @param[in] p_sync  Sync result.
+ */
+static void wall_clock_sync_handler(const wall_clock_sync_t* p_sync)
+{
+    NRF_LOG_INFO("Wall clock synced from conn_handle 0x%x: offset %d ms, drift %d ppm%s",
+                 p_sync->conn_handle, p_sync->offset_ms, p_sync->drift_ppm,
+                 p_sync->drift_measured ? " (measured)" : "");
+
+    event_export_record(EVENT_EXPORT_TYPE_CLOCK_SYNC, p_sync->conn_handle, p_sync->drift_measured, 0,
+                        (uint32_t)p_sync->drift_ppm);
+}
+
+
+/**@brief Function for handling a wearable profile that became known.
  *
- * @param[in]   nrf_error   Error code containing information about what went wrong.
+ * @param[in] p_profile  Profile of the wearable.
  */
-static void ars_error_handler(uint32_t nrf_error)
+static void wearable_profile_ready_handler(const wearable_profile_t* p_profile)
 {
-    APP_ERROR_HANDLER(nrf_error);
+    NRF_LOG_INFO("Wearable on conn_handle 0x%x: model \"%s\", firmware \"%s\", battery %d%%",
+                 p_profile->conn_handle, NRF_LOG_PUSH((char*)p_profile->model),
+                 NRF_LOG_PUSH((char*)p_profile->fw_rev), p_profile->battery_level);
+    NRF_LOG_INFO("Wearable profile known %d ms after connect (discovery %d ms).",
+                 p_profile->ready_ms, p_profile->discovery_ms);
+
+    event_export_record(EVENT_EXPORT_TYPE_PROFILE, p_profile->conn_handle, p_profile->battery_level,
+                        MIN(p_profile->discovery_ms / 10, UINT8_MAX), p_profile->ready_ms);
+}
+
+
+/**@brief Function for logging the CPU cost of each annunciation pattern.
+ */
+static void annunciator_report(void)
+{
+    annunciator_pattern_info_t info;
+
+    for (uint32_t state = ANNUNCIATOR_STATE_IDLE + 1; state < ANNUNCIATOR_STATE_COUNT; state++)
+    {
+        annunciator_pattern_info_get((annunciator_state_t)state, &info);
+        NRF_LOG_INFO("Annunciator pattern %d: %d ms period, %d wakeups per period (%d if timer driven)",
+                     state, info.period_ms, info.wakeups_per_period, info.timer_wakeups_per_period);
+    }
+}
+
+
+/**@brief Server Statistics Service initialization.
+ */
+static void stats_service_init(void)
+{
+    ret_code_t       err_code;
+    ble_stats_init_t stats_init_obj;
+
+    stats_init_obj.value_handler = server_stats_value_get;
+    stats_init_obj.reset_handler = server_stats_reset;
+
+    err_code = ble_stats_init(&m_ble_stats, &stats_init_obj);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for exporting the statistics records and notifying the Statistics characteristic.
+ */
+static void stats_work(const work_queue_item_t* p_item)
+{
+    static uint32_t      last_records_sent;
+    ack_latency_stats_t  ack_stats;
+    event_export_stats_t export_stats;
+    error_budget_stats_t  error_stats;
+    stack_monitor_stats_t stack_stats;
+    request_queue_stats_t request_stats;
+    request_filter_stats_t filter_stats;
+    log_routing_stats_t   log_stats;
+    work_queue_stats_t    work_stats;
+
+    ack_latency_stats_get(&ack_stats);
+    event_export_stats_get(&export_stats);
+    error_budget_stats_get(&error_stats);
+    stack_monitor_stats_get(&stack_stats);
+    request_queue_stats_get(&request_stats);
+    request_filter_stats_get(&filter_stats);
+    log_routing_stats_get(&log_stats);
+    work_queue_stats_get(&work_stats);
+
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_PENDING_REQUESTS, 0, request_queue_count());
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_PENDING_REQUESTS_MAX, 0, request_stats.count_max);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_REQUESTS_REJECTED, 0, request_stats.exhausted);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_REQUEST_STATES_ABSORBED, 0, filter_stats.absorbed);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_ACK_COUNT, 0, ack_stats.count);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_ACK_P50_MS, 0, ack_stats.p50_ms);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_ACK_P99_MS, 0, ack_stats.p99_ms);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_RECORDS_SENT, 0, export_stats.records_sent);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_RECORDS_DROPPED, 0, export_stats.records_dropped);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_RECORDS_PER_SEC, 0,
+                        (export_stats.records_sent - last_records_sent) * 1000 / EVENT_EXPORT_STATS_INTERVAL_MS);
+
+    NRF_LOG_INFO("Event export: %d records/s, %d sent, %d dropped",
+                 (export_stats.records_sent - last_records_sent) * 1000 / EVENT_EXPORT_STATS_INTERVAL_MS,
+                 export_stats.records_sent, export_stats.records_dropped);
+
+    last_records_sent = export_stats.records_sent;
+
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_TRANSIENT_ERRORS, 0, error_stats.transient_count);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_LINK_RECOVERIES, 0, error_stats.recovery_count);
+
+    if (error_stats.transient_count > 0)
+    {
+        NRF_LOG_INFO("Error budget: %d transient errors (%d injected), %d links recovered, %d restarts",
+                     error_stats.transient_count, error_stats.injected_count, error_stats.recovery_count,
+                     retained_state_restart_count_get());
+    }
+
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_STACK_USED, stack_stats.nesting_max, stack_stats.used_max);
+
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_WORK_DEPTH_MAX, 0, work_stats.depth_max);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_WORK_DROPPED, 0, work_stats.dropped);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_WORK_ENQUEUE_CYCLES, 0, work_stats.enqueue_cycles_mean);
+
+    NRF_LOG_INFO("Request filter: %d states, %d transitions, %d absorbed",
+                 filter_stats.inputs, filter_stats.transitions, filter_stats.absorbed);
+
+    NRF_LOG_INFO("Work queue: %d posted, %d dropped, depth max %d, enqueue %d cycles (max %d)",
+                 work_stats.posted, work_stats.dropped, work_stats.depth_max,
+                 work_stats.enqueue_cycles_mean, work_stats.enqueue_cycles_max);
+
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_LOG_BACKLOG_MAX, 0, log_stats.backlog_max);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_LOG_UART_BUSY_MS, 0, log_stats.backends[LOG_ROUTING_BACKEND_UART].busy_ms);
+
+    NRF_LOG_DEBUG("Log: backlog max %d, RTT %d messages in %d ms, UART %d messages in %d ms",
+                  log_stats.backlog_max,
+                  log_stats.backends[LOG_ROUTING_BACKEND_RTT].messages, log_stats.backends[LOG_ROUTING_BACKEND_RTT].busy_ms,
+                  log_stats.backends[LOG_ROUTING_BACKEND_UART].messages, log_stats.backends[LOG_ROUTING_BACKEND_UART].busy_ms);
+
+#if BLE_EVT_TRACE_ENABLED
+    ble_evt_trace_stats_t trace_stats;
+
+    ble_evt_trace_stats_get(&trace_stats);
+    NRF_LOG_INFO("BLE event trace: %d records, %d dropped", trace_stats.records, trace_stats.dropped);
+#endif
+
+#if RELAY_ROLE == RELAY_ROLE_EDGE
+    relay_uplink_stats_t relay_stats;
+
+    relay_uplink_stats_get(&relay_stats);
+
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_RELAY_BUFFERED, 0, relay_stats.buffered);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_RELAY_LATENCY_MS, 0, relay_stats.latency_mean_ms);
+    event_export_record(EVENT_EXPORT_TYPE_STATS, BLE_CONN_HANDLE_INVALID,
+                        EVENT_EXPORT_STAT_RELAY_LOST, 0, relay_stats.dropped + relay_stats.rejected);
+
+    NRF_LOG_INFO("Relay: %d relayed, %d buffered, %d dropped, %d rejected by the station",
+                 relay_stats.relayed, relay_stats.buffered, relay_stats.dropped, relay_stats.rejected);
+    NRF_LOG_INFO("Relay: hop latency %d ms (max %d ms)", relay_stats.latency_mean_ms, relay_stats.latency_max_ms);
+#endif
+
+    server_stats_value_update();
+    ERROR_BUDGET_CHECK(ble_stats_notify(&m_ble_stats), BLE_CONN_HANDLE_INVALID);
+}
+
+
+/**@brief Function for handling the statistics timer timeout.
+ *
+ * @details The statistics are only read in the main loop, see @ref stats_work.
+ *
+ * @param[in] p_context  Unused.
+ */
+static void stats_timer_handler(void* p_context)
+{
+    work_post(WORK_QUEUE_TYPE_STATS, BLE_CONN_HANDLE_INVALID, 0, 0);
+}
+
+
+/**@brief Function for initializing the event export to the host gateway.
+ *
+ * @details Boards with USB CDC-ACM enabled (the pca10059 dongle) export over USB, others over UARTE.
+ */
+static void event_export_start(void)
+{
+    ret_code_t err_code;
+
+#if APP_USBD_CDC_ACM_ENABLED
+    err_code = export_usbd_init();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = event_export_init(export_usbd_tx);
+    APP_ERROR_CHECK(err_code);
+#else
+    err_code = export_uarte_init();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = event_export_init(export_uarte_tx);
+    APP_ERROR_CHECK(err_code);
+#endif
+
+    work_queue_handler_set(WORK_QUEUE_TYPE_STATS, stats_work);
+
+    err_code = app_timer_create(&m_stats_timer, APP_TIMER_MODE_REPEATED, stats_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_start(m_stats_timer, APP_TIMER_TICKS(EVENT_EXPORT_STATS_INTERVAL_MS), NULL);
+    APP_ERROR_CHECK(err_code);
 }
 
 
@@ -98,43 +985,57 @@ static void sleep_mode_enter(void)
  */
 static void ars_c_evt_handler(ble_ars_c_t* p_ars_c, ble_ars_c_evt_t* p_ars_c_evt)
 {
+    uint32_t begin = CYCLE_PROFILE_BEGIN();
+
     switch (p_ars_c_evt->evt_type)
     {
         case BLE_ARS_C_EVT_DISCOVERY_COMPLETE:
         {
-            ret_code_t err_code;
-
-            err_code = ble_ars_c_handles_assign(&m_ble_ars_c,
-                                                p_ars_c_evt->conn_handle,
-                                                &p_ars_c_evt->params.peer_db);
             NRF_LOG_INFO("Assistance request service discovered on conn_handle 0x%x.", p_ars_c_evt->conn_handle);
 
-            // Assistance Request service discovered. Enable notification of assistance request.
-            //err_code = ble_ars_c_assist_req_notif_enable(p_ars_c);
-            //APP_ERROR_CHECK(err_code);
+            if (p_ars_c_evt->params.peer_db.relay_handle != BLE_GATT_HANDLE_INVALID)
+            {
+                // The peer is the station
+                work_post(WORK_QUEUE_TYPE_RELAY_READY, p_ars_c_evt->conn_handle, 0, 0);
+            }
 
-            NRF_LOG_INFO("Reading assistance request state...");
-            err_code = ble_ars_c_assist_req_get(&m_ble_ars_c);
-            APP_ERROR_CHECK(err_code);
+            // The assistance request state of wearables is read by the wearable profile, together
+            // with the battery level and device information
         } break; // BLE_ARS_C_EVT_DISCOVERY_COMPLETE
 
         case BLE_ARS_C_EVT_BUTTON_NOTIFICATION:
         {
-            NRF_LOG_INFO("Assistance Request state changed on peer to 0x%x.", p_ars_c_evt->params.request.req_state);
-            if (p_ars_c_evt->params.request.req_state)
-            {
-                bsp_board_led_on(ASSISTANCE_REQUEST_LED);
-            }
-            else
-            {
-                bsp_board_led_off(ASSISTANCE_REQUEST_LED);
-            }
+            NRF_LOG_DEBUG("Assistance Request state changed on peer to 0x%x.", p_ars_c_evt->params.request.req_state);
+            work_post(WORK_QUEUE_TYPE_REQUEST_STATE, p_ars_c_evt->conn_handle, p_ars_c_evt->params.request.req_state, 0);
         } break; // BLE_ARS_C_EVT_BUTTON_NOTIFICATION
 
+        case BLE_ARS_C_EVT_ASSIST_REQ_READ:
+        {
+            NRF_LOG_DEBUG("Assistance Request state read from peer: 0x%x.", p_ars_c_evt->params.request.req_state);
+            work_post(WORK_QUEUE_TYPE_REQUEST_STATE, p_ars_c_evt->conn_handle, p_ars_c_evt->params.request.req_state, 0);
+        } break; // BLE_ARS_C_EVT_ASSIST_REQ_READ
+
+        case BLE_ARS_C_EVT_ASSIST_REQ_WRITE_RSP:
+        {
+            work_post(WORK_QUEUE_TYPE_REQUEST_WRITE_RSP, p_ars_c_evt->conn_handle, 0, p_ars_c_evt->params.gatt_status);
+        } break; // BLE_ARS_C_EVT_ASSIST_REQ_WRITE_RSP
+
+        case BLE_ARS_C_EVT_RELAY_WRITE_RSP:
+        {
+            work_post(WORK_QUEUE_TYPE_RELAY_WRITE_RSP, p_ars_c_evt->conn_handle, 0, p_ars_c_evt->params.gatt_status);
+        } break; // BLE_ARS_C_EVT_RELAY_WRITE_RSP
+
+        case BLE_ARS_C_EVT_RELAY_WRITE_ERROR:
+        {
+            work_post(WORK_QUEUE_TYPE_RELAY_WRITE_ERROR, p_ars_c_evt->conn_handle, 0, p_ars_c_evt->params.nrf_error);
+        } break; // BLE_ARS_C_EVT_RELAY_WRITE_ERROR
+
         default:
             // No implementation needed.
             break;
     }
+
+    CYCLE_PROFILE_END(CYCLE_PROFILE_POINT_ARS_C_EVT, begin);
 }
 
 
@@ -143,7 +1044,7 @@ static void ars_c_evt_handler(ble_ars_c_t* p_ars_c, ble_ars_c_evt_t* p_ars_c_evt
  * @param[in]   event   Event generated when button is pressed.
  */
 void bsp_event_handler(bsp_event_t event) {
-    ret_code_t err_code;
+    uint32_t begin = CYCLE_PROFILE_BEGIN();
 
     switch (event) {
         case BSP_EVENT_SLEEP:
@@ -151,13 +1052,15 @@ void bsp_event_handler(bsp_event_t event) {
             break;
 
         case ASSISTANCE_REQUEST_ACK_BUTTON: {
-            bsp_board_led_off(ASSISTANCE_REQUEST_LED);
+            work_post(WORK_QUEUE_TYPE_REQUEST_ACK, BLE_CONN_HANDLE_INVALID, 0, 0);
         } break;
 
         default: break;
     }
 
     ble_bsp_evt_handler(event);
+
+    CYCLE_PROFILE_END(CYCLE_PROFILE_POINT_BSP_EVT, begin);
 }
 
 
@@ -168,7 +1071,12 @@ void bsp_event_handler(bsp_event_t event) {
 void ble_adv_evt_handler(ble_adv_evt_t ble_adv_evt) {
     switch (ble_adv_evt) {
         case BLE_ADV_EVT_IDLE:
-            sleep_mode_enter();
+            // Keep accepting wearables while others are connected
+            if (ble_conn_state_peripheral_conn_count() > 0) {
+                advertising_start(false);
+            } else {
+                sleep_mode_enter();
+            }
             break;
 
         default: break;
@@ -176,57 +1084,52 @@ void ble_adv_evt_handler(ble_adv_evt_t ble_adv_evt) {
 }
 
 
-/**@brief User function for handling BLE events.
+/**@brief User function for handling the Connected event.
+ *
+ * @details Only wearable links are handled, not the uplink of an edge server to the station.
  *
  * @param[in]   p_ble_evt   Bluetooth stack event.
  * @param[in]   p_context   Unused.
  */
-void ble_evt_handler(const ble_evt_t* p_ble_evt, void* p_context) {
-    ret_code_t err_code = NRF_SUCCESS;
-    uint8_t assist_requested;
-
+static void on_connected(const ble_evt_t* p_ble_evt, void* p_context) {
     const ble_gap_evt_t* p_gap_evt = &p_ble_evt->evt.gap_evt;
 
-    switch (p_ble_evt->header.evt_id)
-    {
-        case BLE_GAP_EVT_CONNECTED: {
-            bsp_board_led_on(CONNECTED_LED);
-            err_code = ble_ars_c_handles_assign(&m_ble_ars_c, p_gap_evt->conn_handle, NULL);
-            APP_ERROR_CHECK(err_code);
-        } break;
+    if (p_gap_evt->params.connected.role != BLE_GAP_ROLE_PERIPH) {
+        return;
+    }
 
-        case BLE_GAP_EVT_DISCONNECTED: {
-            bsp_board_led_off(CONNECTED_LED);
-        } break;
+    m_connections++;
+    event_export_record(EVENT_EXPORT_TYPE_LINK, p_gap_evt->conn_handle, true, 0, 0);
+    bsp_board_led_on(CONNECTED_LED);
+}
 
-        case BLE_GATTC_EVT_READ_RSP: {
-            assist_requested = p_ble_evt->evt.gattc_evt.params.read_rsp.data[0];
-
-            if (assist_requested) {
-                NRF_LOG_INFO("Assistance request received");
-                bsp_board_led_on(ASSISTANCE_REQUEST_LED);
-
-                NRF_LOG_INFO("Acknowledging assistance request...");
-                err_code = ble_ars_c_assist_req_send(&m_ble_ars_c, false);
-                if (err_code == NRF_SUCCESS &&
-                    err_code != BLE_ERROR_INVALID_CONN_HANDLE &&
-                    err_code != NRF_ERROR_INVALID_STATE) {
-                    APP_ERROR_CHECK(err_code);
-                    NRF_LOG_INFO("Acknowledgement sent");
-                }
-                if (err_code != NRF_SUCCESS) {
-                    NRF_LOG_INFO("Failed to send acknowledgement");
-                }
-            }
-            else {
-                bsp_board_led_off(ASSISTANCE_REQUEST_LED);
-            }
-        } break;
 
-        default: break;
+/**@brief User function for handling the Disconnected event.
+ *
+ * @details Only wearable links are handled, not the uplink of an edge server to the station.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_disconnected(const ble_evt_t* p_ble_evt, void* p_context) {
+    const ble_gap_evt_t* p_gap_evt = &p_ble_evt->evt.gap_evt;
+
+    // ble_conn_state only purges the link with the next BLE event, so its role is still known
+    if (ble_conn_state_role(p_gap_evt->conn_handle) != BLE_GAP_ROLE_PERIPH) {
+        return;
     }
+
+    event_export_record(EVENT_EXPORT_TYPE_LINK, p_gap_evt->conn_handle, false,
+                        p_gap_evt->params.disconnected.reason, 0);
+    if (ble_conn_state_peripheral_conn_count() == 0) {
+        bsp_board_led_off(CONNECTED_LED);
+    }
+    work_post(WORK_QUEUE_TYPE_LINK_DOWN, p_gap_evt->conn_handle, 0, 0);
 }
 
+BLE_EVT_ROUTE(m_connected_route,    BLE_GAP_EVT_CONNECTED,    APP_BLE_USER_ROUTE_PRIO, on_connected,    NULL);
+BLE_EVT_ROUTE(m_disconnected_route, BLE_GAP_EVT_DISCONNECTED, APP_BLE_USER_ROUTE_PRIO, on_disconnected, NULL);
+
 
 /**@brief Function for handling database discovery events.
  *
@@ -234,43 +1137,106 @@ void ble_evt_handler(const ble_evt_t* p_ble_evt, void* p_context) {
  */
 static void db_disc_handler(ble_db_discovery_evt_t* p_evt)
 {
-    ble_ars_on_db_disc_evt(&m_ble_ars_c, p_evt);
+    wearable_profile_on_db_disc_evt(p_evt);
+    wall_clock_on_db_disc_evt(p_evt);
 }
 
 /**@brief Function for handling the idle state (main loop).
  *
- * @details If there is no pending log operation, then sleep until next the next event occurs.
+ * @details Handles the work posted by the event handlers and hands buffered export records to the
+ *          transport. If there is no pending log operation, then sleep until next the next event occurs.
  */
 static void idle_state_handle(void)
 {
-    if (NRF_LOG_PROCESS() == false)
+    uint32_t begin;
+    bool     log_pending;
+
+    stack_monitor_sample();
+    work_queue_process();
+    flight_recorder_process();
+
+#if APP_USBD_CDC_ACM_ENABLED
+    export_usbd_process();
+#endif
+    begin = CYCLE_PROFILE_BEGIN();
+    event_export_process();
+    CYCLE_PROFILE_END(CYCLE_PROFILE_POINT_EXPORT_PROCESS, begin);
+
+    begin       = CYCLE_PROFILE_BEGIN();
+    log_pending = log_routing_process();
+    CYCLE_PROFILE_END(CYCLE_PROFILE_POINT_LOG_PROCESS, begin);
+
+    if (log_pending == false)
     {
         nrf_pwr_mgmt_run();
     }
 }
 
 
-/**@brief Assistance Request client initialization.
+/**@brief Wearable profile clients initialization (Assistance Request, Battery and Device Information).
  */
-static void ars_c_init(nrf_ble_gq_t* p_gatt_queue)
+static void wearable_profile_c_init(nrf_ble_gq_t* p_gatt_queue)
 {
-    ret_code_t       err_code;
-    ble_ars_c_init_t ars_c_init_obj;
+    ret_code_t              err_code;
+    wearable_profile_init_t profile_init_obj;
 
-    ars_c_init_obj.evt_handler   = ars_c_evt_handler;
-    ars_c_init_obj.p_gatt_queue  = p_gatt_queue;
-    ars_c_init_obj.error_handler = ars_error_handler;
+    profile_init_obj.p_gatt_queue    = p_gatt_queue;
+    profile_init_obj.ars_evt_handler = ars_c_evt_handler;
+    profile_init_obj.ready_handler   = wearable_profile_ready_handler;
+    profile_init_obj.error_handler   = error_budget_handler;
 
-    err_code = ble_ars_c_init(&m_ble_ars_c, &ars_c_init_obj);
+    err_code = wearable_profile_init(&profile_init_obj);
     APP_ERROR_CHECK(err_code);
 }
 
 
+#if RELAY_ROLE == RELAY_ROLE_STATION
+/**@brief Assistance Request Service initialization.
+ */
+static void ars_init(void)
+{
+    ret_code_t     err_code;
+    ble_ars_init_t ars_init_obj;
+
+    ars_init_obj.relay_write_handler = relay_station_on_write;
+
+    err_code = ble_ars_init(&m_ble_ars, &ars_init_obj);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for logging the address edge servers connect to (RELAY_STATION_ADDR).
+ */
+static void station_addr_log(void)
+{
+    ret_code_t     err_code;
+    ble_gap_addr_t addr;
+
+    err_code = sd_ble_gap_addr_get(&addr);
+    APP_ERROR_CHECK(err_code);
+
+    NRF_LOG_INFO("Station address: %02x:%02x:%02x:%02x:%02x:%02x",
+                 addr.addr[5], addr.addr[4], addr.addr[3], addr.addr[2], addr.addr[1], addr.addr[0]);
+}
+#endif
+
+
 /**@brief Function for application main entry.
  */
 int main(void)
 {
-    bool erase_bonds;
+    ret_code_t err_code;
+    bool       erase_bonds;
+    bool       flight_restored;
+
+    boot_profile_init();
+
+    err_code = stack_monitor_init();
+    APP_ERROR_CHECK(err_code);
+
+    retained_state_init();
+    flight_restored = flight_recorder_init(retained_state_reset_reason_get());
+    boot_profile_mark(BOOT_STAGE_RETAINED_STATE);
 
     // Board services config
     board_services_init_t board_init = {0};
@@ -280,29 +1246,123 @@ int main(void)
     // BLE services config
     ble_services_init_t ble_init = {0};
     ble_gattc_service_init_func_t init_funcs[] = {
-        ars_c_init
+        wearable_profile_c_init,
+        wall_clock_cts_c_init
     };
 
     ble_init.p_ble_advertising       = &m_advertising;
-    ble_init.p_ble_db_discovery      = &m_db_disc;
+    ble_init.p_ble_db_discovery      = m_db_disc;
     ble_init.p_ble_gatt              = &m_gatt;
     ble_init.p_ble_qatt_queue        = &m_gatt_queue;
-    ble_init.p_ble_qwr               = &m_qwr;
+    ble_init.p_ble_qwr               = m_qwr;
     ble_init.adv_evt_handler         = ble_adv_evt_handler;
-    ble_init.ble_evt_handler         = ble_evt_handler;
     ble_init.db_disc_evt_handler     = db_disc_handler;
     ble_init.gattc_init_funcs        = init_funcs;
     ble_init.gattc_init_func_count   = sizeof(init_funcs) / sizeof(init_funcs[0]);
+    ble_init.fast_start              = BOOT_FAST_START;
+
+    ble_gatts_service_init_func_t gatts_init_funcs[] = {
+        stats_service_init,
+#if RELAY_ROLE == RELAY_ROLE_STATION
+        ars_init
+#endif
+    };
+
+    ble_init.gatts_init_funcs        = gatts_init_funcs;
+    ble_init.gatts_init_func_count   = sizeof(gatts_init_funcs) / sizeof(gatts_init_funcs[0]);
 
     // Initialize
+    err_code = request_queue_init();
+    APP_ERROR_CHECK(err_code);
+
+    work_queue_start();
+
+    ack_latency_init();
     board_services_init(&board_init);
+
+    // Bonds are erased through the Peer Manager, so erasing them needs the full initialization first
+    if (erase_bonds) {
+        ble_init.fast_start = false;
+    }
+
+    err_code = wall_clock_init(wall_clock_sync_handler);
+    APP_ERROR_CHECK(err_code);
+    boot_profile_mark(BOOT_STAGE_WALL_CLOCK);
+
+    err_code = error_budget_init();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = stack_monitor_start();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = cycle_profile_init();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = flight_recorder_start();
+    APP_ERROR_CHECK(err_code);
+
+    // Before the restore, restored requests escalate relative to their arrival time
+    err_code = timer_wheel_init();
+    APP_ERROR_CHECK(err_code);
+    request_queue_escalation_set(REQUEST_ESCALATION_TIMEOUT_MS, request_escalated);
+
+    err_code = request_filter_init(assist_req_state_update);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = load_generator_start();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = annunciator_init(ASSISTANCE_REQUEST_LED);
+    APP_ERROR_CHECK(err_code);
+    boot_profile_mark(BOOT_STAGE_ANNUNCIATOR);
+
+    event_export_start();
+    boot_profile_mark(BOOT_STAGE_EVENT_EXPORT);
+    stack_fault_report();
+    if (flight_restored) {
+        // The last records before the reset
+        flight_recorder_log();
+        flight_recorder_dump();
+    }
+    retained_requests_restore();
+
     ble_services_init(&ble_init);
 
+    err_code = roaming_init(roaming_handover_handler);
+    APP_ERROR_CHECK(err_code);
+    roaming_load_set(request_queue_count());
+    boot_profile_mark(BOOT_STAGE_ROAMING);
+
+    if (ble_init.fast_start) {
+        advertising_start(false);
+    }
+
+    // Subsystems not needed for the first connection
+    ble_services_deferred_init();
+
+#if RELAY_ROLE == RELAY_ROLE_EDGE
+    err_code = relay_uplink_init();
+    APP_ERROR_CHECK(err_code);
+    boot_profile_mark(BOOT_STAGE_RELAY);
+#elif RELAY_ROLE == RELAY_ROLE_STATION
+    station_addr_log();
+#endif
+
+#if APP_USBD_CDC_ACM_ENABLED
+    err_code = export_usbd_start();
+    APP_ERROR_CHECK(err_code);
+    boot_profile_mark(BOOT_STAGE_USBD);
+#endif
+
+    if (!ble_init.fast_start) {
+        advertising_start(erase_bonds);
+    }
+
     // Start execution
+    boot_report(ble_init.fast_start);
+    annunciator_report();
     NRF_LOG_INFO("Assistance server started");
 
-    advertising_start(erase_bonds);
-
     // Enter main loop
     for (;;) {
         idle_state_handle();
@@ -0,0 +1,329 @@
+#include "relay.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "ble.h"
+#include "ble_conn_state.h"
+#include "nrf_queue.h"
+#include "nrf_sdh_ble.h"
+#include "ble_service/ble_evt_router.h"
+
+#include "nrf_log.h"
+
+
+#if (RELAY_ROLE == RELAY_ROLE_EDGE) && (NRF_SDH_BLE_CENTRAL_LINK_COUNT == 0)
+#error "The relay edge role needs a central link, set NRF_SDH_BLE_CENTRAL_LINK_COUNT in sdk_config.h"
+#endif
+
+#define AGE_UNIT_MS     100     // Unit of relay_record_t.age
+
+
+/**@brief Buffered relay record */
+typedef struct {
+    relay_record_t record;          /**< Record, age not set yet */
+    uint32_t       event_ticks;     /**< app_timer tick count at which the event happened */
+} relay_item_t;
+
+
+NRF_QUEUE_DEF(relay_item_t, m_relay_buffer, RELAY_BUFFER_SIZE, NRF_QUEUE_MODE_NO_OVERFLOW);
+APP_TIMER_DEF(m_connect_timer);
+
+static bool                 m_enabled;
+static uint16_t             m_uplink_conn_handle = BLE_CONN_HANDLE_INVALID;
+static ble_ars_c_t*         mp_uplink;          // Client of the station, NULL until the Relay characteristic is discovered
+static bool                 m_in_flight;        // The record at the head of the buffer waits for confirmation
+static uint8_t              m_seq;
+static uint64_t             m_latency_total_ms;
+static relay_uplink_stats_t m_stats;
+
+static const ble_gap_addr_t m_station_addr =
+{
+    .addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC,
+    .addr      = RELAY_STATION_ADDR
+};
+
+static const ble_gap_scan_params_t m_connect_scan_params =
+{
+    .active        = 0,
+    .interval      = RELAY_SCAN_INTERVAL,
+    .window        = RELAY_SCAN_WINDOW,
+    .timeout       = RELAY_CONNECT_TIMEOUT,
+    .scan_phys     = BLE_GAP_PHY_1MBPS,
+    .filter_policy = BLE_GAP_SCAN_FP_ACCEPT_ALL,
+};
+
+static const ble_gap_conn_params_t m_uplink_conn_params =
+{
+    .min_conn_interval = RELAY_MIN_CONN_INTERVAL,
+    .max_conn_interval = RELAY_MAX_CONN_INTERVAL,
+    .slave_latency     = 0,
+    .conn_sup_timeout  = RELAY_CONN_SUP_TIMEOUT,
+};
+
+
+static uint32_t ticks_to_ms(uint32_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * 1000) / APP_TIMER_CLOCK_FREQ);
+}
+
+
+/**@brief Function for retrying the uplink connection after @ref RELAY_RECONNECT_INTERVAL_MS.
+ */
+static void connect_retry(void)
+{
+    ret_code_t err_code;
+
+    err_code = app_timer_start(m_connect_timer, APP_TIMER_TICKS(RELAY_RECONNECT_INTERVAL_MS), NULL);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for connecting to the station.
+ *
+ * @param[in] p_context  Unused.
+ */
+static void connect_timer_handler(void* p_context)
+{
+    ret_code_t err_code;
+
+    if (m_uplink_conn_handle != BLE_CONN_HANDLE_INVALID)
+    {
+        return;
+    }
+
+    err_code = sd_ble_gap_connect(&m_station_addr, &m_connect_scan_params, &m_uplink_conn_params,
+                                  APP_BLE_CONN_CFG_TAG);
+    if (err_code != NRF_SUCCESS)
+    {
+        // The scanner is shared with roaming and may be busy
+        NRF_LOG_DEBUG("Uplink connection not started: 0x%x", err_code);
+        connect_retry();
+    }
+}
+
+
+/**@brief Function for sending the record at the head of the buffer.
+ */
+static void send_next(void)
+{
+    ret_code_t   err_code;
+    relay_item_t item;
+    uint32_t     age_ms;
+    ble_ars_c_t* p_uplink = mp_uplink;    // Cleared by the Disconnected event, which can preempt the main loop
+
+    if (p_uplink == NULL || m_in_flight || nrf_queue_peek(&m_relay_buffer, &item) != NRF_SUCCESS)
+    {
+        return;
+    }
+
+    age_ms          = ticks_to_ms(app_timer_cnt_diff_compute(app_timer_cnt_get(), item.event_ticks));
+    item.record.age = (uint16_t)MIN(age_ms / AGE_UNIT_MS, UINT16_MAX);
+
+    err_code = ble_ars_c_relay_write(p_uplink, (const uint8_t*)&item.record, sizeof(item.record));
+    if (err_code == NRF_SUCCESS)
+    {
+        m_in_flight = true;
+    }
+    else
+    {
+        // Sent again with the next record or after reconnecting
+        NRF_LOG_WARNING("Relay record not sent: 0x%x", err_code);
+    }
+}
+
+
+/**@brief Function for handling the Connected event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_connected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    const ble_gap_evt_t* p_gap_evt = &p_ble_evt->evt.gap_evt;
+
+    // The uplink is the only link initiated by this server
+    if (!m_enabled || p_gap_evt->params.connected.role != BLE_GAP_ROLE_CENTRAL)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Uplink to station connected.");
+    m_uplink_conn_handle = p_gap_evt->conn_handle;
+}
+
+
+/**@brief Function for handling the Disconnected event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_disconnected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    if (!m_enabled || p_ble_evt->evt.gap_evt.conn_handle != m_uplink_conn_handle)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Uplink to station lost, %d records buffered.", nrf_queue_utilization_get(&m_relay_buffer));
+    m_uplink_conn_handle = BLE_CONN_HANDLE_INVALID;
+    mp_uplink            = NULL;
+    m_in_flight          = false;
+
+    connect_retry();
+}
+
+
+/**@brief Function for handling the Timeout event.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void on_timeout(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    if (m_enabled && p_ble_evt->evt.gap_evt.params.timeout.src == BLE_GAP_TIMEOUT_SRC_CONN)
+    {
+        connect_retry();
+    }
+}
+
+BLE_EVT_ROUTE(m_connected_route,    BLE_GAP_EVT_CONNECTED,    APP_BLE_OBSERVER_PRIO, on_connected,    NULL);
+BLE_EVT_ROUTE(m_disconnected_route, BLE_GAP_EVT_DISCONNECTED, APP_BLE_OBSERVER_PRIO, on_disconnected, NULL);
+BLE_EVT_ROUTE(m_timeout_route,      BLE_GAP_EVT_TIMEOUT,      APP_BLE_OBSERVER_PRIO, on_timeout,      NULL);
+
+
+ret_code_t relay_uplink_init(void)
+{
+    ret_code_t err_code;
+
+    nrf_queue_reset(&m_relay_buffer);
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_latency_total_ms = 0;
+
+    err_code = app_timer_create(&m_connect_timer, APP_TIMER_MODE_SINGLE_SHOT, connect_timer_handler);
+    VERIFY_SUCCESS(err_code);
+
+    m_enabled = true;
+    connect_timer_handler(NULL);
+
+    return NRF_SUCCESS;
+}
+
+
+void relay_uplink_record(event_export_type_t type, uint16_t conn_handle, uint8_t arg0)
+{
+    relay_item_t item;
+
+    // Only wearable events are relayed, not those of the uplink
+    if (!m_enabled || ble_conn_state_role(conn_handle) == BLE_GAP_ROLE_CENTRAL)
+    {
+        return;
+    }
+
+    item.record.seq  = m_seq++;
+    item.record.type = type;
+    item.record.link = (uint8_t)ble_conn_state_conn_idx(conn_handle);
+    item.record.arg0 = arg0;
+    item.record.age  = 0;
+    item.event_ticks = app_timer_cnt_get();
+
+    if (nrf_queue_push(&m_relay_buffer, &item) != NRF_SUCCESS)
+    {
+        m_stats.dropped++;
+        NRF_LOG_WARNING("Relay buffer full, record dropped");
+        return;
+    }
+
+    send_next();
+}
+
+
+void relay_uplink_ready(ble_ars_c_t* p_ars_c)
+{
+    if (!m_enabled || p_ars_c == NULL || p_ars_c->conn_handle != m_uplink_conn_handle)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Station discovered, sending %d buffered records.", nrf_queue_utilization_get(&m_relay_buffer));
+    mp_uplink = p_ars_c;
+    send_next();
+}
+
+
+void relay_uplink_confirmed(uint16_t gatt_status)
+{
+    relay_item_t item;
+    uint32_t     latency_ms;
+
+    if (!m_in_flight || nrf_queue_pop(&m_relay_buffer, &item) != NRF_SUCCESS)
+    {
+        return;
+    }
+    m_in_flight = false;
+
+    if (gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        // The station would reject the record again, so it is not sent again
+        m_stats.rejected++;
+        NRF_LOG_WARNING("Relay record rejected by station (status 0x%x)", gatt_status);
+    }
+    else
+    {
+        latency_ms = ticks_to_ms(app_timer_cnt_diff_compute(app_timer_cnt_get(), item.event_ticks));
+
+        m_stats.relayed++;
+        m_stats.latency_last_ms = latency_ms;
+        m_stats.latency_max_ms  = MAX(m_stats.latency_max_ms, latency_ms);
+        m_latency_total_ms     += latency_ms;
+    }
+
+    send_next();
+}
+
+
+void relay_uplink_failed(uint32_t nrf_error)
+{
+    if (!m_in_flight)
+    {
+        return;
+    }
+
+    // No response follows, the record is sent again like one that was not queued
+    m_in_flight = false;
+    NRF_LOG_WARNING("Relay record not sent: 0x%x", nrf_error);
+}
+
+
+void relay_uplink_stats_get(relay_uplink_stats_t* p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return;
+    }
+
+    *p_stats          = m_stats;
+    p_stats->buffered = nrf_queue_utilization_get(&m_relay_buffer);
+    if (m_stats.relayed > 0)
+    {
+        p_stats->latency_mean_ms = (uint32_t)(m_latency_total_ms / m_stats.relayed);
+    }
+}
+
+
+void relay_station_on_write(uint16_t conn_handle, const uint8_t* p_data, uint16_t length)
+{
+    relay_record_t record;
+
+    if (length != sizeof(relay_record_t))
+    {
+        NRF_LOG_WARNING("Relay record of unexpected length %d from conn_handle 0x%x", length, conn_handle);
+        return;
+    }
+    memcpy(&record, p_data, sizeof(record));
+
+    NRF_LOG_INFO("Relayed event %d from conn_handle 0x%x, link %d (seq %d, %d ms old)",
+                 record.type, conn_handle, record.link, record.seq, (uint32_t)record.age * AGE_UNIT_MS);
+    event_export_record(EVENT_EXPORT_TYPE_RELAY, conn_handle, record.type, record.arg0,
+                        ((uint32_t)record.link << 24) | ((uint32_t)record.seq << 16) | record.age);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "app_util.h"
+#include "ble_service/ble_ars_c/ble_ars_c.h"
+#include "export_service/event_export.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Relay record
+ *
+ * @details Written little endian to the station's Relay characteristic, one record per Write
+ *          Request. Records are delivered at least once: a record whose write was not confirmed
+ *          before the uplink dropped is sent again, and the sequence number lets the station
+ *          detect the duplicate.
+ */
+typedef PACKED_STRUCT {
+    uint8_t  seq;           /**< Record sequence number of the edge server */
+    uint8_t  type;          /**< @ref event_export_type_t */
+    uint8_t  link;          /**< Connection index of the wearable on the edge server */
+    uint8_t  arg0;          /**< Type specific argument arg0, see @ref event_export_type_t */
+    uint16_t age;           /**< Time the event spent on the edge server before this write, in units of 100 ms */
+} relay_record_t;
+
+STATIC_ASSERT(sizeof(relay_record_t) == 6);
+
+/**@brief Uplink statistics */
+typedef struct {
+    uint32_t relayed;           /**< Records confirmed by the station */
+    uint32_t dropped;           /**< Records dropped because the buffer was full */
+    uint32_t rejected;          /**< Records the station rejected with a GATT error, not sent again */
+    uint32_t buffered;          /**< Records waiting for the uplink */
+    uint32_t latency_last_ms;   /**< Hop latency of the last record, from the event to the station's confirmation */
+    uint32_t latency_mean_ms;   /**< Mean hop latency */
+    uint32_t latency_max_ms;    /**< Maximum hop latency */
+} relay_uplink_stats_t;
+
+
+
+/**@brief Function for starting the uplink to the station server.
+ *
+ * @details Connects to the station at @ref RELAY_STATION_ADDR and reconnects whenever the uplink
+ *          drops. Requires a central link (NRF_SDH_BLE_CENTRAL_LINK_COUNT).
+ */
+ret_code_t relay_uplink_init(void);
+
+
+/**@brief Function for relaying an assistance event to the station.
+ *
+ * @details The record is buffered for up to @ref RELAY_BUFFER_SIZE records while the uplink is
+ *          down and sent in order once it is up. Events of the uplink itself are not relayed.
+ *
+ * @param[in] type         Record type.
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] arg0         Type specific argument.
+ */
+void relay_uplink_record(event_export_type_t type, uint16_t conn_handle, uint8_t arg0);
+
+
+/**@brief Function for handing the uplink the client of the discovered station.
+ *
+ * @param[in] p_ars_c  Assistance Request client of the link, with the Relay characteristic assigned.
+ */
+void relay_uplink_ready(ble_ars_c_t* p_ars_c);
+
+
+/**@brief Function for handling the station's confirmation of a relay record.
+ *
+ * @param[in] gatt_status  GATT status of the record write.
+ */
+void relay_uplink_confirmed(uint16_t gatt_status);
+
+
+/**@brief Function for handling a relay record write that the GATT queue failed to send.
+ *
+ * @details The record stays at the head of the buffer and is sent again with the next record
+ *          or after reconnecting.
+ *
+ * @param[in] nrf_error  Error of the GATT queue.
+ */
+void relay_uplink_failed(uint32_t nrf_error);
+
+
+/**@brief Function for getting the uplink statistics.
+ *
+ * @param[out] p_stats  Uplink statistics.
+ */
+void relay_uplink_stats_get(relay_uplink_stats_t* p_stats);
+
+
+/**@brief Function for handling a relay record written by an edge server.
+ *
+ * @details Exports the record as @ref EVENT_EXPORT_TYPE_RELAY. Used as the station's
+ *          @ref ble_ars_relay_write_handler_t.
+ *
+ * @param[in] conn_handle  Connection handle of the edge server.
+ * @param[in] p_data       Relay record.
+ * @param[in] length       Record length.
+ */
+void relay_station_on_write(uint16_t conn_handle, const uint8_t* p_data, uint16_t length);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,187 @@
+#include "ack_latency.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "time_service/wall_clock.h"
+#include "ble.h"
+
+
+/**@brief Acknowledgement waiting for confirmation.
+ *
+ * @details Keyed by the handle of the acknowledged request, which is a link or, for the load
+ *          generator, a virtual wearable. Each request acknowledged holds a slot until it is
+ *          confirmed, so there are never more than REQUEST_QUEUE_CAPACITY.
+ */
+typedef struct {
+    uint16_t conn_handle;   /**< Handle of the acknowledged request, BLE_CONN_HANDLE_INVALID if the slot is free */
+    uint64_t start_ticks;   /**< Tick count at which the button was pressed, see @ref wall_clock_ticks_get */
+} pending_ack_t;
+
+
+static pending_ack_t       m_pending[REQUEST_QUEUE_CAPACITY];
+static uint32_t            m_histogram[ACK_LATENCY_BUCKET_COUNT];   /**< Bucket i counts latencies below 2^i ms */
+static uint64_t            m_total_ms;
+static ack_latency_stats_t m_stats;
+
+
+static pending_ack_t* pending_find(uint16_t conn_handle)
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_pending); i++)
+    {
+        if (m_pending[i].conn_handle == conn_handle)
+        {
+            return &m_pending[i];
+        }
+    }
+    return NULL;
+}
+
+
+/**@brief Function for getting the histogram bucket of a latency.
+ */
+static uint32_t bucket_index(uint32_t latency_ms)
+{
+    uint32_t idx = 0;
+
+    while (idx < ACK_LATENCY_BUCKET_COUNT - 1 && latency_ms >= (1UL << idx))
+    {
+        idx++;
+    }
+    return idx;
+}
+
+
+/**@brief Function for getting the upper bound of the bucket holding a given percentile.
+ */
+static uint32_t percentile_ms(uint32_t percent)
+{
+    uint32_t target = (m_stats.count * percent + 99) / 100;
+    uint32_t seen   = 0;
+
+    for (uint32_t i = 0; i < ACK_LATENCY_BUCKET_COUNT; i++)
+    {
+        seen += m_histogram[i];
+        if (seen >= target && seen > 0)
+        {
+            return MIN(1UL << i, m_stats.max_ms);
+        }
+    }
+    return m_stats.max_ms;
+}
+
+
+void ack_latency_init(void)
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_pending); i++)
+    {
+        m_pending[i].conn_handle = BLE_CONN_HANDLE_INVALID;
+    }
+
+    ack_latency_reset();
+}
+
+
+void ack_latency_reset(void)
+{
+    memset(m_histogram, 0, sizeof(m_histogram));
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_total_ms     = 0;
+    m_stats.min_ms = UINT32_MAX;
+}
+
+
+void ack_latency_start(uint16_t conn_handle)
+{
+    pending_ack_t* p_pending;
+
+    if (conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return;
+    }
+
+    p_pending = pending_find(conn_handle);
+    if (p_pending != NULL)
+    {
+        m_stats.lost++;
+    }
+    else
+    {
+        p_pending = pending_find(BLE_CONN_HANDLE_INVALID);
+    }
+
+    if (p_pending == NULL)
+    {
+        // All slots in use, the acknowledgement cannot be measured
+        m_stats.lost++;
+        return;
+    }
+
+    p_pending->conn_handle = conn_handle;
+    p_pending->start_ticks = wall_clock_ticks_get();
+}
+
+
+uint32_t ack_latency_stop(uint16_t conn_handle)
+{
+    pending_ack_t* p_pending = pending_find(conn_handle);
+
+    if (p_pending == NULL || conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return UINT32_MAX;
+    }
+
+    // 64-bit ticks, so that acknowledgements confirmed after an app_timer counter wrap are measured correctly
+    uint64_t ticks      = wall_clock_ticks_get() - p_pending->start_ticks;
+    uint32_t latency_ms = (uint32_t)MIN(wall_clock_ticks_to_ms(ticks), UINT32_MAX - 1);
+
+    p_pending->conn_handle = BLE_CONN_HANDLE_INVALID;
+
+    m_histogram[bucket_index(latency_ms)]++;
+    m_total_ms += latency_ms;
+
+    m_stats.count++;
+    m_stats.last_ms = latency_ms;
+    m_stats.min_ms  = MIN(m_stats.min_ms, latency_ms);
+    m_stats.max_ms  = MAX(m_stats.max_ms, latency_ms);
+
+    return latency_ms;
+}
+
+
+void ack_latency_cancel(uint16_t conn_handle)
+{
+    pending_ack_t* p_pending = pending_find(conn_handle);
+
+    if (p_pending != NULL && conn_handle != BLE_CONN_HANDLE_INVALID)
+    {
+        p_pending->conn_handle = BLE_CONN_HANDLE_INVALID;
+        m_stats.lost++;
+    }
+}
+
+
+bool ack_latency_pending(uint16_t conn_handle)
+{
+    return (conn_handle != BLE_CONN_HANDLE_INVALID) && (pending_find(conn_handle) != NULL);
+}
+
+
+void ack_latency_stats_get(ack_latency_stats_t* p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return;
+    }
+
+    *p_stats = m_stats;
+    if (m_stats.count == 0)
+    {
+        p_stats->min_ms = 0;
+        return;
+    }
+
+    p_stats->mean_ms = (uint32_t)(m_total_ms / m_stats.count);
+    p_stats->p50_ms  = percentile_ms(50);
+    p_stats->p90_ms  = percentile_ms(90);
+    p_stats->p99_ms  = percentile_ms(99);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define ACK_LATENCY_BUCKET_COUNT    16      /**< Number of histogram buckets. Bucket i counts latencies below 2^i ms. */
+
+
+/**@brief Acknowledgement latency statistics, in milliseconds */
+typedef struct {
+    uint32_t count;     /**< Number of recorded acknowledgements */
+    uint32_t last_ms;   /**< Latency of the most recent acknowledgement */
+    uint32_t min_ms;    /**< Lowest recorded latency */
+    uint32_t max_ms;    /**< Highest recorded latency */
+    uint32_t mean_ms;   /**< Mean recorded latency */
+    uint32_t p50_ms;    /**< Median latency, rounded up to a histogram bucket boundary */
+    uint32_t p90_ms;    /**< 90th percentile latency, rounded up to a histogram bucket boundary */
+    uint32_t p99_ms;    /**< 99th percentile latency, rounded up to a histogram bucket boundary */
+    uint32_t lost;      /**< Acknowledgements that were never confirmed by the wearable, or not measured because all slots were in use */
+} ack_latency_stats_t;
+
+
+
+/**@brief Function for initializing the acknowledgement latency recorder. */
+void ack_latency_init(void);
+
+
+/**@brief Function for clearing the recorded latencies.
+ *
+ * @details Acknowledgements waiting for confirmation are kept and recorded once confirmed.
+ */
+void ack_latency_reset(void);
+
+
+/**@brief Function for timestamping the acknowledgement of a wearable's request.
+ *
+ * @details Call this when the acknowledgement button is pressed. Up to REQUEST_QUEUE_CAPACITY
+ *          acknowledgements are measured at once, one per request. A previous unconfirmed
+ *          acknowledgement of the same wearable is counted as lost.
+ *
+ * @param[in] conn_handle  Handle of the acknowledged request, the link or virtual wearable.
+ */
+void ack_latency_start(uint16_t conn_handle);
+
+
+/**@brief Function for recording the latency of an acknowledgement confirmed by the wearable.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable that confirmed the acknowledgement.
+ *
+ * @return Latency in milliseconds, or UINT32_MAX if no acknowledgement was pending for the wearable.
+ */
+uint32_t ack_latency_stop(uint16_t conn_handle);
+
+
+/**@brief Function for dropping a pending acknowledgement that will not be confirmed.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ */
+void ack_latency_cancel(uint16_t conn_handle);
+
+
+/**@brief Function for checking whether an acknowledgement of a wearable waits for confirmation.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ */
+bool ack_latency_pending(uint16_t conn_handle);
+
+
+/**@brief Function for getting the acknowledgement latency statistics.
+ *
+ * @param[out] p_stats  Latency statistics.
+ */
+void ack_latency_stats_get(ack_latency_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
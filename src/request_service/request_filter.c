@@ -0,0 +1,207 @@
+#include "request_filter.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "ble.h"
+#include "nrf_sdh_ble.h"
+#include "system_service/timer_wheel.h"
+#include "time_service/wall_clock.h"
+
+
+/**@brief Filter state of a wearable */
+typedef struct {
+    timer_wheel_entry_t window;         /**< Hold window, running while changes are collapsed */
+    uint64_t            input_ticks;    /**< Tick count of the latest raw state, see @ref wall_clock_ticks_get */
+    uint16_t            conn_handle;    /**< Connection handle of the wearable, BLE_CONN_HANDLE_INVALID if the slot is free */
+    uint8_t             state;          /**< State last passed on */
+    uint8_t             pending;        /**< Latest raw state within the window */
+    bool                known;          /**< True once a state was passed on */
+    bool                has_pending;    /**< True if pending holds a state that was not passed on yet */
+    bool                debounced;      /**< True if the window was already extended for the debounce */
+} link_filter_t;
+
+
+// Only touched from the main loop
+static link_filter_t            m_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static request_filter_handler_t m_handler;
+static request_filter_stats_t   m_stats;
+
+
+static link_filter_t* link_find(uint16_t conn_handle)
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_links); i++)
+    {
+        if (m_links[i].conn_handle == conn_handle)
+        {
+            return &m_links[i];
+        }
+    }
+    return NULL;
+}
+
+
+static void window_timeout_handler(timer_wheel_entry_t* p_entry);
+
+
+/**@brief Function for passing on a logical transition and opening the hold window.
+ */
+static void transition(link_filter_t* p_link, uint8_t req_state)
+{
+    ret_code_t err_code;
+
+    p_link->state       = req_state;
+    p_link->known       = true;
+    p_link->has_pending = false;
+    p_link->debounced   = false;
+    m_stats.transitions++;
+
+    err_code = timer_wheel_start(&p_link->window, REQUEST_FILTER_HOLD_MS, window_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+
+    m_handler(p_link->conn_handle, req_state);
+}
+
+
+/**@brief Function for settling the state collapsed within a window.
+ */
+static void pending_settle(link_filter_t* p_link)
+{
+    if (p_link->pending != p_link->state)
+    {
+        transition(p_link, p_link->pending);
+        return;
+    }
+
+    // Flapped back to the state passed on last
+    m_stats.absorbed++;
+    p_link->has_pending = false;
+    p_link->debounced   = false;
+}
+
+
+/**@brief Function for closing the window of a wearable.
+ *
+ * @details A state that changed within the last REQUEST_FILTER_DEBOUNCE_MS gets one extension of
+ *          the window to settle, which bounds the delay of a wearable that keeps flapping.
+ */
+static void window_timeout_handler(timer_wheel_entry_t* p_entry)
+{
+    ret_code_t     err_code;
+    link_filter_t* p_link = CONTAINER_OF(p_entry, link_filter_t, window);
+    uint32_t       quiet_ms;
+
+    if (!p_link->has_pending)
+    {
+        return;
+    }
+
+    quiet_ms = (uint32_t)MIN(wall_clock_ticks_to_ms(wall_clock_ticks_get() - p_link->input_ticks), UINT32_MAX);
+    if (!p_link->debounced && quiet_ms < REQUEST_FILTER_DEBOUNCE_MS)
+    {
+        p_link->debounced = true;
+        err_code = timer_wheel_start(&p_link->window, REQUEST_FILTER_DEBOUNCE_MS - quiet_ms, window_timeout_handler);
+        APP_ERROR_CHECK(err_code);
+        return;
+    }
+
+    pending_settle(p_link);
+}
+
+
+ret_code_t request_filter_init(request_filter_handler_t handler)
+{
+    VERIFY_PARAM_NOT_NULL(handler);
+
+    memset(m_links, 0, sizeof(m_links));
+    memset(&m_stats, 0, sizeof(m_stats));
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_links); i++)
+    {
+        m_links[i].conn_handle = BLE_CONN_HANDLE_INVALID;
+    }
+    m_handler = handler;
+
+    return NRF_SUCCESS;
+}
+
+
+void request_filter_input(uint16_t conn_handle, uint8_t req_state)
+{
+    link_filter_t* p_link = link_find(conn_handle);
+
+    m_stats.inputs++;
+
+    if (p_link == NULL)
+    {
+        p_link = link_find(BLE_CONN_HANDLE_INVALID);
+        if (p_link == NULL)
+        {
+            // More wearables than links, pass the state on unfiltered
+            m_stats.transitions++;
+            m_handler(conn_handle, req_state);
+            return;
+        }
+        p_link->conn_handle = conn_handle;
+    }
+
+    if (timer_wheel_is_running(&p_link->window))
+    {
+        if (p_link->has_pending)
+        {
+            m_stats.absorbed++;
+        }
+        p_link->pending     = req_state;
+        p_link->has_pending = true;
+        p_link->input_ticks = wall_clock_ticks_get();
+        return;
+    }
+
+    if (p_link->known && p_link->state == req_state)
+    {
+        m_stats.absorbed++;
+        return;
+    }
+
+    transition(p_link, req_state);
+}
+
+
+void request_filter_flush(uint16_t conn_handle)
+{
+    link_filter_t* p_link = link_find(conn_handle);
+
+    if (p_link == NULL || !p_link->has_pending)
+    {
+        return;
+    }
+
+    timer_wheel_stop(&p_link->window);
+    pending_settle(p_link);
+}
+
+
+void request_filter_reset(uint16_t conn_handle)
+{
+    link_filter_t* p_link = link_find(conn_handle);
+
+    if (p_link == NULL)
+    {
+        return;
+    }
+
+    timer_wheel_stop(&p_link->window);
+    if (p_link->has_pending)
+    {
+        m_stats.absorbed++;
+    }
+
+    p_link->conn_handle = BLE_CONN_HANDLE_INVALID;
+    p_link->known       = false;
+    p_link->has_pending = false;
+    p_link->debounced   = false;
+}
+
+
+void request_filter_stats_get(request_filter_stats_t* p_stats)
+{
+    *p_stats = m_stats;
+}
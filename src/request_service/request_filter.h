@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Request state handler type.
+ *
+ * @details Called from the main loop with each logical transition of a wearable's request state.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] req_state    New request state.
+ */
+typedef void (*request_filter_handler_t)(uint16_t conn_handle, uint8_t req_state);
+
+
+/**@brief Request filter statistics */
+typedef struct {
+    uint32_t inputs;        /**< Raw request states seen */
+    uint32_t transitions;   /**< Logical transitions passed on */
+    uint32_t absorbed;      /**< Raw states that were repeats, or were superseded within a window */
+} request_filter_stats_t;
+
+
+
+/**@brief Function for initializing the request state filter.
+ *
+ * @details Must be called after @ref timer_wheel_init.
+ *
+ * @param[in] handler  Handler of the logical transitions.
+ *
+ * @retval NRF_SUCCESS     If the filter was initialized.
+ * @retval NRF_ERROR_NULL  If handler is NULL.
+ */
+ret_code_t request_filter_init(request_filter_handler_t handler);
+
+
+/**@brief Function for filtering a raw request state read or notified by a wearable.
+ *
+ * @details A change after a quiet period is passed on at once and opens a hold window of
+ *          REQUEST_FILTER_HOLD_MS. Repeats of the current state are absorbed. Changes within the
+ *          window are collapsed into the latest one, which is passed on when the window closes
+ *          once it has been stable for REQUEST_FILTER_DEBOUNCE_MS. A state that flaps back to the
+ *          current one within the window is absorbed. The last state a wearable reports is always
+ *          passed on, at most REQUEST_FILTER_HOLD_MS + REQUEST_FILTER_DEBOUNCE_MS late.
+ *          Must be called from the main loop.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ * @param[in] req_state    Raw request state.
+ */
+void request_filter_input(uint16_t conn_handle, uint8_t req_state);
+
+
+/**@brief Function for passing on the collapsed state of a wearable without waiting for its window.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ */
+void request_filter_flush(uint16_t conn_handle);
+
+
+/**@brief Function for dropping the filter state of a wearable whose link is down.
+ *
+ * @param[in] conn_handle  Connection handle of the wearable.
+ */
+void request_filter_reset(uint16_t conn_handle);
+
+
+/**@brief Function for getting the request filter statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void request_filter_stats_get(request_filter_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
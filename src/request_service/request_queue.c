@@ -0,0 +1,392 @@
+#include "request_queue.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "ble_conn_state.h"
+#include "nrf_balloc.h"
+#include "nrf_sdh_ble.h"
+#include "system_service/timer_wheel.h"
+#include "time_service/wall_clock.h"
+
+
+#define INDEX_SIZE      (NRF_SDH_BLE_TOTAL_LINK_COUNT + REQUEST_QUEUE_CAPACITY)  // One slot per link, then one per detached handle
+
+
+/**@brief Request record */
+typedef struct {
+    request_queue_item_t item;
+    uint32_t             heap_idx;      /**< Position of the record in the heap */
+    timer_wheel_entry_t  escalation;    /**< Escalation timeout */
+} request_record_t;
+
+
+NRF_BALLOC_DEF(m_record_pool, sizeof(request_record_t), REQUEST_QUEUE_CAPACITY);
+
+// Heap of request records. m_heap[0] is the next request to acknowledge.
+// The queue is only touched from the main loop, the event handlers post work items for it, so no
+// locking is needed.
+static request_record_t*     m_heap[REQUEST_QUEUE_CAPACITY];
+static request_record_t*     m_index[INDEX_SIZE];
+static uint32_t              m_count;
+static uint32_t              m_next_seq;
+static request_queue_stats_t m_stats;
+
+static request_queue_escalation_handler_t m_escalation_handler;
+static uint32_t                           m_escalation_timeout_ms;
+
+
+/**@brief Function for getting the index slot of a connection handle.
+ *
+ * @return Slot, or NULL if the handle belongs to no link and is no valid detached handle.
+ */
+static request_record_t** index_slot(uint16_t conn_handle)
+{
+    uint16_t idx;
+
+    if (conn_handle & REQUEST_QUEUE_DETACHED_HANDLE(0))
+    {
+        idx = conn_handle & ~REQUEST_QUEUE_DETACHED_HANDLE(0);
+        return (idx < REQUEST_QUEUE_CAPACITY) ? &m_index[NRF_SDH_BLE_TOTAL_LINK_COUNT + idx] : NULL;
+    }
+
+    idx = ble_conn_state_conn_idx(conn_handle);
+    return (idx < NRF_SDH_BLE_TOTAL_LINK_COUNT) ? &m_index[idx] : NULL;
+}
+
+
+/**@brief Function for checking whether request a must be served before request b.
+ */
+static bool item_precedes(const request_queue_item_t* p_a, const request_queue_item_t* p_b)
+{
+    if (p_a->priority != p_b->priority)
+    {
+        return p_a->priority > p_b->priority;
+    }
+
+    // Sequence numbers are compared as a signed difference so that wrap-around keeps the order.
+    return (int32_t)(p_a->seq - p_b->seq) < 0;
+}
+
+
+static void item_swap(uint32_t a, uint32_t b)
+{
+    request_record_t* p_tmp = m_heap[a];
+
+    m_heap[a]           = m_heap[b];
+    m_heap[b]           = p_tmp;
+    m_heap[a]->heap_idx = a;
+    m_heap[b]->heap_idx = b;
+}
+
+
+/**@brief Function for moving an item towards the root until the heap order holds.
+ */
+static void sift_up(uint32_t idx)
+{
+    while (idx > 0)
+    {
+        uint32_t parent = (idx - 1) / 2;
+        if (!item_precedes(&m_heap[idx]->item, &m_heap[parent]->item))
+        {
+            break;
+        }
+        item_swap(idx, parent);
+        idx = parent;
+    }
+}
+
+
+/**@brief Function for moving an item towards the leaves until the heap order holds.
+ */
+static void sift_down(uint32_t idx)
+{
+    for (;;)
+    {
+        uint32_t left  = 2 * idx + 1;
+        uint32_t right = left + 1;
+        uint32_t first = idx;
+
+        if (left < m_count && item_precedes(&m_heap[left]->item, &m_heap[first]->item))
+        {
+            first = left;
+        }
+        if (right < m_count && item_precedes(&m_heap[right]->item, &m_heap[first]->item))
+        {
+            first = right;
+        }
+        if (first == idx)
+        {
+            break;
+        }
+        item_swap(idx, first);
+        idx = first;
+    }
+}
+
+
+static void escalation_timeout_handler(timer_wheel_entry_t* p_entry)
+{
+    request_record_t* p_record = CONTAINER_OF(p_entry, request_record_t, escalation);
+
+    p_record->item.escalated = true;
+    m_escalation_handler(&p_record->item);
+}
+
+
+/**@brief Function for removing a record from the heap and the index, and freeing it.
+ *
+ * @param[in]  p_record  Record.
+ * @param[out] p_item    Removed request. May be NULL.
+ */
+static void record_remove(request_record_t* p_record, request_queue_item_t* p_item)
+{
+    uint32_t idx = p_record->heap_idx;
+
+    if (p_item != NULL)
+    {
+        *p_item = p_record->item;
+    }
+
+    timer_wheel_stop(&p_record->escalation);
+    *index_slot(p_record->item.conn_handle) = NULL;
+    nrf_balloc_free(&m_record_pool, p_record);
+
+    m_count--;
+    if (idx == m_count)
+    {
+        return;
+    }
+
+    m_heap[idx]           = m_heap[m_count];
+    m_heap[idx]->heap_idx = idx;
+    sift_down(idx);
+    sift_up(idx);
+}
+
+
+/**@brief Function for adding a request to the heap and the index.
+ *
+ * @param[in] p_item      Request.
+ * @param[in] pending_ms  Time the request has already been pending.
+ */
+static ret_code_t record_add(const request_queue_item_t* p_item, uint32_t pending_ms)
+{
+    ret_code_t err_code;
+    request_record_t** pp_slot = index_slot(p_item->conn_handle);
+    request_record_t*  p_record;
+
+    if (pp_slot == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (*pp_slot != NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    p_record = nrf_balloc_alloc(&m_record_pool);
+    if (p_record == NULL)
+    {
+        m_stats.exhausted++;
+        return NRF_ERROR_NO_MEM;
+    }
+
+    memset(&p_record->escalation, 0, sizeof(p_record->escalation));
+    if (m_escalation_handler != NULL && !p_item->escalated)
+    {
+        err_code = timer_wheel_start(&p_record->escalation,
+                                     (pending_ms < m_escalation_timeout_ms) ? m_escalation_timeout_ms - pending_ms : 0,
+                                     escalation_timeout_handler);
+        if (err_code != NRF_SUCCESS)
+        {
+            nrf_balloc_free(&m_record_pool, p_record);
+            return err_code;
+        }
+    }
+
+    p_record->item     = *p_item;
+    p_record->heap_idx = m_count;
+    m_heap[m_count]    = p_record;
+    *pp_slot           = p_record;
+
+    sift_up(m_count++);
+    m_stats.count_max = MAX(m_stats.count_max, m_count);
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_init(void)
+{
+    m_count    = 0;
+    m_next_seq = 0;
+    memset(m_index, 0, sizeof(m_index));
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    return nrf_balloc_init(&m_record_pool);
+}
+
+
+void request_queue_escalation_set(uint32_t timeout_ms, request_queue_escalation_handler_t handler)
+{
+    m_escalation_timeout_ms = timeout_ms;
+    m_escalation_handler    = handler;
+}
+
+
+ret_code_t request_queue_push(uint16_t conn_handle, uint8_t priority)
+{
+    request_queue_item_t item;
+    ret_code_t           err_code;
+
+    item.conn_handle = conn_handle;
+    item.priority    = priority;
+    item.seq         = m_next_seq;
+    item.time_ms     = wall_clock_time_ms_get();
+    item.escalated   = false;
+
+    err_code = record_add(&item, 0);
+    VERIFY_SUCCESS(err_code);
+
+    m_next_seq++;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_pop(request_queue_item_t* p_item)
+{
+    if (m_count == 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    record_remove(m_heap[0], p_item);
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_peek(request_queue_item_t* p_item)
+{
+    VERIFY_PARAM_NOT_NULL(p_item);
+
+    if (m_count == 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_item = m_heap[0]->item;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_remove(uint16_t conn_handle, request_queue_item_t* p_item)
+{
+    request_record_t** pp_slot = index_slot(conn_handle);
+
+    if (pp_slot == NULL || *pp_slot == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    record_remove(*pp_slot, p_item);
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_find(uint16_t conn_handle, request_queue_item_t* p_item)
+{
+    request_record_t** pp_slot = index_slot(conn_handle);
+
+    if (pp_slot == NULL || *pp_slot == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    if (p_item != NULL)
+    {
+        *p_item = (*pp_slot)->item;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_handle_update(uint16_t conn_handle, uint16_t new_conn_handle)
+{
+    request_record_t** pp_slot     = index_slot(conn_handle);
+    request_record_t** pp_new_slot = index_slot(new_conn_handle);
+
+    if (pp_slot == NULL || *pp_slot == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (pp_new_slot == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (pp_new_slot == pp_slot)
+    {
+        return NRF_SUCCESS;
+    }
+    if (*pp_new_slot != NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    *pp_new_slot                     = *pp_slot;
+    *pp_slot                         = NULL;
+    (*pp_new_slot)->item.conn_handle = new_conn_handle;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_restore(const request_queue_item_t* p_item)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_item);
+
+    // The clock may have restarted behind the arrival time, or only one of the two times may be
+    // synced. Then the request starts over
+    err_code = record_add(p_item, wall_clock_elapsed_ms(p_item->time_ms));
+    VERIFY_SUCCESS(err_code);
+
+    if ((int32_t)(p_item->seq - m_next_seq) >= 0)
+    {
+        m_next_seq = p_item->seq + 1;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t request_queue_item_get(uint32_t idx, request_queue_item_t* p_item)
+{
+    VERIFY_PARAM_NOT_NULL(p_item);
+
+    if (idx >= m_count)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_item = m_heap[idx]->item;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t request_queue_count(void)
+{
+    return m_count;
+}
+
+
+void request_queue_stats_get(request_queue_stats_t* p_stats)
+{
+    *p_stats = m_stats;
+}
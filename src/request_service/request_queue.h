@@ -0,0 +1,183 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define REQUEST_QUEUE_DETACHED_HANDLE(_idx)     (0x8000 | (_idx))   /**< Connection handle of a request whose wearable is not connected. _idx is below @ref REQUEST_QUEUE_CAPACITY */
+
+
+/**@brief Pending assistance request */
+typedef struct {
+    uint16_t conn_handle;   /**< Connection handle of the requesting wearable */
+    uint8_t  priority;      /**< Request priority. Higher values are served first */
+    uint32_t seq;           /**< Arrival sequence number. Lower values are older */
+    uint64_t time_ms;       /**< Time at which the request arrived, see @ref wall_clock_time_ms_get */
+    bool     escalated;     /**< True once the request went unacknowledged for the escalation timeout */
+} request_queue_item_t;
+
+/**@brief Escalation handler type.
+ *
+ * @details Called from the main loop when a request went unacknowledged for the escalation timeout.
+ *
+ * @param[in] p_item  Escalated request.
+ */
+typedef void (*request_queue_escalation_handler_t)(const request_queue_item_t* p_item);
+
+/**@brief Request store statistics */
+typedef struct {
+    uint32_t count_max;     /**< Highest number of requests pending at once */
+    uint32_t exhausted;     /**< Number of requests rejected because all records were in use */
+} request_queue_stats_t;
+
+
+
+/**@brief Function for initializing the pending request queue.
+ *
+ * @details Request records come from a block pool of @ref REQUEST_QUEUE_CAPACITY records, which
+ *          are allocated and freed in O(1). The queue is a binary heap of record pointers ordered
+ *          by priority, then by age. Records are indexed by connection handle, one per link and
+ *          one per detached handle.
+ *
+ * @retval NRF_SUCCESS  If the queue was initialized.
+ * @retval err_code     Otherwise, the error returned by the block allocator.
+ */
+ret_code_t request_queue_init(void);
+
+
+/**@brief Function for enabling the escalation of unacknowledged requests.
+ *
+ * @details Each request gets an entry in the timer wheel, started when the request is queued and
+ *          stopped when it is removed. Restored requests escalate relative to their arrival time.
+ *          Must be called before the first request is queued.
+ *
+ * @param[in] timeout_ms  Time a request may go unacknowledged.
+ * @param[in] handler     Escalation handler.
+ */
+void request_queue_escalation_set(uint32_t timeout_ms, request_queue_escalation_handler_t handler);
+
+
+/**@brief Function for adding a request to the queue in O(log n).
+ *
+ * @param[in] conn_handle  Connection handle of the requesting wearable, or a detached handle.
+ * @param[in] priority     Request priority.
+ *
+ * @retval NRF_SUCCESS               If the request was queued.
+ * @retval NRF_ERROR_NO_MEM          If all request records are in use.
+ * @retval NRF_ERROR_INVALID_PARAM   If the connection handle belongs to no link slot.
+ * @retval NRF_ERROR_INVALID_STATE   If the wearable already has a pending request.
+ */
+ret_code_t request_queue_push(uint16_t conn_handle, uint8_t priority);
+
+
+/**@brief Function for removing the head of the queue in O(log n).
+ *
+ * @param[out] p_item  Removed request. May be NULL.
+ *
+ * @retval NRF_SUCCESS          If a request was removed.
+ * @retval NRF_ERROR_NOT_FOUND  If the queue is empty.
+ */
+ret_code_t request_queue_pop(request_queue_item_t* p_item);
+
+
+/**@brief Function for reading the head of the queue without removing it.
+ *
+ * @param[out] p_item  Head of the queue.
+ *
+ * @retval NRF_SUCCESS          If the queue is not empty.
+ * @retval NRF_ERROR_NOT_FOUND  If the queue is empty.
+ * @retval NRF_ERROR_NULL       If p_item is NULL.
+ */
+ret_code_t request_queue_peek(request_queue_item_t* p_item);
+
+
+/**@brief Function for removing the request of a given wearable.
+ *
+ * @details The request is found through the index in O(1); restoring the heap is O(log n).
+ *
+ * @param[in]  conn_handle  Connection handle of the wearable.
+ * @param[out] p_item       Removed request. May be NULL.
+ *
+ * @retval NRF_SUCCESS          If the request was removed.
+ * @retval NRF_ERROR_NOT_FOUND  If the wearable has no pending request.
+ */
+ret_code_t request_queue_remove(uint16_t conn_handle, request_queue_item_t* p_item);
+
+
+/**@brief Function for finding the pending request of a given wearable in O(1).
+ *
+ * @param[in]  conn_handle  Connection handle of the wearable.
+ * @param[out] p_item       Pending request. May be NULL.
+ *
+ * @retval NRF_SUCCESS          If the wearable has a pending request.
+ * @retval NRF_ERROR_NOT_FOUND  If the wearable has no pending request.
+ */
+ret_code_t request_queue_find(uint16_t conn_handle, request_queue_item_t* p_item);
+
+
+/**@brief Function for changing the connection handle of a pending request.
+ *
+ * @details The request keeps its place in the queue.
+ *
+ * @param[in] conn_handle      Current connection handle of the request.
+ * @param[in] new_conn_handle  New connection handle.
+ *
+ * @retval NRF_SUCCESS               If the request was updated.
+ * @retval NRF_ERROR_NOT_FOUND       If no request has the given connection handle.
+ * @retval NRF_ERROR_INVALID_PARAM   If the new connection handle belongs to no link slot.
+ * @retval NRF_ERROR_INVALID_STATE   If the new connection handle already has a pending request.
+ */
+ret_code_t request_queue_handle_update(uint16_t conn_handle, uint16_t new_conn_handle);
+
+
+/**@brief Function for adding a request that keeps its sequence number and arrival time.
+ *
+ * @details Used to restore requests saved before a reset. Requests pushed afterwards are ordered
+ *          after the restored ones of the same priority.
+ *
+ * @param[in] p_item  Request to add.
+ *
+ * @retval NRF_SUCCESS               If the request was queued.
+ * @retval NRF_ERROR_NO_MEM          If all request records are in use.
+ * @retval NRF_ERROR_INVALID_PARAM   If the connection handle belongs to no link slot.
+ * @retval NRF_ERROR_INVALID_STATE   If the connection handle already has a pending request.
+ * @retval NRF_ERROR_NULL            If p_item is NULL.
+ */
+ret_code_t request_queue_restore(const request_queue_item_t* p_item);
+
+
+/**@brief Function for reading a pending request by its position in the queue storage.
+ *
+ * @details Positions are in heap order, not in the order the requests are served.
+ *
+ * @param[in]  idx     Position, below @ref request_queue_count.
+ * @param[out] p_item  Request at the position.
+ *
+ * @retval NRF_SUCCESS          If the request was read.
+ * @retval NRF_ERROR_NOT_FOUND  If the position holds no request.
+ * @retval NRF_ERROR_NULL       If p_item is NULL.
+ */
+ret_code_t request_queue_item_get(uint32_t idx, request_queue_item_t* p_item);
+
+
+/**@brief Function for getting the number of pending requests. */
+uint32_t request_queue_count(void);
+
+
+/**@brief Function for getting the request store statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void request_queue_stats_get(request_queue_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,124 @@
+#include "boot_profile.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "nrf_timer.h"
+
+#include "nrf_log.h"
+
+
+static const char* const m_stage_names[BOOT_STAGE_COUNT] =
+{
+    [BOOT_STAGE_RETAINED_STATE]      = "retained state",
+    [BOOT_STAGE_LOG]                 = "log",
+    [BOOT_STAGE_TIMERS]              = "timers",
+    [BOOT_STAGE_BUTTONS_LEDS]        = "buttons and LEDs",
+    [BOOT_STAGE_POWER_MANAGEMENT]    = "power management",
+    [BOOT_STAGE_WALL_CLOCK]          = "wall clock",
+    [BOOT_STAGE_ANNUNCIATOR]         = "annunciator",
+    [BOOT_STAGE_EVENT_EXPORT]        = "event export",
+    [BOOT_STAGE_REQUESTS_RESTORED]   = "requests restored",
+    [BOOT_STAGE_BLE_STACK]           = "BLE stack",
+    [BOOT_STAGE_GAP]                 = "GAP",
+    [BOOT_STAGE_GATT]                = "GATT",
+    [BOOT_STAGE_DB_DISCOVERY]        = "DB discovery",
+    [BOOT_STAGE_SERVICES]            = "services",
+    [BOOT_STAGE_ADVERTISING_INIT]    = "advertising init",
+    [BOOT_STAGE_ROAMING]             = "roaming",
+    [BOOT_STAGE_FIRST_ADVERTISEMENT] = "first advertisement",
+    [BOOT_STAGE_CONN_PARAMS]         = "conn params",
+    [BOOT_STAGE_PEER_MANAGER]        = "peer manager",
+    [BOOT_STAGE_RELAY]               = "relay",
+    [BOOT_STAGE_USBD]                = "USB export",
+    [BOOT_STAGE_COMPLETE]            = "complete",
+};
+
+static uint32_t m_stage_us[BOOT_STAGE_COUNT];   // End time of each stage, UINT32_MAX if not marked
+static bool     m_running;
+
+
+void boot_profile_init(void)
+{
+    for (uint32_t i = 0; i < BOOT_STAGE_COUNT; i++)
+    {
+        m_stage_us[i] = UINT32_MAX;
+    }
+
+    nrf_timer_task_trigger(BOOT_PROFILE_TIMER, NRF_TIMER_TASK_STOP);
+    nrf_timer_mode_set(BOOT_PROFILE_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(BOOT_PROFILE_TIMER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_frequency_set(BOOT_PROFILE_TIMER, NRF_TIMER_FREQ_1MHz);
+    nrf_timer_task_trigger(BOOT_PROFILE_TIMER, NRF_TIMER_TASK_CLEAR);
+    nrf_timer_task_trigger(BOOT_PROFILE_TIMER, NRF_TIMER_TASK_START);
+
+    m_running = true;
+}
+
+
+uint32_t boot_profile_elapsed_us(void)
+{
+    if (!m_running)
+    {
+        return m_stage_us[BOOT_STAGE_COMPLETE];
+    }
+
+    nrf_timer_task_trigger(BOOT_PROFILE_TIMER, nrf_timer_capture_task_get(NRF_TIMER_CC_CHANNEL0));
+    return nrf_timer_cc_read(BOOT_PROFILE_TIMER, NRF_TIMER_CC_CHANNEL0);
+}
+
+
+void boot_profile_mark(boot_stage_t stage)
+{
+    if (!m_running || stage >= BOOT_STAGE_COUNT || m_stage_us[stage] != UINT32_MAX)
+    {
+        return;
+    }
+
+    m_stage_us[stage] = boot_profile_elapsed_us();
+}
+
+
+uint32_t boot_profile_stage_us(boot_stage_t stage)
+{
+    return (stage < BOOT_STAGE_COUNT) ? m_stage_us[stage] : UINT32_MAX;
+}
+
+
+void boot_profile_report(void)
+{
+    uint8_t  order[BOOT_STAGE_COUNT];
+    uint32_t count   = 0;
+    uint32_t prev_us = 0;
+
+    boot_profile_mark(BOOT_STAGE_COMPLETE);
+
+    // The timer keeps the high frequency clock running, so it only runs during boot
+    nrf_timer_task_trigger(BOOT_PROFILE_TIMER, NRF_TIMER_TASK_SHUTDOWN);
+    m_running = false;
+
+    // Sort the marked stages by end time. Insertion sort, there are only a few
+    for (uint32_t stage = 0; stage < BOOT_STAGE_COUNT; stage++)
+    {
+        uint32_t pos = count;
+
+        if (m_stage_us[stage] == UINT32_MAX)
+        {
+            continue;
+        }
+        while (pos > 0 && m_stage_us[order[pos - 1]] > m_stage_us[stage])
+        {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = (uint8_t)stage;
+        count++;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t end_us = m_stage_us[order[i]];
+
+        NRF_LOG_INFO("Boot: %s at %d us (+%d us)", m_stage_names[order[i]], end_us, end_us - prev_us);
+        prev_us = end_us;
+    }
+}
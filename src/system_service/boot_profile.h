@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Boot stages. The values are exported and must not be reordered. */
+typedef enum {
+    BOOT_STAGE_RETAINED_STATE,          /**< Retained state validated */
+    BOOT_STAGE_LOG,                     /**< Log initialized */
+    BOOT_STAGE_TIMERS,                  /**< app_timer initialized */
+    BOOT_STAGE_BUTTONS_LEDS,            /**< BSP initialized */
+    BOOT_STAGE_POWER_MANAGEMENT,        /**< Power management initialized */
+    BOOT_STAGE_WALL_CLOCK,              /**< Wall clock initialized */
+    BOOT_STAGE_ANNUNCIATOR,             /**< Annunciator initialized */
+    BOOT_STAGE_EVENT_EXPORT,            /**< Event export started */
+    BOOT_STAGE_REQUESTS_RESTORED,       /**< Retained requests restored and annunciated */
+    BOOT_STAGE_BLE_STACK,               /**< SoftDevice enabled */
+    BOOT_STAGE_GAP,                     /**< GAP parameters set */
+    BOOT_STAGE_GATT,                    /**< GATT module initialized */
+    BOOT_STAGE_DB_DISCOVERY,            /**< Database discovery initialized */
+    BOOT_STAGE_SERVICES,                /**< GATT server and client services initialized */
+    BOOT_STAGE_ADVERTISING_INIT,        /**< Advertising initialized */
+    BOOT_STAGE_ROAMING,                 /**< Roaming initialized */
+    BOOT_STAGE_FIRST_ADVERTISEMENT,     /**< Advertising started */
+    BOOT_STAGE_CONN_PARAMS,             /**< Connection parameters module initialized */
+    BOOT_STAGE_PEER_MANAGER,            /**< Peer Manager and FDS initialized */
+    BOOT_STAGE_RELAY,                   /**< Relay uplink initialized */
+    BOOT_STAGE_USBD,                    /**< USB export started */
+    BOOT_STAGE_COMPLETE,                /**< All subsystems initialized */
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+
+
+/**@brief Function for starting the boot profiler.
+ *
+ * @details Must be the first call in main. Starts @ref BOOT_PROFILE_TIMER at 1 MHz. The timer
+ *          keeps counting while the CPU sleeps, for example while the SoftDevice waits for the
+ *          low frequency clock.
+ */
+void boot_profile_init(void);
+
+
+/**@brief Function for recording the end of a boot stage.
+ *
+ * @details Only the first mark of each stage is recorded. Marks after @ref boot_profile_report
+ *          are ignored.
+ *
+ * @param[in] stage  Stage that ended.
+ */
+void boot_profile_mark(boot_stage_t stage);
+
+
+/**@brief Function for getting the time since @ref boot_profile_init in microseconds. */
+uint32_t boot_profile_elapsed_us(void);
+
+
+/**@brief Function for getting the end time of a stage.
+ *
+ * @param[in] stage  Stage.
+ *
+ * @return Time since @ref boot_profile_init in microseconds, or UINT32_MAX if the stage was not marked.
+ */
+uint32_t boot_profile_stage_us(boot_stage_t stage);
+
+
+/**@brief Function for finishing the boot profile.
+ *
+ * @details Marks @ref BOOT_STAGE_COMPLETE, logs the stages in the order they ended with their
+ *          durations, and stops the timer.
+ */
+void boot_profile_report(void);
+
+
+#ifdef __cplusplus
+}
+#endif
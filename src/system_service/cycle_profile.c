@@ -0,0 +1,121 @@
+#include "cycle_profile.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "SEGGER_RTT.h"
+#include "time_service/wall_clock.h"
+
+
+/**@brief Counters of a profiled code path */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[CYCLE_PROFILE_BUCKET_COUNT];
+} point_t;
+
+
+/**@brief Snapshot as written to RTT */
+typedef struct {
+    cycle_profile_snapshot_hdr_t hdr;
+    cycle_profile_stats_t        stats[CYCLE_PROFILE_POINT_COUNT];
+} snapshot_t;
+
+
+// Each point is written from one execution priority only. The snapshots read all of them, so a
+// snapshot may mix the counters of a run that was recorded meanwhile.
+static point_t    m_points[CYCLE_PROFILE_POINT_COUNT];
+
+#if CYCLE_PROFILE_ENABLED
+static snapshot_t m_snapshot;
+static uint8_t    m_buffer[CYCLE_PROFILE_BUFFER_SIZE];
+
+APP_TIMER_DEF(m_report_timer);
+
+
+static void report_timer_handler(void* p_context)
+{
+    m_snapshot.hdr.magic       = CYCLE_PROFILE_MAGIC;
+    m_snapshot.hdr.ticks       = (uint32_t)wall_clock_ticks_get();
+    m_snapshot.hdr.core_hz     = SystemCoreClock;
+    m_snapshot.hdr.version     = CYCLE_PROFILE_VERSION;
+    m_snapshot.hdr.point_count = CYCLE_PROFILE_POINT_COUNT;
+
+    for (uint32_t i = 0; i < CYCLE_PROFILE_POINT_COUNT; i++)
+    {
+        cycle_profile_stats_get((cycle_profile_point_t)i, &m_snapshot.stats[i]);
+    }
+
+    // A snapshot the host has no room for is skipped whole, the next one carries the same counters
+    (void)SEGGER_RTT_Write(CYCLE_PROFILE_RTT_CHANNEL, &m_snapshot, sizeof(m_snapshot));
+}
+#endif
+
+
+ret_code_t cycle_profile_init(void)
+{
+    memset(m_points, 0, sizeof(m_points));
+    for (uint32_t i = 0; i < CYCLE_PROFILE_POINT_COUNT; i++)
+    {
+        m_points[i].min = UINT32_MAX;
+    }
+
+#if CYCLE_PROFILE_ENABLED
+    ret_code_t err_code;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    if (SEGGER_RTT_ConfigUpBuffer(CYCLE_PROFILE_RTT_CHANNEL, "cycles", m_buffer, sizeof(m_buffer),
+                                  SEGGER_RTT_MODE_NO_BLOCK_SKIP) < 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    err_code = app_timer_create(&m_report_timer, APP_TIMER_MODE_REPEATED, report_timer_handler);
+    VERIFY_SUCCESS(err_code);
+
+    return app_timer_start(m_report_timer, APP_TIMER_TICKS(CYCLE_PROFILE_REPORT_INTERVAL_MS), NULL);
+#else
+    return NRF_SUCCESS;
+#endif
+}
+
+
+void cycle_profile_record(cycle_profile_point_t point, uint32_t cycles)
+{
+    point_t* p_point = &m_points[point];
+    uint32_t bucket  = (cycles == 0) ? 0 : MIN(32 - __CLZ(cycles), CYCLE_PROFILE_BUCKET_COUNT - 1);
+
+    p_point->count++;
+    p_point->total += cycles;
+    p_point->min    = MIN(p_point->min, cycles);
+    p_point->max    = MAX(p_point->max, cycles);
+    p_point->histogram[bucket]++;
+}
+
+
+void cycle_profile_stats_get(cycle_profile_point_t point, cycle_profile_stats_t* p_stats)
+{
+    const point_t* p_point = &m_points[point];
+    uint32_t       target  = (p_point->count * 99 + 99) / 100;
+    uint32_t       seen    = 0;
+
+    p_stats->count = p_point->count;
+    p_stats->min   = (p_point->count > 0) ? p_point->min : 0;
+    p_stats->max   = p_point->max;
+    p_stats->mean  = (p_point->count > 0) ? (uint32_t)(p_point->total / p_point->count) : 0;
+    p_stats->p99   = p_point->max;
+
+    for (uint32_t i = 0; i < CYCLE_PROFILE_BUCKET_COUNT; i++)
+    {
+        seen += p_point->histogram[i];
+        if (seen >= target && seen > 0)
+        {
+            p_stats->p99 = MIN(1UL << i, p_point->max);
+            break;
+        }
+    }
+}
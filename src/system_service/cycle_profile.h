@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "nrf.h"
+#include "app_util.h"
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define CYCLE_PROFILE_MAGIC         0x50435943  /**< "CYCP", first word of each snapshot */
+#define CYCLE_PROFILE_VERSION       1           /**< Version of the snapshot layout */
+#define CYCLE_PROFILE_BUCKET_COUNT  32          /**< Histogram buckets. Bucket i counts durations below 2^i cycles. */
+
+
+/**@brief Profiled code paths */
+typedef enum {
+    CYCLE_PROFILE_POINT_BLE_EVT,        /**< BLE event dispatch, all routes of one event */
+    CYCLE_PROFILE_POINT_ARS_C_EVT,      /**< Assistance Request client event handler */
+    CYCLE_PROFILE_POINT_BSP_EVT,        /**< BSP event handler */
+    CYCLE_PROFILE_POINT_UARTE_EVT,      /**< Event export UARTE handler */
+    CYCLE_PROFILE_POINT_WORK_ITEM,      /**< One work item in the main loop */
+    CYCLE_PROFILE_POINT_EXPORT_PROCESS, /**< Event export processing in the main loop */
+    CYCLE_PROFILE_POINT_LOG_PROCESS,    /**< Processing of one deferred log entry, formatting and backends */
+    CYCLE_PROFILE_POINT_COUNT
+} cycle_profile_point_t;
+
+
+/**@brief Statistics of a profiled code path, in CPU cycles */
+typedef struct {
+    uint32_t count;     /**< Number of runs */
+    uint32_t min;       /**< Shortest run */
+    uint32_t mean;      /**< Mean run */
+    uint32_t max;       /**< Longest run */
+    uint32_t p99;       /**< 99th percentile, rounded up to a histogram bucket boundary */
+} cycle_profile_stats_t;
+
+
+/**@brief Snapshot header.
+ *
+ * @details Every CYCLE_PROFILE_REPORT_INTERVAL_MS a snapshot is written to the RTT channel: this
+ *          header followed by one @ref cycle_profile_stats_t per point, in the order of
+ *          @ref cycle_profile_point_t. The statistics count from boot.
+ */
+typedef struct {
+    uint32_t magic;         /**< @ref CYCLE_PROFILE_MAGIC */
+    uint32_t ticks;         /**< Time of the snapshot in app_timer ticks since boot (low 32 bits) */
+    uint32_t core_hz;       /**< CPU clock, to convert cycles to time */
+    uint8_t  version;       /**< @ref CYCLE_PROFILE_VERSION */
+    uint8_t  point_count;   /**< Number of statistics that follow */
+    uint16_t reserved;
+} cycle_profile_snapshot_hdr_t;
+
+STATIC_ASSERT(sizeof(cycle_profile_snapshot_hdr_t) == 16);
+
+
+/**@brief Macro for starting the measurement of a code path.
+ *
+ * @details Reads the DWT cycle counter. Compiles to 0 unless CYCLE_PROFILE_ENABLED is set.
+ *
+ * @return Cycle count to pass to @ref CYCLE_PROFILE_END.
+ * @hideinitializer
+ */
+#define CYCLE_PROFILE_BEGIN()   (CYCLE_PROFILE_ENABLED ? DWT->CYCCNT : 0)
+
+
+/**@brief Macro for ending the measurement of a code path.
+ *
+ * @details The duration includes the interrupts that preempted the code path. Each point must be
+ *          measured from one execution priority only. Compiles to nothing unless
+ *          CYCLE_PROFILE_ENABLED is set.
+ *
+ * @param[in] _point  Point, see @ref cycle_profile_point_t.
+ * @param[in] _begin  Cycle count returned by @ref CYCLE_PROFILE_BEGIN.
+ * @hideinitializer
+ */
+#define CYCLE_PROFILE_END(_point, _begin)                                                       \
+    do                                                                                          \
+    {                                                                                           \
+        if (CYCLE_PROFILE_ENABLED)                                                              \
+        {                                                                                       \
+            cycle_profile_record((_point), DWT->CYCCNT - (_begin));                             \
+        }                                                                                       \
+    } while (0)
+
+
+
+/**@brief Function for enabling the cycle counter and starting the RTT snapshots.
+ *
+ * @details Does nothing unless CYCLE_PROFILE_ENABLED is set.
+ *
+ * @retval NRF_SUCCESS              If the profiler was started or is disabled.
+ * @retval NRF_ERROR_INVALID_PARAM  If the RTT channel does not exist.
+ * @retval err_code                 Otherwise, the error returned by the app_timer module.
+ */
+ret_code_t cycle_profile_init(void);
+
+
+/**@brief Function for recording a run of a code path. Use @ref CYCLE_PROFILE_END instead.
+ *
+ * @param[in] point   Point.
+ * @param[in] cycles  Duration in CPU cycles.
+ */
+void cycle_profile_record(cycle_profile_point_t point, uint32_t cycles);
+
+
+/**@brief Function for getting the statistics of a code path.
+ *
+ * @param[in]  point    Point.
+ * @param[out] p_stats  Statistics.
+ */
+void cycle_profile_stats_get(cycle_profile_point_t point, cycle_profile_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
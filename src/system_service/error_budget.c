@@ -0,0 +1,219 @@
+#include "error_budget.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "ble_conn_state.h"
+#include "ble_hci.h"
+#include "nrf_atomic.h"
+#include "nrf_sdh_ble.h"
+#include "ble_service/ble_evt_router.h"
+#include "system_service/flight_recorder.h"
+#include "time_service/wall_clock.h"
+
+#include "nrf_log.h"
+
+
+/**@brief Error budget of a link */
+typedef struct {
+    uint64_t window_start_ticks;    /**< Start of the current budget window, see @ref wall_clock_ticks_get */
+    uint32_t count;                 /**< Transient errors in the current window */
+    bool     recovering;            /**< True once the link was disconnected for exceeding its budget */
+} link_budget_t;
+
+
+// Errors are reported from the SoftDevice handler, app_timer handlers and the main loop. The link
+// budgets are updated in critical regions, the counters with atomic operations.
+static link_budget_t        m_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static nrf_atomic_u32_t     m_transient_count;
+static nrf_atomic_u32_t     m_recovery_count;
+static nrf_atomic_u32_t     m_injected_count;
+
+#if ERROR_BUDGET_INJECT_INTERVAL_MS
+APP_TIMER_DEF(m_inject_timer);
+
+static const ret_code_t m_inject_errors[] =
+{
+    NRF_ERROR_INVALID_STATE,
+    NRF_ERROR_BUSY,
+    NRF_ERROR_RESOURCES,
+    NRF_ERROR_NO_MEM,
+    NRF_ERROR_TIMEOUT,
+    BLE_ERROR_INVALID_CONN_HANDLE,
+};
+#endif
+
+
+/**@brief Function for disconnecting a link that exceeded its error budget.
+ *
+ * @param[in] conn_handle  Connection handle of the link, already marked as recovering.
+ * @param[in] p_link       Error budget of the link.
+ */
+static void link_recover(uint16_t conn_handle, link_budget_t* p_link)
+{
+    ret_code_t err_code;
+
+    NRF_LOG_WARNING("conn_handle 0x%x exceeded its error budget, disconnecting", conn_handle);
+
+    err_code = sd_ble_gap_disconnect(conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+    if (err_code == NRF_SUCCESS)
+    {
+        (void)nrf_atomic_u32_add(&m_recovery_count, 1);
+    }
+    else
+    {
+        // Tried again with the next error
+        p_link->recovering = false;
+    }
+}
+
+
+static void link_charge(uint16_t conn_handle)
+{
+    uint16_t       conn_idx = ble_conn_state_conn_idx(conn_handle);
+    link_budget_t* p_link;
+    uint64_t       now_ticks;
+    bool           recover;
+
+    if (conn_idx >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    p_link = &m_links[conn_idx];
+
+    CRITICAL_REGION_ENTER();
+    now_ticks = wall_clock_ticks_get();
+    if (wall_clock_ticks_to_ms(now_ticks - p_link->window_start_ticks) >= ERROR_BUDGET_WINDOW_MS)
+    {
+        p_link->window_start_ticks = now_ticks;
+        p_link->count              = 0;
+    }
+
+    // Only the first context to exceed the budget disconnects the link
+    recover = (++p_link->count > ERROR_BUDGET_LINK_MAX) && !p_link->recovering;
+    if (recover)
+    {
+        p_link->recovering = true;
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (recover)
+    {
+        link_recover(conn_handle, p_link);
+    }
+}
+
+
+static void on_connected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    uint16_t conn_idx = ble_conn_state_conn_idx(p_ble_evt->evt.gap_evt.conn_handle);
+
+    if (conn_idx < NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        uint64_t now_ticks = wall_clock_ticks_get();
+
+        CRITICAL_REGION_ENTER();
+        memset(&m_links[conn_idx], 0, sizeof(link_budget_t));
+        m_links[conn_idx].window_start_ticks = now_ticks;
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+BLE_EVT_ROUTE(m_connected_route, BLE_GAP_EVT_CONNECTED, APP_BLE_OBSERVER_PRIO, on_connected, NULL);
+
+
+#if ERROR_BUDGET_INJECT_INTERVAL_MS
+/**@brief Function for injecting a transient error on one of the links, in turn.
+ *
+ * @param[in] p_context  Unused.
+ */
+static void inject_timeout_handler(void* p_context)
+{
+    static uint32_t              next;
+    sdk_mapped_flags_key_list_t  conn_handles = ble_conn_state_conn_handles();
+    uint16_t                     conn_handle  = BLE_CONN_HANDLE_INVALID;
+
+    if (conn_handles.len > 0)
+    {
+        conn_handle = conn_handles.flag_keys[next % conn_handles.len];
+    }
+
+    (void)nrf_atomic_u32_add(&m_injected_count, 1);
+    error_budget_report(m_inject_errors[next % ARRAY_SIZE(m_inject_errors)], conn_handle,
+                        __LINE__, (const uint8_t*)__FILE__);
+    next++;
+}
+#endif
+
+
+ret_code_t error_budget_init(void)
+{
+    memset(m_links, 0, sizeof(m_links));
+    m_transient_count = 0;
+    m_recovery_count  = 0;
+    m_injected_count  = 0;
+
+#if ERROR_BUDGET_INJECT_INTERVAL_MS
+    ret_code_t err_code;
+
+    err_code = app_timer_create(&m_inject_timer, APP_TIMER_MODE_REPEATED, inject_timeout_handler);
+    VERIFY_SUCCESS(err_code);
+
+    NRF_LOG_WARNING("Error budget fault injection enabled");
+
+    return app_timer_start(m_inject_timer, APP_TIMER_TICKS(ERROR_BUDGET_INJECT_INTERVAL_MS), NULL);
+#else
+    return NRF_SUCCESS;
+#endif
+}
+
+
+bool error_budget_is_transient(ret_code_t err_code)
+{
+    switch (err_code)
+    {
+        case NRF_ERROR_INVALID_STATE:       // Procedure not possible in the link's current state
+        case NRF_ERROR_BUSY:                // Another procedure is in progress
+        case NRF_ERROR_RESOURCES:           // SoftDevice buffers full
+        case NRF_ERROR_NO_MEM:              // Queue full
+        case NRF_ERROR_TIMEOUT:             // Peer did not respond
+        case BLE_ERROR_INVALID_CONN_HANDLE: // Link already gone
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+void error_budget_report(ret_code_t err_code, uint16_t conn_handle, uint32_t line, const uint8_t* p_file)
+{
+    if (!error_budget_is_transient(err_code))
+    {
+        app_error_handler(err_code, line, p_file);
+        return;
+    }
+
+    (void)nrf_atomic_u32_add(&m_transient_count, 1);
+    flight_recorder_record(FLIGHT_RECORDER_SOURCE_ERROR, 0, 0, conn_handle, err_code);
+    NRF_LOG_DEBUG("Transient error 0x%x on conn_handle 0x%x (line %d)", err_code, conn_handle, line);
+
+    link_charge(conn_handle);
+}
+
+
+void error_budget_handler(uint32_t nrf_error)
+{
+    error_budget_report(nrf_error, BLE_CONN_HANDLE_INVALID, __LINE__, (const uint8_t*)__FILE__);
+}
+
+
+void error_budget_stats_get(error_budget_stats_t* p_stats)
+{
+    p_stats->transient_count = m_transient_count;
+    p_stats->recovery_count  = m_recovery_count;
+    p_stats->injected_count  = m_injected_count;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "ble.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Macro for checking the result of an operation on a link.
+ *
+ * @details Transient errors are counted against the link's error budget. Any other error is an
+ *          invariant violation and is passed to the app_error handler, which resets the device.
+ *
+ * @param[in] _err_code     Error code.
+ * @param[in] _conn_handle  Connection handle of the link, or BLE_CONN_HANDLE_INVALID.
+ * @hideinitializer
+ */
+#define ERROR_BUDGET_CHECK(_err_code, _conn_handle)                                             \
+    do                                                                                          \
+    {                                                                                           \
+        const uint32_t LOCAL_ERR_CODE = (_err_code);                                            \
+        if (LOCAL_ERR_CODE != NRF_SUCCESS)                                                      \
+        {                                                                                       \
+            error_budget_report(LOCAL_ERR_CODE, (_conn_handle),                                 \
+                                __LINE__, (const uint8_t*)__FILE__);                            \
+        }                                                                                       \
+    } while (0)
+
+
+/**@brief Error budget statistics */
+typedef struct {
+    uint32_t transient_count;   /**< Number of transient errors */
+    uint32_t recovery_count;    /**< Number of links disconnected because they exceeded their budget */
+    uint32_t injected_count;    /**< Number of errors injected by the fault injection */
+} error_budget_stats_t;
+
+
+
+/**@brief Function for initializing the error budget.
+ *
+ * @details Starts the fault injection if @ref ERROR_BUDGET_INJECT_INTERVAL_MS is not zero.
+ *
+ * @retval NRF_SUCCESS  If the error budget was initialized.
+ * @retval err_code     Otherwise, the error returned by the app_timer module.
+ */
+ret_code_t error_budget_init(void);
+
+
+/**@brief Function for checking whether an error is transient.
+ *
+ * @details Transient errors are caused by the state of a link or a temporary lack of resources,
+ *          for example a busy GATT procedure, a full queue or a link that is already gone.
+ *
+ * @param[in] err_code  Error code.
+ */
+bool error_budget_is_transient(ret_code_t err_code);
+
+
+/**@brief Function for handling an error.
+ *
+ * @details A transient error is counted. If a link exceeds @ref ERROR_BUDGET_LINK_MAX transient
+ *          errors within @ref ERROR_BUDGET_WINDOW_MS, it is disconnected, so that the wearable
+ *          reconnects with a fresh state. Other errors are passed to @ref app_error_handler.
+ *          Can be called from any context.
+ *
+ * @param[in] err_code     Error code.
+ * @param[in] conn_handle  Connection handle of the link, or BLE_CONN_HANDLE_INVALID.
+ * @param[in] line         Line at which the error occurred.
+ * @param[in] p_file       File in which the error occurred.
+ */
+void error_budget_report(ret_code_t err_code, uint16_t conn_handle, uint32_t line, const uint8_t* p_file);
+
+
+/**@brief Function for handling an error of a module error handler that has no link context.
+ *
+ * @details Can be used as @ref ble_srv_error_handler_t.
+ *
+ * @param[in] nrf_error  Error code.
+ */
+void error_budget_handler(uint32_t nrf_error);
+
+
+/**@brief Function for getting the error budget statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void error_budget_stats_get(error_budget_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
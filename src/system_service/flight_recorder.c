@@ -0,0 +1,212 @@
+#include "flight_recorder.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "nrf_atomic.h"
+#include "SEGGER_RTT.h"
+
+#include "nrf_log.h"
+
+
+#define RING_MAGIC  0x474E4952  // "RING"
+
+STATIC_ASSERT(IS_POWER_OF_TWO(FLIGHT_RECORDER_SIZE));
+STATIC_ASSERT(FLIGHT_RECORDER_SIZE <= UINT16_MAX);
+
+
+/**@brief Ring as kept across a reset */
+typedef struct {
+    uint32_t                 magic;
+    nrf_atomic_u32_t         head;      /**< Records ever written. Wraps, the size is a power of two */
+    flight_recorder_record_t records[FLIGHT_RECORDER_SIZE];
+} ring_t;
+
+
+static ring_t m_ring __attribute__((section(".non_init")));
+
+// Dump state, only touched from the main loop
+static uint8_t  m_up_buffer[FLIGHT_RECORDER_RTT_BUFFER_SIZE];
+static uint8_t  m_down_buffer[16];
+static bool     m_started;
+static bool     m_dump_hdr_pending;
+static uint32_t m_dump_next;            /**< Ring position of the next record to dump */
+static uint32_t m_dump_remaining;
+
+
+/**@brief Function for getting the ring position of the oldest record held.
+ */
+static uint32_t oldest_get(uint32_t* p_count)
+{
+    uint32_t head = m_ring.head;
+
+    *p_count = MIN(head, FLIGHT_RECORDER_SIZE);
+    return head - *p_count;
+}
+
+
+bool flight_recorder_init(uint32_t reset_reason)
+{
+    bool survived = (m_ring.magic == RING_MAGIC);
+
+    if (!survived)
+    {
+        // Power-on reset, or the RAM was used by something else
+        m_ring.head  = 0;
+        m_ring.magic = RING_MAGIC;
+    }
+
+    flight_recorder_record(FLIGHT_RECORDER_SOURCE_BOOT, 0, 0, 0, reset_reason);
+
+    return survived;
+}
+
+
+ret_code_t flight_recorder_start(void)
+{
+    if (SEGGER_RTT_ConfigUpBuffer(FLIGHT_RECORDER_RTT_CHANNEL, "flight", m_up_buffer, sizeof(m_up_buffer),
+                                  SEGGER_RTT_MODE_NO_BLOCK_SKIP) < 0 ||
+        SEGGER_RTT_ConfigDownBuffer(FLIGHT_RECORDER_RTT_CHANNEL, "flight", m_down_buffer, sizeof(m_down_buffer),
+                                    SEGGER_RTT_MODE_NO_BLOCK_SKIP) < 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_started = true;
+
+    return NRF_SUCCESS;
+}
+
+
+void flight_recorder_record(flight_recorder_source_t source,
+                            uint8_t                  type,
+                            uint8_t                  arg,
+                            uint16_t                 conn_handle,
+                            uint32_t                 value)
+{
+    uint32_t                  pos      = nrf_atomic_u32_fetch_add(&m_ring.head, 1);
+    flight_recorder_record_t* p_record = &m_ring.records[pos & (FLIGHT_RECORDER_SIZE - 1)];
+
+    p_record->ticks       = app_timer_cnt_get();
+    p_record->source      = source;
+    p_record->type        = type;
+    p_record->arg         = arg;
+    p_record->conn_handle = conn_handle;
+    p_record->value       = value;
+}
+
+
+void flight_recorder_fault(uint32_t id, uint32_t pc, uint32_t info)
+{
+    uint16_t line  = 0;
+    uint32_t value = pc;
+
+    switch (id)
+    {
+        case NRF_FAULT_ID_SDK_ERROR:
+            line  = (uint16_t)((const error_info_t*)info)->line_num;
+            value = ((const error_info_t*)info)->err_code;
+            break;
+
+        case NRF_FAULT_ID_SDK_ASSERT:
+            line = (uint16_t)((const assert_info_t*)info)->line_num;
+            break;
+
+        default:
+            break;
+    }
+
+    flight_recorder_record(FLIGHT_RECORDER_SOURCE_FAULT, (uint8_t)id, 0, line, value);
+}
+
+
+uint32_t flight_recorder_count(void)
+{
+    return MIN(m_ring.head, FLIGHT_RECORDER_SIZE);
+}
+
+
+ret_code_t flight_recorder_read(uint32_t index, flight_recorder_record_t* p_record)
+{
+    uint32_t count;
+    uint32_t oldest = oldest_get(&count);
+
+    if (index >= count)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    *p_record = m_ring.records[(oldest + index) & (FLIGHT_RECORDER_SIZE - 1)];
+
+    return NRF_SUCCESS;
+}
+
+
+void flight_recorder_log(void)
+{
+    flight_recorder_record_t record;
+    uint32_t                 count = flight_recorder_count();
+
+    for (uint32_t i = count - MIN(count, FLIGHT_RECORDER_LOG_COUNT); i < count; i++)
+    {
+        if (flight_recorder_read(i, &record) != NRF_SUCCESS)
+        {
+            break;
+        }
+        NRF_LOG_WARNING("Flight %d: %d/%d/%d conn_handle 0x%x value 0x%x",
+                        i, record.source, record.type, record.arg, record.conn_handle, record.value);
+    }
+}
+
+
+void flight_recorder_dump(void)
+{
+    m_dump_next        = oldest_get(&m_dump_remaining);
+    m_dump_hdr_pending = true;
+}
+
+
+void flight_recorder_process(void)
+{
+    uint8_t cmd;
+
+    if (!m_started)
+    {
+        return;
+    }
+
+    if (SEGGER_RTT_Read(FLIGHT_RECORDER_RTT_CHANNEL, &cmd, sizeof(cmd)) > 0 && cmd == FLIGHT_RECORDER_DUMP_CMD)
+    {
+        flight_recorder_dump();
+    }
+
+    if (m_dump_hdr_pending)
+    {
+        flight_recorder_dump_hdr_t hdr = {
+            .magic   = FLIGHT_RECORDER_MAGIC,
+            .version = FLIGHT_RECORDER_VERSION,
+            .count   = (uint16_t)m_dump_remaining
+        };
+
+        if (SEGGER_RTT_Write(FLIGHT_RECORDER_RTT_CHANNEL, &hdr, sizeof(hdr)) == 0)
+        {
+            return;
+        }
+        m_dump_hdr_pending = false;
+    }
+
+    // Records written meanwhile may overtake the dump, in which case the newer record is sent in
+    // place of the overwritten one
+    while (m_dump_remaining > 0)
+    {
+        const flight_recorder_record_t* p_record = &m_ring.records[m_dump_next & (FLIGHT_RECORDER_SIZE - 1)];
+
+        if (SEGGER_RTT_Write(FLIGHT_RECORDER_RTT_CHANNEL, p_record, sizeof(*p_record)) == 0)
+        {
+            return;
+        }
+        m_dump_next++;
+        m_dump_remaining--;
+    }
+}
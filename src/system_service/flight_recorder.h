@@ -0,0 +1,158 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_util.h"
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define FLIGHT_RECORDER_MAGIC       0x52434C46  /**< "FLCR", first word of each dump */
+#define FLIGHT_RECORDER_VERSION     1           /**< Version of the dump layout */
+#define FLIGHT_RECORDER_DUMP_CMD    'D'         /**< Command byte on the RTT down channel requesting a dump */
+
+
+/**@brief Record sources */
+typedef enum {
+    FLIGHT_RECORDER_SOURCE_BOOT,        /**< Start of a run. value: reset reason (RESETREAS) */
+    FLIGHT_RECORDER_SOURCE_WORK,        /**< Work item posted. type: @ref work_queue_type_t, arg, conn_handle and value of the item */
+    FLIGHT_RECORDER_SOURCE_EXPORT,      /**< Exported event. type: @ref event_export_type_t, arg: arg0, conn_handle and value of the event */
+    FLIGHT_RECORDER_SOURCE_ERROR,       /**< Transient error. conn_handle: link it was charged to, value: error code */
+    FLIGHT_RECORDER_SOURCE_FAULT,       /**< Fatal error, last record before the reset. type: low byte of the fault ID, conn_handle: line number, value: error code or PC */
+    FLIGHT_RECORDER_SOURCE_HARD_FAULT,  /**< Hard fault, last record before the reset. value: PC, or 0 if the stack pointer was lost */
+} flight_recorder_source_t;
+
+
+/**@brief Record. The ticks are the low 24 bits of the app_timer counter, which restarts with each
+ *        run, so records are ordered by their position in the ring rather than by time. */
+typedef struct {
+    uint32_t ticks  : 24;   /**< RTC ticks when the record was written */
+    uint32_t source : 8;    /**< @ref flight_recorder_source_t */
+    uint8_t  type;          /**< Source specific type */
+    uint8_t  arg;           /**< Source specific argument */
+    uint16_t conn_handle;   /**< Connection handle, or source specific */
+    uint32_t value;         /**< Source specific value */
+} flight_recorder_record_t;
+
+STATIC_ASSERT(sizeof(flight_recorder_record_t) == 12);
+
+
+/**@brief Dump header.
+ *
+ * @details A dump written to the RTT channel is this header followed by count records, oldest
+ *          first.
+ */
+typedef struct {
+    uint32_t magic;     /**< @ref FLIGHT_RECORDER_MAGIC */
+    uint8_t  version;   /**< @ref FLIGHT_RECORDER_VERSION */
+    uint8_t  reserved;
+    uint16_t count;     /**< Number of records that follow */
+} flight_recorder_dump_hdr_t;
+
+STATIC_ASSERT(sizeof(flight_recorder_dump_hdr_t) == 8);
+
+
+
+/**@brief Function for initializing the flight recorder.
+ *
+ * @details The ring is kept in no-init RAM. If it survived the reset, recording continues after
+ *          the records of the previous run, so a fatal error can be read out after the reset it
+ *          caused. Writes a @ref FLIGHT_RECORDER_SOURCE_BOOT record. Must be called at the start
+ *          of main, after @ref retained_state_init.
+ *
+ * @param[in] reset_reason  Reset reason, see @ref retained_state_reset_reason_get.
+ *
+ * @retval true   If the records of the previous run survived the reset.
+ * @retval false  If the ring was cleared.
+ */
+bool flight_recorder_init(uint32_t reset_reason);
+
+
+/**@brief Function for configuring the RTT channel of the dumps.
+ *
+ * @retval NRF_SUCCESS              If the channel was configured.
+ * @retval NRF_ERROR_INVALID_PARAM  If FLIGHT_RECORDER_RTT_CHANNEL exceeds the RTT buffers.
+ */
+ret_code_t flight_recorder_start(void);
+
+
+/**@brief Function for writing a record.
+ *
+ * @details Lock free, may be called from any context. The slot is claimed with one atomic add,
+ *          so records of preempting contexts are never lost but may be ordered ahead of the
+ *          record they preempted.
+ *
+ * @param[in] source       Record source.
+ * @param[in] type         Source specific type.
+ * @param[in] arg          Source specific argument.
+ * @param[in] conn_handle  Connection handle, or source specific.
+ * @param[in] value        Source specific value.
+ */
+void flight_recorder_record(flight_recorder_source_t source,
+                            uint8_t                  type,
+                            uint8_t                  arg,
+                            uint16_t                 conn_handle,
+                            uint32_t                 value);
+
+
+/**@brief Function for recording a fatal error.
+ *
+ * @details Called from the app_error fault handler with its arguments.
+ *
+ * @param[in] id    Fault ID, NRF_FAULT_ID_*.
+ * @param[in] pc    Program counter of the fault, if known.
+ * @param[in] info  Fault information, error_info_t or assert_info_t depending on the ID.
+ */
+void flight_recorder_fault(uint32_t id, uint32_t pc, uint32_t info);
+
+
+/**@brief Function for getting the number of records held, at most FLIGHT_RECORDER_SIZE. */
+uint32_t flight_recorder_count(void);
+
+
+/**@brief Function for reading a record.
+ *
+ * @details The ring keeps being written while it is read, so a read may return a newer record
+ *          than the one that held the index when counting.
+ *
+ * @param[in]  index     Index of the record, 0 for the oldest one.
+ * @param[out] p_record  Record.
+ *
+ * @retval NRF_SUCCESS              If the record was read.
+ * @retval NRF_ERROR_INVALID_PARAM  If index is not below @ref flight_recorder_count.
+ */
+ret_code_t flight_recorder_read(uint32_t index, flight_recorder_record_t* p_record);
+
+
+/**@brief Function for logging the newest records.
+ *
+ * @details Logs the last FLIGHT_RECORDER_LOG_COUNT records at warning level, so they also reach
+ *          the UART backend.
+ */
+void flight_recorder_log(void);
+
+
+/**@brief Function for starting a dump of the ring to the RTT channel.
+ *
+ * @details The dump is written by @ref flight_recorder_process as the host drains the channel. A
+ *          dump already in progress is restarted.
+ */
+void flight_recorder_dump(void);
+
+
+/**@brief Function for processing the flight recorder in the main loop.
+ *
+ * @details Starts a dump when the host writes @ref FLIGHT_RECORDER_DUMP_CMD to the RTT down
+ *          channel, and writes the records of a dump in progress that fit into the channel.
+ */
+void flight_recorder_process(void);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,443 @@
+#include "load_generator.h"
+#include "config.h"
+
+#include "sdk_common.h"
+
+#if LOAD_GENERATOR_WEARABLES
+#include <math.h>
+
+#include "nrf.h"
+#include "ble.h"
+#include "ble_service/ble_ars_c/ble_ars_c.h"
+#include "request_service/ack_latency.h"
+#include "request_service/request_queue.h"
+#include "system_service/timer_wheel.h"
+#include "system_service/work_queue.h"
+#include "time_service/wall_clock.h"
+
+#include "nrf_log.h"
+
+
+#define JOIN_DELAY_MS       1000    // Mean time from joining the load to the first connect
+#define FLAP_DOWN_MS        1000    // Time a flapping link stays down
+#define FLAP_DELAY_MS       5000    // Mean time from a request to the link flap
+#define DELAY_BUCKET_COUNT  20      // Queueing delay histogram buckets. Bucket i counts delays below 2^i ms.
+
+#define VIRTUAL_HANDLE(_idx)    REQUEST_QUEUE_DETACHED_HANDLE(REQUEST_QUEUE_CAPACITY - 1 - (_idx))
+
+STATIC_ASSERT(LOAD_GENERATOR_WEARABLES <= REQUEST_QUEUE_CAPACITY / 2, "Half of the detached handles stay for restored requests.");
+
+
+/**@brief Lifecycle phase of a virtual wearable */
+typedef enum {
+    PHASE_OFF,          /**< Not part of the load yet */
+    PHASE_DISCONNECTED, /**< Waiting to connect */
+    PHASE_IDLE,         /**< Connected, waiting to raise a request */
+    PHASE_REQUESTING    /**< Connected, request pending */
+} phase_t;
+
+
+/**@brief Virtual wearable */
+typedef struct {
+    timer_wheel_entry_t lifecycle;      /**< Next lifecycle step */
+    timer_wheel_entry_t response;       /**< Write in progress */
+    uint64_t            request_ticks;  /**< Tick count at which the request was raised, see @ref wall_clock_ticks_get */
+    uint8_t             phase;          /**< @ref phase_t */
+    uint8_t             req_state;      /**< Request state held by the wearable */
+    uint8_t             written;        /**< Request state of the write in progress */
+    bool                confirmed;      /**< True if the write in progress is a write request */
+} virtual_wearable_t;
+
+
+/**@brief Counters of a ramp step */
+typedef struct {
+    uint32_t requests;                          /**< Requests raised */
+    uint32_t acks;                              /**< Requests acknowledged */
+    uint32_t delay_max_ms;                      /**< Longest queueing delay */
+    uint32_t histogram[DELAY_BUCKET_COUNT];     /**< Queueing delays, from the request to the acknowledgement write */
+} step_stats_t;
+
+
+// Only touched from the main loop
+static virtual_wearable_t  m_wearables[LOAD_GENERATOR_WEARABLES];
+static uint32_t            m_active;
+static uint32_t            m_rand;
+static step_stats_t        m_step;
+static uint32_t            m_work_dropped;
+static uint32_t            m_requests_rejected;
+static uint32_t            m_acks_lost;
+static timer_wheel_entry_t m_ramp_entry;
+static timer_wheel_entry_t m_staff_entry;
+static timer_wheel_entry_t m_storm_entry;
+
+
+/**@brief Function for getting the next pseudo random number (xorshift32). */
+static uint32_t rand_next(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+
+/**@brief Function for drawing an exponentially distributed interval, capped at ten times its mean. */
+static uint32_t rand_exp_ms(uint32_t mean_ms)
+{
+    float u = (float)((rand_next() >> 8) + 1) / 16777216.0f;
+
+    return (uint32_t)MIN(-logf(u) * mean_ms, 10.0f * mean_ms);
+}
+
+
+static bool rand_percent(uint32_t percent)
+{
+    return (rand_next() % 100) < percent;
+}
+
+
+static virtual_wearable_t* wearable_find(uint16_t conn_handle)
+{
+    uint32_t idx;
+
+    if (!(conn_handle & REQUEST_QUEUE_DETACHED_HANDLE(0)))
+    {
+        return NULL;
+    }
+
+    idx = REQUEST_QUEUE_CAPACITY - 1 - (conn_handle & ~REQUEST_QUEUE_DETACHED_HANDLE(0));
+    if (idx >= LOAD_GENERATOR_WEARABLES || m_wearables[idx].phase == PHASE_OFF)
+    {
+        return NULL;
+    }
+    return &m_wearables[idx];
+}
+
+
+static uint16_t wearable_handle(const virtual_wearable_t* p_wearable)
+{
+    return VIRTUAL_HANDLE(p_wearable - m_wearables);
+}
+
+
+static void work_post(work_queue_type_t type, const virtual_wearable_t* p_wearable, uint8_t arg, uint32_t value)
+{
+    // Drops are part of the measurement, the work queue counts them
+    (void)work_queue_post(type, wearable_handle(p_wearable), arg, value);
+}
+
+
+static void lifecycle_schedule(virtual_wearable_t* p_wearable, uint32_t timeout_ms);
+
+
+/**@brief Function for connecting a virtual wearable. The server reads its request state. */
+static void wearable_connect(virtual_wearable_t* p_wearable)
+{
+    if (p_wearable->req_state & ARS_REQ_PRIORITY_MASK)
+    {
+        // The request survived the link flap
+        p_wearable->phase = PHASE_REQUESTING;
+        work_post(WORK_QUEUE_TYPE_REQUEST_STATE, p_wearable, p_wearable->req_state, 0);
+        return;
+    }
+
+    p_wearable->phase = PHASE_IDLE;
+    work_post(WORK_QUEUE_TYPE_REQUEST_STATE, p_wearable, p_wearable->req_state, 0);
+    lifecycle_schedule(p_wearable, rand_exp_ms(LOAD_GENERATOR_REQUEST_INTERVAL_MS));
+}
+
+
+static void wearable_disconnect(virtual_wearable_t* p_wearable, uint32_t down_ms)
+{
+    timer_wheel_stop(&p_wearable->response);
+    p_wearable->phase = PHASE_DISCONNECTED;
+    work_post(WORK_QUEUE_TYPE_LINK_DOWN, p_wearable, 0, 0);
+    lifecycle_schedule(p_wearable, down_ms);
+}
+
+
+/**@brief Function for raising a request. One in eight requests is urgent. */
+static void wearable_request(virtual_wearable_t* p_wearable)
+{
+    p_wearable->req_state     = ((rand_next() % 8) == 0) ? ASSISTANCE_REQUEST_URGENT_PRIO : 1;
+    p_wearable->request_ticks = wall_clock_ticks_get();
+    p_wearable->phase         = PHASE_REQUESTING;
+    m_step.requests++;
+
+    work_post(WORK_QUEUE_TYPE_REQUEST_STATE, p_wearable, p_wearable->req_state, 0);
+
+    if (rand_percent(LOAD_GENERATOR_FLAP_PERCENT))
+    {
+        lifecycle_schedule(p_wearable, rand_exp_ms(FLAP_DELAY_MS));
+    }
+}
+
+
+static void lifecycle_timeout_handler(timer_wheel_entry_t* p_entry)
+{
+    virtual_wearable_t* p_wearable = CONTAINER_OF(p_entry, virtual_wearable_t, lifecycle);
+
+    switch (p_wearable->phase)
+    {
+        case PHASE_DISCONNECTED:
+            wearable_connect(p_wearable);
+            break;
+
+        case PHASE_IDLE:
+            wearable_request(p_wearable);
+            break;
+
+        case PHASE_REQUESTING:
+            wearable_disconnect(p_wearable, FLAP_DOWN_MS);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+static void lifecycle_schedule(virtual_wearable_t* p_wearable, uint32_t timeout_ms)
+{
+    ret_code_t err_code = timer_wheel_start(&p_wearable->lifecycle, timeout_ms, lifecycle_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for completing a write. The wearable confirms it and notifies its new state.
+ */
+static void response_timeout_handler(timer_wheel_entry_t* p_entry)
+{
+    virtual_wearable_t* p_wearable = CONTAINER_OF(p_entry, virtual_wearable_t, response);
+
+    p_wearable->req_state = p_wearable->written;
+
+    if (p_wearable->confirmed)
+    {
+        work_post(WORK_QUEUE_TYPE_REQUEST_WRITE_RSP, p_wearable, 0, BLE_GATT_STATUS_SUCCESS);
+    }
+    work_post(WORK_QUEUE_TYPE_REQUEST_STATE, p_wearable, p_wearable->req_state, 0);
+
+    if (!(p_wearable->req_state & ARS_REQ_FLAG_ACKNOWLEDGED))
+    {
+        return;
+    }
+
+    // Request served, the wearable clears it
+    p_wearable->req_state = 0;
+    timer_wheel_stop(&p_wearable->lifecycle);
+
+    if (rand_percent(LOAD_GENERATOR_DISCONNECT_PERCENT))
+    {
+        wearable_disconnect(p_wearable, rand_exp_ms(LOAD_GENERATOR_REQUEST_INTERVAL_MS));
+        return;
+    }
+
+    p_wearable->phase = PHASE_IDLE;
+    lifecycle_schedule(p_wearable, rand_exp_ms(LOAD_GENERATOR_REQUEST_INTERVAL_MS));
+}
+
+
+static void delay_record(uint32_t delay_ms)
+{
+    uint32_t idx = 0;
+
+    while (idx < DELAY_BUCKET_COUNT - 1 && delay_ms >= (1UL << idx))
+    {
+        idx++;
+    }
+
+    m_step.histogram[idx]++;
+    m_step.acks++;
+    m_step.delay_max_ms = MAX(m_step.delay_max_ms, delay_ms);
+}
+
+
+/**@brief Function for getting the upper bound of the bucket holding a given queueing delay percentile.
+ */
+static uint32_t delay_percentile_ms(uint32_t percent)
+{
+    uint32_t target = (m_step.acks * percent + 99) / 100;
+    uint32_t seen   = 0;
+
+    for (uint32_t i = 0; i < DELAY_BUCKET_COUNT; i++)
+    {
+        seen += m_step.histogram[i];
+        if (seen >= target && seen > 0)
+        {
+            return MIN(1UL << i, m_step.delay_max_ms);
+        }
+    }
+    return m_step.delay_max_ms;
+}
+
+
+/**@brief Function for reporting the load of the last ramp step.
+ */
+static void step_report(void)
+{
+    ack_latency_stats_t   ack_stats;
+    request_queue_stats_t request_stats;
+    work_queue_stats_t    work_stats;
+
+    ack_latency_stats_get(&ack_stats);
+    request_queue_stats_get(&request_stats);
+    work_queue_stats_get(&work_stats);
+
+    NRF_LOG_INFO("Load %d wearables: %d requests, %d acks, queueing delay p50 %d ms, p99 %d ms, max %d ms",
+                 m_active, m_step.requests, m_step.acks,
+                 delay_percentile_ms(50), delay_percentile_ms(99), m_step.delay_max_ms);
+    // The ack latency percentiles count from the last statistics reset, the other counters per step
+    NRF_LOG_INFO("Load %d wearables: ack latency p50 %d ms, p99 %d ms, %d acks lost",
+                 m_active, ack_stats.p50_ms, ack_stats.p99_ms, ack_stats.lost - m_acks_lost);
+    NRF_LOG_INFO("Load %d wearables: %d work items dropped, %d requests rejected",
+                 m_active, work_stats.dropped - m_work_dropped, request_stats.exhausted - m_requests_rejected);
+
+    memset(&m_step, 0, sizeof(m_step));
+    m_work_dropped      = work_stats.dropped;
+    m_requests_rejected = request_stats.exhausted;
+    m_acks_lost         = ack_stats.lost;
+}
+
+
+static void ramp_timeout_handler(timer_wheel_entry_t* p_entry)
+{
+    ret_code_t err_code;
+    uint32_t   target;
+
+    if (m_active > 0)
+    {
+        step_report();
+    }
+
+    target = MIN(m_active + LOAD_GENERATOR_RAMP_STEP, LOAD_GENERATOR_WEARABLES);
+    for (; m_active < target; m_active++)
+    {
+        m_wearables[m_active].phase = PHASE_DISCONNECTED;
+        lifecycle_schedule(&m_wearables[m_active], rand_exp_ms(JOIN_DELAY_MS));
+    }
+
+    err_code = timer_wheel_start(&m_ramp_entry, LOAD_GENERATOR_RAMP_INTERVAL_MS, ramp_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for simulating a staff member pressing the acknowledgement button.
+ */
+static void staff_timeout_handler(timer_wheel_entry_t* p_entry)
+{
+    ret_code_t err_code;
+
+    (void)work_queue_post(WORK_QUEUE_TYPE_REQUEST_ACK, BLE_CONN_HANDLE_INVALID, 0, 0);
+
+    err_code = timer_wheel_start(&m_staff_entry, rand_exp_ms(LOAD_GENERATOR_ACK_INTERVAL_MS), staff_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for letting every idle virtual wearable raise a request at once.
+ */
+static void storm_timeout_handler(timer_wheel_entry_t* p_entry)
+{
+    ret_code_t err_code;
+
+    for (uint32_t i = 0; i < m_active; i++)
+    {
+        if (m_wearables[i].phase == PHASE_IDLE)
+        {
+            timer_wheel_stop(&m_wearables[i].lifecycle);
+            wearable_request(&m_wearables[i]);
+        }
+    }
+
+    err_code = timer_wheel_start(&m_storm_entry, LOAD_GENERATOR_STORM_INTERVAL_MS, storm_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+ret_code_t load_generator_start(void)
+{
+    ret_code_t err_code;
+
+    memset(m_wearables, 0, sizeof(m_wearables));
+    memset(&m_step, 0, sizeof(m_step));
+    memset(&m_ramp_entry, 0, sizeof(m_ramp_entry));
+    memset(&m_staff_entry, 0, sizeof(m_staff_entry));
+    memset(&m_storm_entry, 0, sizeof(m_storm_entry));
+    m_active = 0;
+
+    // Seeded per device, so that a run can be repeated on the same board
+    m_rand = NRF_FICR->DEVICEID[0] | 1;
+
+    NRF_LOG_WARNING("Load generator: up to %d virtual wearables, %d more every %d ms",
+                    LOAD_GENERATOR_WEARABLES, LOAD_GENERATOR_RAMP_STEP, LOAD_GENERATOR_RAMP_INTERVAL_MS);
+
+    err_code = timer_wheel_start(&m_ramp_entry, 0, ramp_timeout_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = timer_wheel_start(&m_staff_entry, rand_exp_ms(LOAD_GENERATOR_ACK_INTERVAL_MS), staff_timeout_handler);
+    VERIFY_SUCCESS(err_code);
+
+#if LOAD_GENERATOR_STORM_INTERVAL_MS
+    err_code = timer_wheel_start(&m_storm_entry, LOAD_GENERATOR_STORM_INTERVAL_MS, storm_timeout_handler);
+    VERIFY_SUCCESS(err_code);
+#endif
+
+    return NRF_SUCCESS;
+}
+
+
+bool load_generator_owns(uint16_t conn_handle)
+{
+    return wearable_find(conn_handle) != NULL;
+}
+
+
+ret_code_t load_generator_write(uint16_t conn_handle, uint8_t req_state, bool confirmed)
+{
+    virtual_wearable_t* p_wearable = wearable_find(conn_handle);
+
+    if (p_wearable == NULL || p_wearable->phase == PHASE_DISCONNECTED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (timer_wheel_is_running(&p_wearable->response))
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    if (req_state & ARS_REQ_FLAG_ACKNOWLEDGED)
+    {
+        delay_record((uint32_t)MIN(wall_clock_ticks_to_ms(wall_clock_ticks_get() - p_wearable->request_ticks),
+                                   UINT32_MAX));
+    }
+
+    p_wearable->written   = req_state;
+    p_wearable->confirmed = confirmed;
+
+    return timer_wheel_start(&p_wearable->response, LOAD_GENERATOR_GATT_LATENCY_MS, response_timeout_handler);
+}
+
+
+#else
+
+
+ret_code_t load_generator_start(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+bool load_generator_owns(uint16_t conn_handle)
+{
+    return false;
+}
+
+
+ret_code_t load_generator_write(uint16_t conn_handle, uint8_t req_state, bool confirmed)
+{
+    return NRF_ERROR_INVALID_STATE;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Function for starting the load generator.
+ *
+ * @details Does nothing unless LOAD_GENERATOR_WEARABLES is set. The virtual wearables take the
+ *          highest detached connection handles of the request queue. They go through the same work
+ *          items as real wearables: connect and report their request state, raise requests at
+ *          exponentially distributed intervals, flap their links, and confirm the receipt and the
+ *          acknowledgement writes after LOAD_GENERATOR_GATT_LATENCY_MS. Simulated staff acknowledge
+ *          the queue at exponentially distributed intervals. The number of wearables ramps up by
+ *          LOAD_GENERATOR_RAMP_STEP every LOAD_GENERATOR_RAMP_INTERVAL_MS, and each step is
+ *          reported in the log. Must be called after @ref timer_wheel_init.
+ *
+ * @retval NRF_SUCCESS  If the load generator was started or is disabled.
+ * @retval err_code     Otherwise, the error returned by the timer wheel.
+ */
+ret_code_t load_generator_start(void);
+
+
+/**@brief Function for checking whether a connection handle belongs to a virtual wearable.
+ *
+ * @param[in] conn_handle  Connection handle.
+ */
+bool load_generator_owns(uint16_t conn_handle);
+
+
+/**@brief Function for writing the request state of a virtual wearable.
+ *
+ * @details The virtual wearable notifies the new state, and confirms a confirmed write with a
+ *          REQUEST_WRITE_RSP work item. Must be called from the main loop.
+ *
+ * @param[in] conn_handle  Connection handle of the virtual wearable.
+ * @param[in] req_state    Request state.
+ * @param[in] confirmed    True for a write request, false for a write command.
+ *
+ * @retval NRF_SUCCESS              If the write was accepted.
+ * @retval NRF_ERROR_INVALID_STATE  If the virtual wearable is not connected.
+ * @retval NRF_ERROR_BUSY           If the previous write is still in progress.
+ */
+ret_code_t load_generator_write(uint16_t conn_handle, uint8_t req_state, bool confirmed);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,167 @@
+#include "log_routing.h"
+#include "config.h"
+
+#include <string.h>
+
+#include "sdk_common.h"
+#include "nrf.h"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_backend_rtt.h"
+#include "nrf_log_backend_uart.h"
+
+
+/**@brief Counters of a backend */
+typedef struct {
+    uint32_t messages;
+    uint64_t cycles;
+} backend_counters_t;
+
+
+static void rtt_put(nrf_log_backend_t const* p_backend, nrf_log_entry_t* p_entry);
+static void rtt_panic_set(nrf_log_backend_t const* p_backend);
+static void rtt_flush(nrf_log_backend_t const* p_backend);
+static void uart_put(nrf_log_backend_t const* p_backend, nrf_log_entry_t* p_entry);
+static void uart_panic_set(nrf_log_backend_t const* p_backend);
+static void uart_flush(nrf_log_backend_t const* p_backend);
+
+// The SDK backends, wrapped to count the messages and the time spent on them
+static const nrf_log_backend_api_t m_rtt_api  = { .put = rtt_put,  .panic_set = rtt_panic_set,  .flush = rtt_flush  };
+static const nrf_log_backend_api_t m_uart_api = { .put = uart_put, .panic_set = uart_panic_set, .flush = uart_flush };
+
+NRF_LOG_BACKEND_DEF(m_rtt_backend,  m_rtt_api,  NULL);
+NRF_LOG_BACKEND_DEF(m_uart_backend, m_uart_api, NULL);
+
+static nrf_log_backend_t const* const mp_backends[LOG_ROUTING_BACKEND_COUNT] =
+{
+    [LOG_ROUTING_BACKEND_RTT]  = &m_rtt_backend,
+    [LOG_ROUTING_BACKEND_UART] = &m_uart_backend,
+};
+
+// Written from the main loop only, where the deferred entries are processed
+static backend_counters_t m_counters[LOG_ROUTING_BACKEND_COUNT];
+static uint32_t           m_backlog;
+static uint32_t           m_backlog_max;
+
+
+static void counted_put(log_routing_backend_t     backend,
+                        nrf_log_backend_api_t const* p_api,
+                        nrf_log_backend_t const*  p_backend,
+                        nrf_log_entry_t*          p_entry)
+{
+    uint32_t start = DWT->CYCCNT;
+
+    p_api->put(p_backend, p_entry);
+
+    m_counters[backend].cycles += DWT->CYCCNT - start;
+    m_counters[backend].messages++;
+}
+
+
+static void rtt_put(nrf_log_backend_t const* p_backend, nrf_log_entry_t* p_entry)
+{
+    counted_put(LOG_ROUTING_BACKEND_RTT, &nrf_log_backend_rtt_api, p_backend, p_entry);
+}
+
+
+static void rtt_panic_set(nrf_log_backend_t const* p_backend)
+{
+    nrf_log_backend_rtt_api.panic_set(p_backend);
+}
+
+
+static void rtt_flush(nrf_log_backend_t const* p_backend)
+{
+    nrf_log_backend_rtt_api.flush(p_backend);
+}
+
+
+static void uart_put(nrf_log_backend_t const* p_backend, nrf_log_entry_t* p_entry)
+{
+    counted_put(LOG_ROUTING_BACKEND_UART, &nrf_log_backend_uart_api, p_backend, p_entry);
+}
+
+
+static void uart_panic_set(nrf_log_backend_t const* p_backend)
+{
+    nrf_log_backend_uart_api.panic_set(p_backend);
+}
+
+
+static void uart_flush(nrf_log_backend_t const* p_backend)
+{
+    nrf_log_backend_uart_api.flush(p_backend);
+}
+
+
+static void backend_add(log_routing_backend_t backend, nrf_log_severity_t severity)
+{
+    int32_t backend_id = nrf_log_backend_add(mp_backends[backend], severity);
+
+    APP_ERROR_CHECK_BOOL(backend_id >= 0);
+    nrf_log_backend_enable(mp_backends[backend]);
+}
+
+
+void log_routing_init(void)
+{
+    memset(m_counters, 0, sizeof(m_counters));
+    m_backlog     = 0;
+    m_backlog_max = 0;
+
+    nrf_log_backend_rtt_init();
+    backend_add(LOG_ROUTING_BACKEND_RTT, LOG_ROUTING_RTT_LEVEL);
+
+    nrf_log_backend_uart_init();
+    backend_add(LOG_ROUTING_BACKEND_UART, LOG_ROUTING_UART_LEVEL);
+}
+
+
+ret_code_t log_routing_level_set(log_routing_backend_t backend, const char* p_module, nrf_log_severity_t severity)
+{
+    uint32_t backend_id = nrf_log_backend_id_get(mp_backends[backend]);
+    bool     found      = false;
+
+    for (uint32_t i = 0; i < nrf_log_module_cnt_get(); i++)
+    {
+        if (p_module == NULL || strcmp(nrf_log_module_name_get(i, false), p_module) == 0)
+        {
+            nrf_log_module_filter_set(backend_id, i, severity);
+            found = true;
+        }
+    }
+
+    return found ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND;
+}
+
+
+bool log_routing_process(void)
+{
+    bool pending = NRF_LOG_PROCESS();
+
+    // Each call processes one entry, so the length of a run is the backlog the run started with
+    if (pending)
+    {
+        m_backlog++;
+        m_backlog_max = MAX(m_backlog_max, m_backlog);
+    }
+    else
+    {
+        m_backlog = 0;
+    }
+    return pending;
+}
+
+
+void log_routing_stats_get(log_routing_stats_t* p_stats)
+{
+    uint32_t cycles_per_ms = SystemCoreClock / 1000;
+
+    p_stats->backlog_max = m_backlog_max;
+
+    for (uint32_t i = 0; i < LOG_ROUTING_BACKEND_COUNT; i++)
+    {
+        p_stats->backends[i].messages = m_counters[i].messages;
+        p_stats->backends[i].busy_ms  = (uint32_t)(m_counters[i].cycles / cycles_per_ms);
+    }
+}
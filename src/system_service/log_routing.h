@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "nrf_log_types.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Log backends */
+typedef enum {
+    LOG_ROUTING_BACKEND_RTT,    /**< RTT, for diagnostics. Fast, may drop when no debugger reads */
+    LOG_ROUTING_BACKEND_UART,   /**< UART, for critical events. Slow, blocks the log processing */
+    LOG_ROUTING_BACKEND_COUNT
+} log_routing_backend_t;
+
+
+/**@brief Log backend statistics */
+typedef struct {
+    uint32_t messages;  /**< Number of messages written */
+    uint32_t busy_ms;   /**< Time spent writing them */
+} log_routing_backend_stats_t;
+
+
+/**@brief Log routing statistics */
+typedef struct {
+    uint32_t                    backlog_max;    /**< Most log entries waiting for the main loop at once */
+    log_routing_backend_stats_t backends[LOG_ROUTING_BACKEND_COUNT];
+} log_routing_stats_t;
+
+
+
+/**@brief Function for adding the RTT and UART log backends with their initial severity filters.
+ *
+ * @details Replaces NRF_LOG_DEFAULT_BACKENDS_INIT. All modules start at LOG_ROUTING_RTT_LEVEL on
+ *          RTT and LOG_ROUTING_UART_LEVEL on UART. Must be called after NRF_LOG_INIT.
+ */
+void log_routing_init(void);
+
+
+/**@brief Function for setting the severity filter of a log module on a backend.
+ *
+ * @details Messages above the level the module was compiled with stay filtered.
+ *
+ * @param[in] backend    Backend.
+ * @param[in] p_module   Module name as registered with NRF_LOG_MODULE_NAME, or NULL for all modules.
+ * @param[in] severity   Highest severity passed to the backend.
+ *
+ * @retval NRF_SUCCESS          If the filter was set.
+ * @retval NRF_ERROR_NOT_FOUND  If no module has the given name.
+ */
+ret_code_t log_routing_level_set(log_routing_backend_t backend, const char* p_module, nrf_log_severity_t severity);
+
+
+/**@brief Function for processing the deferred log entries.
+ *
+ * @details Replaces NRF_LOG_PROCESS in the main loop and tracks the backlog.
+ *
+ * @retval true   If more entries are waiting.
+ * @retval false  If all entries were processed.
+ */
+bool log_routing_process(void);
+
+
+/**@brief Function for getting the log routing statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void log_routing_stats_get(log_routing_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
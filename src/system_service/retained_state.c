@@ -0,0 +1,323 @@
+#include "retained_state.h"
+#include "config.h"
+
+#include <stddef.h>
+
+#include "sdk_common.h"
+#include "app_util_platform.h"
+#include "app_timer.h"
+#include "ble.h"
+#include "ble_conn_state.h"
+#include "crc16.h"
+#include "nrf.h"
+#include "nrf_sdh_ble.h"
+#include "ble_service/ble_evt_router.h"
+#include "system_service/work_queue.h"
+
+#include "nrf_log.h"
+
+
+#define RETAINED_MAGIC      0x52544E44  // "RTND"
+#define RESTORED_MAX        (REQUEST_QUEUE_CAPACITY - LOAD_GENERATOR_WEARABLES)  // The load generator takes the detached handles from the top index down
+
+
+/**@brief Request as kept across a reset. The wearable is identified by its address, since the
+ *        connection handles do not survive the reset. */
+typedef struct {
+    ble_gap_addr_t peer;        /**< Address of the wearable */
+    uint8_t        priority;    /**< Request priority */
+    uint32_t       seq;         /**< Arrival sequence number */
+    uint64_t       time_ms;     /**< Arrival time */
+} retained_request_t;
+
+/**@brief Wearable link as kept across a reset */
+typedef struct {
+    ble_gap_addr_t peer;        /**< Address of the wearable */
+    bool           valid;       /**< True while the link is up */
+} retained_link_t;
+
+/**@brief Retained state. Only the first request_count requests are covered by the CRC. */
+typedef struct {
+    uint32_t           magic;
+    uint32_t           restart_count;
+    uint32_t           reset_reason;
+    uint32_t           request_count;
+    retained_link_t    links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+    retained_request_t requests[REQUEST_QUEUE_CAPACITY];
+    uint16_t           crc;
+} retained_t;
+
+/**@brief Restored request */
+typedef struct {
+    retained_request_t request;
+    bool               detached;    /**< True until the wearable reconnects or the request expires */
+} restored_t;
+
+
+static retained_t m_retained __attribute__((section(".non_init")));
+
+static restored_t                      m_restored[RESTORED_MAX];
+static uint32_t                        m_restored_count;
+static retained_link_t                 m_restored_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];  // Links that were up before the reset
+static retained_state_expiry_handler_t m_expiry_handler;
+
+APP_TIMER_DEF(m_reattach_timer);
+
+
+static uint16_t crc_compute(void)
+{
+    return crc16_compute((const uint8_t*)&m_retained,
+                         offsetof(retained_t, requests) + m_retained.request_count * sizeof(retained_request_t),
+                         NULL);
+}
+
+
+static bool retained_valid(void)
+{
+    return m_retained.magic == RETAINED_MAGIC &&
+           m_retained.request_count <= REQUEST_QUEUE_CAPACITY &&
+           m_retained.crc == crc_compute();
+}
+
+
+static bool peer_equal(const ble_gap_addr_t* p_a, const ble_gap_addr_t* p_b)
+{
+    return p_a->addr_type == p_b->addr_type && memcmp(p_a->addr, p_b->addr, BLE_GAP_ADDR_LEN) == 0;
+}
+
+
+/**@brief Function for getting the wearable address of a request's connection handle.
+ *
+ * @return Address, or NULL if the handle belongs to no wearable.
+ */
+static const ble_gap_addr_t* peer_get(uint16_t conn_handle)
+{
+    uint16_t idx;
+
+    if (conn_handle & RETAINED_STATE_DETACHED_HANDLE(0))
+    {
+        // Detached handles above the restored requests belong to virtual wearables
+        idx = conn_handle & ~RETAINED_STATE_DETACHED_HANDLE(0);
+        return (idx < m_restored_count) ? &m_restored[idx].request.peer : NULL;
+    }
+
+    idx = ble_conn_state_conn_idx(conn_handle);
+    if (idx >= NRF_SDH_BLE_TOTAL_LINK_COUNT || !m_retained.links[idx].valid)
+    {
+        return NULL;
+    }
+    return &m_retained.links[idx].peer;
+}
+
+
+static void reattach_timeout_handler(void* p_context)
+{
+    for (uint32_t i = 0; i < m_restored_count; i++)
+    {
+        if (m_restored[i].detached)
+        {
+            m_restored[i].detached = false;
+            m_expiry_handler(RETAINED_STATE_DETACHED_HANDLE(i));
+        }
+    }
+}
+
+
+static void on_connected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    const ble_gap_evt_t* p_gap_evt = &p_ble_evt->evt.gap_evt;
+    uint16_t             conn_idx  = ble_conn_state_conn_idx(p_gap_evt->conn_handle);
+
+    if (p_gap_evt->params.connected.role != BLE_GAP_ROLE_PERIPH || conn_idx >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    m_retained.links[conn_idx].peer  = p_gap_evt->params.connected.peer_addr;
+    m_retained.links[conn_idx].valid = true;
+    m_retained.crc                   = crc_compute();
+
+    // Give a restored request back to its wearable. The request queue belongs to the main loop
+    for (uint32_t i = 0; i < m_restored_count; i++)
+    {
+        if (m_restored[i].detached && peer_equal(&m_restored[i].request.peer, &p_gap_evt->params.connected.peer_addr))
+        {
+            m_restored[i].detached = false;
+            if (work_queue_post(WORK_QUEUE_TYPE_REQUEST_REATTACH, p_gap_evt->conn_handle, 0, i) != NRF_SUCCESS)
+            {
+                NRF_LOG_WARNING("Work queue full, restored request %d not reattached", i);
+            }
+            break;
+        }
+    }
+}
+
+
+/**@brief Function for reattaching a restored request to its reconnected wearable.
+ *
+ * @details The request keeps its place in the queue.
+ *
+ * @param[in] p_item  Reattach work item.
+ */
+static void reattach_work(const work_queue_item_t* p_item)
+{
+    if (request_queue_handle_update(RETAINED_STATE_DETACHED_HANDLE(p_item->value), p_item->conn_handle) == NRF_SUCCESS)
+    {
+        NRF_LOG_INFO("Restored request reattached to conn_handle 0x%x", p_item->conn_handle);
+    }
+}
+
+
+static void on_disconnected(const ble_evt_t* p_ble_evt, void* p_context)
+{
+    uint16_t conn_idx = ble_conn_state_conn_idx(p_ble_evt->evt.gap_evt.conn_handle);
+
+    if (conn_idx >= NRF_SDH_BLE_TOTAL_LINK_COUNT || !m_retained.links[conn_idx].valid)
+    {
+        return;
+    }
+
+    m_retained.links[conn_idx].valid = false;
+    m_retained.crc                   = crc_compute();
+}
+
+BLE_EVT_ROUTE(m_connected_route,    BLE_GAP_EVT_CONNECTED,    APP_BLE_OBSERVER_PRIO, on_connected,    NULL);
+BLE_EVT_ROUTE(m_disconnected_route, BLE_GAP_EVT_DISCONNECTED, APP_BLE_OBSERVER_PRIO, on_disconnected, NULL);
+
+
+void retained_state_init(void)
+{
+    uint32_t reset_reason;
+
+    reset_reason         = NRF_POWER->RESETREAS;
+    NRF_POWER->RESETREAS = reset_reason;
+
+    m_restored_count = 0;
+
+    if (retained_valid())
+    {
+        // Only with the load generator built in can more requests be retained than restored
+        m_restored_count = MIN(m_retained.request_count, RESTORED_MAX);
+        for (uint32_t i = 0; i < m_restored_count; i++)
+        {
+            m_restored[i].request  = m_retained.requests[i];
+            m_restored[i].detached = true;
+        }
+        m_retained.restart_count++;
+
+        // The links did not survive the reset
+        memcpy(m_restored_links, m_retained.links, sizeof(m_restored_links));
+        memset(m_retained.links, 0, sizeof(m_retained.links));
+    }
+    else
+    {
+        memset(&m_retained, 0, sizeof(m_retained));
+        memset(m_restored_links, 0, sizeof(m_restored_links));
+        m_retained.magic = RETAINED_MAGIC;
+    }
+
+    // The requests stay retained until the restored queue is saved over them
+    m_retained.reset_reason = reset_reason;
+    m_retained.crc          = crc_compute();
+}
+
+
+uint32_t retained_state_request_count(void)
+{
+    return m_restored_count;
+}
+
+
+ret_code_t retained_state_request_get(uint32_t idx, request_queue_item_t* p_item)
+{
+    VERIFY_PARAM_NOT_NULL(p_item);
+
+    if (idx >= m_restored_count)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    p_item->conn_handle = RETAINED_STATE_DETACHED_HANDLE(idx);
+    p_item->priority    = m_restored[idx].request.priority;
+    p_item->seq         = m_restored[idx].request.seq;
+    p_item->time_ms     = m_restored[idx].request.time_ms;
+    p_item->escalated   = false;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t retained_state_reattach_start(retained_state_expiry_handler_t expiry_handler)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(expiry_handler);
+
+    m_expiry_handler = expiry_handler;
+    work_queue_handler_set(WORK_QUEUE_TYPE_REQUEST_REATTACH, reattach_work);
+
+    // Logged here since the log is not initialized yet in retained_state_init
+    for (uint32_t i = 0; i < NRF_SDH_BLE_TOTAL_LINK_COUNT; i++)
+    {
+        if (m_restored_links[i].valid)
+        {
+            const uint8_t* p_addr = m_restored_links[i].peer.addr;
+
+            NRF_LOG_INFO("Link %d was up before the reset: %02x:%02x:%02x:%02x:%02x:%02x",
+                         i, p_addr[5], p_addr[4], p_addr[3], p_addr[2], p_addr[1], p_addr[0]);
+        }
+    }
+
+    if (m_restored_count == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    err_code = app_timer_create(&m_reattach_timer, APP_TIMER_MODE_SINGLE_SHOT, reattach_timeout_handler);
+    VERIFY_SUCCESS(err_code);
+
+    return app_timer_start(m_reattach_timer, APP_TIMER_TICKS(RETAINED_REATTACH_TIMEOUT_MS), NULL);
+}
+
+
+void retained_state_save(void)
+{
+    request_queue_item_t  item;
+    const ble_gap_addr_t* p_peer;
+    uint32_t              count = 0;
+
+    // Called from the main loop. The link routes update the links and the CRC in between
+    CRITICAL_REGION_ENTER();
+
+    for (uint32_t i = 0; request_queue_item_get(i, &item) == NRF_SUCCESS; i++)
+    {
+        p_peer = peer_get(item.conn_handle);
+        if (p_peer == NULL)
+        {
+            continue;
+        }
+
+        m_retained.requests[count].peer     = *p_peer;
+        m_retained.requests[count].priority = item.priority;
+        m_retained.requests[count].seq      = item.seq;
+        m_retained.requests[count].time_ms  = item.time_ms;
+        count++;
+    }
+
+    m_retained.request_count = count;
+    m_retained.crc           = crc_compute();
+
+    CRITICAL_REGION_EXIT();
+}
+
+
+uint32_t retained_state_reset_reason_get(void)
+{
+    return m_retained.reset_reason;
+}
+
+
+uint32_t retained_state_restart_count_get(void)
+{
+    return m_retained.restart_count;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "request_service/request_queue.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define RETAINED_STATE_DETACHED_HANDLE(_idx)    REQUEST_QUEUE_DETACHED_HANDLE(_idx)     /**< Connection handle of a restored request whose wearable has not reconnected yet. _idx is below REQUEST_QUEUE_CAPACITY - LOAD_GENERATOR_WEARABLES, the handles above belong to the load generator */
+
+
+/**@brief Expiry handler type.
+ *
+ * @details Called for each restored request whose wearable did not reconnect within
+ *          @ref RETAINED_REATTACH_TIMEOUT_MS.
+ *
+ * @param[in] conn_handle  Detached connection handle of the request.
+ */
+typedef void (*retained_state_expiry_handler_t)(uint16_t conn_handle);
+
+
+
+/**@brief Function for validating the state retained across the last reset.
+ *
+ * @details Must be called at the start of main, before the RESETREAS register is read elsewhere.
+ *          The retained state is kept in no-init RAM and is valid if its magic number and CRC
+ *          match. Otherwise, for example after a power-on reset, it is cleared and nothing is
+ *          restored.
+ */
+void retained_state_init(void);
+
+
+/**@brief Function for getting the number of requests retained across the last reset. */
+uint32_t retained_state_request_count(void);
+
+
+/**@brief Function for getting a request retained across the last reset.
+ *
+ * @details The request's connection handle is @ref RETAINED_STATE_DETACHED_HANDLE until its
+ *          wearable reconnects. The handle is then updated in the request queue.
+ *
+ * @param[in]  idx     Index of the request, below @ref retained_state_request_count.
+ * @param[out] p_item  Request.
+ *
+ * @retval NRF_SUCCESS          If the request was read.
+ * @retval NRF_ERROR_NOT_FOUND  If idx is out of range.
+ */
+ret_code_t retained_state_request_get(uint32_t idx, request_queue_item_t* p_item);
+
+
+/**@brief Function for waiting for the wearables of the restored requests to reconnect.
+ *
+ * @details Must be called once the restored requests are in the request queue and the work queue
+ *          is initialized. A request is reattached from the main loop, through the work queue.
+ *          The expiry handler is called from the app_timer handler.
+ *
+ * @param[in] expiry_handler  Handler for the requests whose wearable did not reconnect.
+ *
+ * @retval NRF_SUCCESS  If the reconnect timer was started, or no request was restored.
+ * @retval err_code     Otherwise, the error returned by the app_timer module.
+ */
+ret_code_t retained_state_reattach_start(retained_state_expiry_handler_t expiry_handler);
+
+
+/**@brief Function for saving the request queue to the retained state.
+ *
+ * @details Must be called after every change of the request queue, from the main loop.
+ */
+void retained_state_save(void);
+
+
+/**@brief Function for getting the reset reason (RESETREAS register) of the last reset. */
+uint32_t retained_state_reset_reason_get(void);
+
+
+/**@brief Function for getting the number of warm restarts since the last power-on reset. */
+uint32_t retained_state_restart_count_get(void);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,255 @@
+#include "stack_monitor.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "hardfault.h"
+#include "system_service/flight_recorder.h"
+#if NRF_MODULE_ENABLED(NRF_STACK_GUARD)
+#include "nrf_stack_guard.h"
+#endif
+
+#include "nrf_log.h"
+
+
+#define STACK_PAINT         0x5AC5AC5A  // Pattern of the unused stack
+#define FAULT_MAGIC         0x464C5400  // "FLT"
+
+#if NRF_MODULE_ENABLED(NRF_STACK_GUARD)
+#define GUARD_SIZE          (1UL << NRF_STACK_GUARD_CONFIG_SIZE)
+#else
+#define GUARD_SIZE          0
+#endif
+
+#define PAINT_START         ((uint32_t)STACK_BASE + GUARD_SIZE)     // The guard must not be read or written
+#define PAINT_END           ((uint32_t)STACK_TOP)
+
+
+/**@brief Fault record. Written by the hard fault handler and read after the reset. */
+typedef struct {
+    uint32_t              magic;
+    stack_monitor_fault_t fault;
+} fault_record_t;
+
+
+static fault_record_t m_fault_record __attribute__((section(".non_init")));
+
+static stack_monitor_fault_t m_fault;
+static bool                  m_fault_valid;
+static uint32_t              m_used_max;
+static stack_monitor_prio_t  m_prio[STACK_MONITOR_PRIO_COUNT];
+
+APP_TIMER_DEF(m_scan_timer);
+
+
+/**@brief Function for counting the active interrupts. */
+static uint8_t nesting_get(void)
+{
+    uint8_t nesting = 0;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(NVIC->IABR); i++)
+    {
+        nesting += __builtin_popcount(NVIC->IABR[i]);
+    }
+    return nesting;
+}
+
+
+/**@brief Function for finding the high-water mark of the stack.
+ *
+ * @details The stack grows down, so the lowest word that lost the paint marks the deepest use.
+ *
+ * @return Deepest use of the stack in bytes.
+ */
+static uint32_t stack_used_scan(void)
+{
+    const uint32_t* p_word = (const uint32_t*)PAINT_START;
+
+    while ((uint32_t)p_word < PAINT_END && *p_word == STACK_PAINT)
+    {
+        p_word++;
+    }
+    return PAINT_END - (uint32_t)p_word;
+}
+
+
+static void prio_log(void)
+{
+    for (uint32_t i = 0; i < STACK_MONITOR_PRIO_COUNT; i++)
+    {
+        const stack_monitor_prio_t* p_prio = &m_prio[i];
+
+        if (p_prio->samples == 0)
+        {
+            continue;
+        }
+
+        if (i == STACK_MONITOR_PRIO_THREAD)
+        {
+            NRF_LOG_INFO("Stack in thread mode: %d bytes deepest, %d samples",
+                         p_prio->depth_max, p_prio->samples);
+        }
+        else
+        {
+            NRF_LOG_INFO("Stack at priority %d: %d bytes deepest with %d nested interrupts, %d samples",
+                         i, p_prio->depth_max, p_prio->nesting, p_prio->samples);
+        }
+    }
+}
+
+
+/**@brief Function for scanning the stack for a new high-water mark.
+ *
+ * @param[in] p_context  Unused.
+ */
+static void scan_timer_handler(void* p_context)
+{
+    uint32_t used = stack_used_scan();
+    uint32_t size = PAINT_END - PAINT_START;
+
+    stack_monitor_sample();
+
+    if (used <= m_used_max)
+    {
+        return;
+    }
+
+    m_used_max = used;
+    NRF_LOG_INFO("Stack high-water mark %d of %d bytes (%d%%)", used, size, used * 100 / size);
+    prio_log();
+}
+
+
+ret_code_t stack_monitor_init(void)
+{
+    volatile uint32_t* p_word = (volatile uint32_t*)PAINT_START;
+
+    // Everything below the current frame is unused this early
+    while ((uint32_t)p_word < __get_MSP())
+    {
+        *p_word++ = STACK_PAINT;
+    }
+
+    m_fault_valid = (m_fault_record.magic == FAULT_MAGIC);
+    if (m_fault_valid)
+    {
+        m_fault = m_fault_record.fault;
+    }
+    m_fault_record.magic = 0;
+
+#if NRF_MODULE_ENABLED(NRF_STACK_GUARD)
+    return nrf_stack_guard_init();
+#else
+    return NRF_SUCCESS;
+#endif
+}
+
+
+ret_code_t stack_monitor_start(void)
+{
+    ret_code_t err_code;
+
+    if (m_fault_valid)
+    {
+        NRF_LOG_ERROR("%s before reset at pc 0x%08x (lr 0x%08x) in exception %d",
+                      m_fault.overflow ? "Stack overflow" : "Hard fault", m_fault.pc, m_fault.lr, m_fault.exception);
+        NRF_LOG_ERROR("Fault sp 0x%08x, CFSR 0x%08x, address 0x%08x", m_fault.sp, m_fault.cfsr, m_fault.fault_addr);
+    }
+
+    err_code = app_timer_create(&m_scan_timer, APP_TIMER_MODE_REPEATED, scan_timer_handler);
+    VERIFY_SUCCESS(err_code);
+
+    return app_timer_start(m_scan_timer, APP_TIMER_TICKS(STACK_MONITOR_SCAN_INTERVAL_MS), NULL);
+}
+
+
+void stack_monitor_sample(void)
+{
+    uint32_t              depth  = PAINT_END - __get_MSP();
+    uint8_t               prio   = current_int_priority_get();
+    stack_monitor_prio_t* p_prio = &m_prio[MIN(prio, STACK_MONITOR_PRIO_THREAD)];
+
+    // Each priority only writes its own record, so a preempting sample cannot tear it
+    p_prio->samples++;
+    if (depth > p_prio->depth_max)
+    {
+        p_prio->depth_max = depth;
+        p_prio->nesting   = nesting_get();
+    }
+}
+
+
+void stack_monitor_stats_get(stack_monitor_stats_t* p_stats)
+{
+    p_stats->size        = PAINT_END - PAINT_START;
+    p_stats->used_max    = MAX(m_used_max, stack_used_scan());
+    p_stats->nesting_max = 0;
+
+    for (uint32_t i = 0; i < STACK_MONITOR_PRIO_COUNT; i++)
+    {
+        p_stats->prio[i]     = m_prio[i];
+        p_stats->nesting_max = MAX(p_stats->nesting_max, m_prio[i].nesting);
+    }
+}
+
+
+bool stack_monitor_fault_get(stack_monitor_fault_t* p_fault)
+{
+    if (m_fault_valid)
+    {
+        *p_fault = m_fault;
+    }
+    return m_fault_valid;
+}
+
+
+#if NRF_MODULE_ENABLED(HARDFAULT_HANDLER)
+/**@brief Function for recording a hard fault and resetting.
+ *
+ * @details Overrides the weak handler of the hardfault library. The stack guard raises a memory
+ *          management fault, which escalates to the hard fault. The MPU is off in the hard fault
+ *          handler, so the exception frame can be stacked into the guard. The handler runs on what
+ *          is left of the guard and must not log.
+ *
+ * @param[in] p_stack  Exception frame, or NULL if the stack pointer was outside the stack.
+ */
+void HardFault_process(HardFault_stack_t* p_stack)
+{
+    stack_monitor_fault_t* p_fault = &m_fault_record.fault;
+    uint32_t               cfsr    = SCB->CFSR;
+
+    memset(p_fault, 0, sizeof(*p_fault));
+    p_fault->cfsr = cfsr;
+
+    if (cfsr & SCB_CFSR_MMARVALID_Msk)
+    {
+        p_fault->fault_addr = SCB->MMFAR;
+    }
+    else if (cfsr & SCB_CFSR_BFARVALID_Msk)
+    {
+        p_fault->fault_addr = SCB->BFAR;
+    }
+
+    if (p_stack != NULL)
+    {
+        p_fault->pc        = p_stack->pc;
+        p_fault->lr        = p_stack->lr;
+        p_fault->sp        = (uint32_t)p_stack;
+        p_fault->exception = p_stack->psr & xPSR_ISR_Msk;
+    }
+
+    p_fault->overflow = (p_stack == NULL) ||
+                        (cfsr & SCB_CFSR_MSTKERR_Msk) ||
+                        ((cfsr & SCB_CFSR_MMARVALID_Msk) &&
+                         p_fault->fault_addr >= (uint32_t)STACK_BASE && p_fault->fault_addr < PAINT_START);
+
+    m_fault_record.magic = FAULT_MAGIC;
+    flight_recorder_record(FLIGHT_RECORDER_SOURCE_HARD_FAULT, 0, 0, 0, p_fault->pc);
+
+#ifdef DEBUG
+    NRF_BREAKPOINT_COND;
+#endif
+    NVIC_SystemReset();
+}
+#endif
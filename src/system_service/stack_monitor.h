@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "nrf.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define STACK_MONITOR_PRIO_COUNT    ((1 << __NVIC_PRIO_BITS) + 1)   /**< Number of execution priorities. Interrupt priorities 0 to 7, followed by thread mode. */
+#define STACK_MONITOR_PRIO_THREAD   (1 << __NVIC_PRIO_BITS)         /**< Index of thread mode in @ref stack_monitor_stats_t::prio */
+
+
+/**@brief Deepest observed use of the stack at one execution priority */
+typedef struct {
+    uint16_t depth_max;     /**< Deepest stack use sampled at this priority in bytes */
+    uint8_t  nesting;       /**< Number of active interrupts when the deepest use was sampled */
+    uint32_t samples;       /**< Number of samples taken at this priority */
+} stack_monitor_prio_t;
+
+/**@brief Stack statistics */
+typedef struct {
+    uint32_t             size;                              /**< Stack size in bytes, without the stack guard */
+    uint32_t             used_max;                          /**< High-water mark of the painted stack in bytes */
+    uint8_t              nesting_max;                       /**< Deepest interrupt nesting sampled */
+    stack_monitor_prio_t prio[STACK_MONITOR_PRIO_COUNT];    /**< Deepest use per execution priority */
+} stack_monitor_stats_t;
+
+/**@brief Fault recorded before the last reset */
+typedef struct {
+    uint32_t pc;            /**< Program counter of the faulting instruction */
+    uint32_t lr;            /**< Link register at the fault */
+    uint32_t cfsr;          /**< Configurable fault status (SCB->CFSR) */
+    uint32_t fault_addr;    /**< Faulting data address (SCB->MMFAR or SCB->BFAR), or 0 if not valid */
+    uint32_t sp;            /**< Stack pointer at the fault, or 0 if it was outside the stack */
+    uint8_t  exception;     /**< Exception number that was active at the fault, 0 in thread mode */
+    bool     overflow;      /**< True if the fault was a stack overflow, caught by the stack guard or by a stack pointer outside the stack */
+} stack_monitor_fault_t;
+
+
+
+/**@brief Function for painting the stack.
+ *
+ * @details Fills the unused part of the stack with a pattern and, if @ref NRF_STACK_GUARD_ENABLED
+ *          is set, protects its lowest @ref NRF_STACK_GUARD_CONFIG_SIZE with the MPU. Must be called
+ *          at the start of main, while the stack is nearly empty.
+ *
+ * @retval NRF_SUCCESS  If the stack was painted.
+ * @retval err_code     Otherwise, the error returned by the stack guard.
+ */
+ret_code_t stack_monitor_init(void);
+
+
+/**@brief Function for starting the periodic high-water scans.
+ *
+ * @details Logs the fault recorded before the last reset, if any. Must be called after the log
+ *          and app_timer are initialized.
+ *
+ * @retval NRF_SUCCESS  If the scans were started.
+ * @retval err_code     Otherwise, the error returned by the app_timer module.
+ */
+ret_code_t stack_monitor_start(void);
+
+
+/**@brief Function for sampling the stack depth at the current execution priority.
+ *
+ * @details Called on entry to the handlers that nest on top of the main loop. Cheap enough for
+ *          every BLE event.
+ */
+void stack_monitor_sample(void);
+
+
+/**@brief Function for getting the stack statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void stack_monitor_stats_get(stack_monitor_stats_t* p_stats);
+
+
+/**@brief Function for getting the fault recorded before the last reset.
+ *
+ * @param[out] p_fault  Fault.
+ *
+ * @retval true   If the last reset was caused by a fault.
+ * @retval false  Otherwise.
+ */
+bool stack_monitor_fault_get(stack_monitor_fault_t* p_fault);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,218 @@
+#include "timer_wheel.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "ble.h"
+#include "system_service/work_queue.h"
+
+
+#define TICK_RTC    APP_TIMER_TICKS(TIMER_WHEEL_TICK_MS)   // Length of a wheel tick in RTC ticks
+
+
+// Slot list heads. An empty slot points to itself. All wheel state belongs to the main loop.
+static timer_wheel_entry_t m_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static uint32_t            m_tick;          // Current wheel tick
+static uint32_t            m_tick_cnt;      // RTC counter value of the current wheel tick
+static uint32_t            m_count;         // Number of running entries
+static bool                m_timer_running;
+
+APP_TIMER_DEF(m_tick_timer);
+
+STATIC_ASSERT(TIMER_WHEEL_LEVELS == 2, "Slot selection supports two levels.");
+
+
+static void slot_insert(timer_wheel_entry_t* p_slot, timer_wheel_entry_t* p_entry)
+{
+    p_entry->p_next        = p_slot;
+    p_entry->p_prev        = p_slot->p_prev;
+    p_slot->p_prev->p_next = p_entry;
+    p_slot->p_prev         = p_entry;
+}
+
+
+static void slot_unlink(timer_wheel_entry_t* p_entry)
+{
+    p_entry->p_prev->p_next = p_entry->p_next;
+    p_entry->p_next->p_prev = p_entry->p_prev;
+    p_entry->p_next         = NULL;
+    p_entry->p_prev         = NULL;
+}
+
+
+/**@brief Function for placing an entry in the slot of its expiry tick.
+ *
+ * @details Entries expiring within one turn of the first level go to the first level, later ones
+ *          to the slot of the second level that is cascaded down just before they expire. Entries
+ *          beyond the second level wait in its last slot and are placed again when it cascades.
+ */
+static void entry_place(timer_wheel_entry_t* p_entry)
+{
+    uint32_t delta = p_entry->expiry_tick - m_tick;
+    uint32_t turns;
+
+    if (delta < TIMER_WHEEL_SLOTS)
+    {
+        slot_insert(&m_slots[0][p_entry->expiry_tick % TIMER_WHEEL_SLOTS], p_entry);
+        return;
+    }
+
+    turns = MIN(p_entry->expiry_tick / TIMER_WHEEL_SLOTS - m_tick / TIMER_WHEEL_SLOTS, TIMER_WHEEL_SLOTS - 1);
+    slot_insert(&m_slots[1][(m_tick / TIMER_WHEEL_SLOTS + turns) % TIMER_WHEEL_SLOTS], p_entry);
+}
+
+
+/**@brief Function for advancing the wheel by one tick and calling the handlers of the expired entries.
+ */
+static void tick_advance(void)
+{
+    timer_wheel_entry_t* p_slot;
+    timer_wheel_entry_t* p_entry;
+
+    m_tick++;
+
+    if (m_tick % TIMER_WHEEL_SLOTS == 0)
+    {
+        // Cascade the second level slot of the new turn into the first level
+        p_slot = &m_slots[1][(m_tick / TIMER_WHEEL_SLOTS) % TIMER_WHEEL_SLOTS];
+        while (p_slot->p_next != p_slot)
+        {
+            p_entry = p_slot->p_next;
+            slot_unlink(p_entry);
+            entry_place(p_entry);
+        }
+    }
+
+    // Handlers may start and stop any entry, so the slot is taken from the head until it is empty
+    p_slot = &m_slots[0][m_tick % TIMER_WHEEL_SLOTS];
+    while (p_slot->p_next != p_slot)
+    {
+        p_entry = p_slot->p_next;
+        slot_unlink(p_entry);
+        m_count--;
+        p_entry->handler(p_entry);
+    }
+}
+
+
+/**@brief Function for catching up with the RTC in the main loop.
+ *
+ * @details Counts the elapsed ticks from the RTC, so that a tick lost to a full work queue only
+ *          delays the expiries.
+ *
+ * @param[in] p_item  Unused.
+ */
+static void tick_work(const work_queue_item_t* p_item)
+{
+    ret_code_t err_code;
+    uint32_t   elapsed = app_timer_cnt_diff_compute(app_timer_cnt_get(), m_tick_cnt) / TICK_RTC;
+
+    m_tick_cnt = (m_tick_cnt + elapsed * TICK_RTC) & APP_TIMER_MAX_CNT_VAL;
+
+    while (elapsed-- > 0 && m_count > 0)
+    {
+        tick_advance();
+    }
+
+    if (m_count == 0 && m_timer_running)
+    {
+        err_code = app_timer_stop(m_tick_timer);
+        APP_ERROR_CHECK(err_code);
+        m_timer_running = false;
+    }
+}
+
+
+/**@brief Function for handing the tick to the main loop.
+ *
+ * @param[in] p_context  Unused.
+ */
+static void tick_timer_handler(void* p_context)
+{
+    // A tick lost to a full queue is caught up with the next one
+    (void)work_queue_post(WORK_QUEUE_TYPE_TIMER_WHEEL_TICK, BLE_CONN_HANDLE_INVALID, 0, 0);
+}
+
+
+ret_code_t timer_wheel_init(void)
+{
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS; i++)
+        {
+            m_slots[level][i].p_next = &m_slots[level][i];
+            m_slots[level][i].p_prev = &m_slots[level][i];
+        }
+    }
+
+    m_tick          = 0;
+    m_count         = 0;
+    m_timer_running = false;
+
+    work_queue_handler_set(WORK_QUEUE_TYPE_TIMER_WHEEL_TICK, tick_work);
+
+    return app_timer_create(&m_tick_timer, APP_TIMER_MODE_REPEATED, tick_timer_handler);
+}
+
+
+ret_code_t timer_wheel_start(timer_wheel_entry_t* p_entry, uint32_t timeout_ms, timer_wheel_handler_t handler)
+{
+    ret_code_t err_code;
+    uint32_t   phase_cnt = 0;
+    uint32_t   ticks;
+
+    VERIFY_PARAM_NOT_NULL(p_entry);
+    VERIFY_PARAM_NOT_NULL(handler);
+
+    timer_wheel_stop(p_entry);
+
+    if (!m_timer_running)
+    {
+        // Read before the start, so that the first tick never comes early
+        m_tick_cnt = app_timer_cnt_get();
+
+        err_code = app_timer_start(m_tick_timer, TICK_RTC, NULL);
+        VERIFY_SUCCESS(err_code);
+
+        m_timer_running = true;
+    }
+    else
+    {
+        // Part of the current tick that already passed
+        phase_cnt = app_timer_cnt_diff_compute(app_timer_cnt_get(), m_tick_cnt);
+    }
+
+    ticks = MAX(CEIL_DIV(APP_TIMER_TICKS(timeout_ms) + phase_cnt, TICK_RTC), 1);
+
+    p_entry->handler     = handler;
+    p_entry->expiry_tick = m_tick + ticks;
+    entry_place(p_entry);
+    m_count++;
+
+    return NRF_SUCCESS;
+}
+
+
+void timer_wheel_stop(timer_wheel_entry_t* p_entry)
+{
+    if (p_entry == NULL || p_entry->p_prev == NULL)
+    {
+        return;
+    }
+
+    // The tick timer stops on its next tick if the wheel is empty
+    slot_unlink(p_entry);
+    m_count--;
+}
+
+
+bool timer_wheel_is_running(const timer_wheel_entry_t* p_entry)
+{
+    return p_entry->p_prev != NULL;
+}
+
+
+uint32_t timer_wheel_count(void)
+{
+    return m_count;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define TIMER_WHEEL_SLOTS       64                                                  /**< Slots per wheel level */
+#define TIMER_WHEEL_LEVELS      2                                                   /**< Number of wheel levels. Each slot of a level spans a full turn of the level below */
+#define TIMER_WHEEL_MAX_TICKS   (TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS - 1)         /**< Longest timeout in ticks. Longer timeouts are cascaded again until they expire */
+
+
+typedef struct timer_wheel_entry_s timer_wheel_entry_t;
+
+/**@brief Timeout handler type.
+ *
+ * @details Called from the main loop. The entry may be started again from the handler.
+ *
+ * @param[in] p_entry  Expired entry. Use CONTAINER_OF to get the structure it is embedded in.
+ */
+typedef void (*timer_wheel_handler_t)(timer_wheel_entry_t* p_entry);
+
+/**@brief Timer wheel entry. Embedded in the structure that owns the timeout, the wheel never
+ *        allocates. Must be zeroed before it is first started. */
+struct timer_wheel_entry_s {
+    timer_wheel_entry_t*  p_next;       /**< Next entry in the slot */
+    timer_wheel_entry_t*  p_prev;       /**< Previous entry in the slot, NULL if the entry is not running */
+    timer_wheel_handler_t handler;      /**< Timeout handler */
+    uint32_t              expiry_tick;  /**< Wheel tick at which the entry expires */
+};
+
+
+
+/**@brief Function for initializing the timer wheel.
+ *
+ * @details The wheel advances every @ref TIMER_WHEEL_TICK_MS from a single app_timer, which only
+ *          runs while entries are running. The app_timer handler posts the tick to the work queue,
+ *          so the wheel and its handlers run in the main loop. Must be called after
+ *          @ref work_queue_init.
+ *
+ * @retval NRF_SUCCESS  If the wheel was initialized.
+ * @retval err_code     Otherwise, the error returned by the app_timer module.
+ */
+ret_code_t timer_wheel_init(void);
+
+
+/**@brief Function for starting an entry in O(1).
+ *
+ * @details A running entry is restarted. Must be called from the main loop.
+ *
+ * @param[in] p_entry     Entry.
+ * @param[in] timeout_ms  Timeout, rounded up to whole ticks.
+ * @param[in] handler     Timeout handler.
+ *
+ * @retval NRF_SUCCESS     If the entry was started.
+ * @retval NRF_ERROR_NULL  If p_entry or handler is NULL.
+ * @retval err_code        Otherwise, the error returned by the app_timer module.
+ */
+ret_code_t timer_wheel_start(timer_wheel_entry_t* p_entry, uint32_t timeout_ms, timer_wheel_handler_t handler);
+
+
+/**@brief Function for stopping an entry in O(1).
+ *
+ * @details Stopping an entry that is not running has no effect. Must be called from the main loop.
+ *
+ * @param[in] p_entry  Entry.
+ */
+void timer_wheel_stop(timer_wheel_entry_t* p_entry);
+
+
+/**@brief Function for checking whether an entry is running.
+ *
+ * @param[in] p_entry  Entry.
+ */
+bool timer_wheel_is_running(const timer_wheel_entry_t* p_entry);
+
+
+/**@brief Function for getting the number of running entries. */
+uint32_t timer_wheel_count(void);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,134 @@
+#include "work_queue.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "nrf.h"
+#include "nrf_atfifo.h"
+#include "nrf_atomic.h"
+#include "system_service/cycle_profile.h"
+#include "system_service/flight_recorder.h"
+
+
+NRF_ATFIFO_DEF(m_fifo, work_queue_item_t, WORK_QUEUE_SIZE);
+
+static work_queue_handler_t m_handlers[WORK_QUEUE_TYPE_COUNT];
+
+// Written by the producers with atomic operations
+static nrf_atomic_u32_t     m_posted;
+static nrf_atomic_u32_t     m_dropped;
+static nrf_atomic_u32_t     m_enqueue_cycles_total;
+static nrf_atomic_u32_t     m_enqueue_cycles_max;
+
+// Written by the main loop only
+static uint32_t             m_processed;
+static uint32_t             m_depth_max;
+
+
+/**@brief Function for raising a maximum shared by several producers without a lock.
+ */
+static void atomic_max(nrf_atomic_u32_t* p_max, uint32_t value)
+{
+    uint32_t max = *p_max;
+
+    // On failure the current value is loaded into max and the comparison repeated
+    while (value > max && !nrf_atomic_u32_cmp_exch(p_max, &max, value))
+    {
+    }
+}
+
+
+ret_code_t work_queue_init(void)
+{
+    memset(m_handlers, 0, sizeof(m_handlers));
+    m_posted               = 0;
+    m_dropped              = 0;
+    m_enqueue_cycles_total = 0;
+    m_enqueue_cycles_max   = 0;
+    m_processed            = 0;
+    m_depth_max            = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return NRF_ATFIFO_INIT(m_fifo);
+}
+
+
+void work_queue_handler_set(work_queue_type_t type, work_queue_handler_t handler)
+{
+    if (type < WORK_QUEUE_TYPE_COUNT)
+    {
+        m_handlers[type] = handler;
+    }
+}
+
+
+ret_code_t work_queue_post(work_queue_type_t type, uint16_t conn_handle, uint8_t arg, uint32_t value)
+{
+    ret_code_t        err_code;
+    uint32_t          start_cycles;
+    uint32_t          cycles;
+    work_queue_item_t item =
+    {
+        .type        = (uint8_t)type,
+        .arg         = arg,
+        .conn_handle = conn_handle,
+        .value       = value
+    };
+
+    start_cycles = DWT->CYCCNT;
+    err_code     = nrf_atfifo_alloc_put(m_fifo, &item, sizeof(item), NULL);
+    cycles       = DWT->CYCCNT - start_cycles;
+
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)nrf_atomic_u32_add(&m_dropped, 1);
+        return NRF_ERROR_NO_MEM;
+    }
+
+    flight_recorder_record(FLIGHT_RECORDER_SOURCE_WORK, (uint8_t)type, arg, conn_handle, value);
+
+    (void)nrf_atomic_u32_add(&m_posted, 1);
+    (void)nrf_atomic_u32_add(&m_enqueue_cycles_total, cycles);
+    atomic_max(&m_enqueue_cycles_max, cycles);
+
+    return NRF_SUCCESS;
+}
+
+
+void work_queue_process(void)
+{
+    work_queue_item_t item;
+    uint32_t          begin;
+
+    for (;;)
+    {
+        // The depth only falls here, so sampling it before each get catches every peak
+        m_depth_max = MAX(m_depth_max, m_posted - m_processed);
+
+        if (nrf_atfifo_get_free(m_fifo, &item, sizeof(item), NULL) != NRF_SUCCESS)
+        {
+            break;
+        }
+        m_processed++;
+
+        if (item.type < WORK_QUEUE_TYPE_COUNT && m_handlers[item.type] != NULL)
+        {
+            begin = CYCLE_PROFILE_BEGIN();
+            m_handlers[item.type](&item);
+            CYCLE_PROFILE_END(CYCLE_PROFILE_POINT_WORK_ITEM, begin);
+        }
+    }
+}
+
+
+void work_queue_stats_get(work_queue_stats_t* p_stats)
+{
+    uint32_t posted = m_posted;
+
+    p_stats->posted              = posted;
+    p_stats->dropped             = m_dropped;
+    p_stats->depth_max           = m_depth_max;
+    p_stats->enqueue_cycles_max  = m_enqueue_cycles_max;
+    p_stats->enqueue_cycles_mean = (posted > 0) ? m_enqueue_cycles_total / posted : 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "app_util.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief Work item types */
+typedef enum {
+    WORK_QUEUE_TYPE_REQUEST_STATE,      /**< Request state read or notified by a wearable. arg: request state */
+    WORK_QUEUE_TYPE_REQUEST_WRITE_RSP,  /**< Wearable confirmed a request state write. value: GATT status */
+    WORK_QUEUE_TYPE_REQUEST_ACK,        /**< Acknowledgement button pressed. No link */
+    WORK_QUEUE_TYPE_REQUEST_EXPIRED,    /**< Restored request expired. conn_handle: detached handle of the request */
+    WORK_QUEUE_TYPE_REQUEST_REATTACH,   /**< Wearable of a restored request reconnected. value: index of the restored request */
+    WORK_QUEUE_TYPE_LINK_DOWN,          /**< Link disconnected */
+    WORK_QUEUE_TYPE_HANDOVER,           /**< Link should be handed over. arg: averaged link RSSI in -dBm */
+    WORK_QUEUE_TYPE_RELAY_READY,        /**< Relay characteristic of the station discovered */
+    WORK_QUEUE_TYPE_RELAY_WRITE_RSP,    /**< Station confirmed a relay record. value: GATT status */
+    WORK_QUEUE_TYPE_TIMER_WHEEL_TICK,   /**< Timer wheel tick. No link */
+    WORK_QUEUE_TYPE_STATS_RESET,        /**< Statistics reset from the Statistics Control Point. conn_handle: peer that wrote it */
+    WORK_QUEUE_TYPE_ROAMING_ADV_UPDATE, /**< Roaming advertising data out of date. No link */
+    WORK_QUEUE_TYPE_STATS,              /**< Statistics interval elapsed. No link */
+    WORK_QUEUE_TYPE_RELAY_WRITE_ERROR,  /**< GATT queue failed to send a relay record. value: error code */
+    WORK_QUEUE_TYPE_COUNT
+} work_queue_type_t;
+
+
+/**@brief Work item */
+typedef struct {
+    uint8_t  type;          /**< @ref work_queue_type_t */
+    uint8_t  arg;           /**< Type specific argument */
+    uint16_t conn_handle;   /**< Connection handle of the link, or BLE_CONN_HANDLE_INVALID */
+    uint32_t value;         /**< Type specific value */
+} work_queue_item_t;
+
+STATIC_ASSERT(sizeof(work_queue_item_t) == 8);
+
+
+/**@brief Work queue statistics */
+typedef struct {
+    uint32_t posted;                /**< Number of items posted */
+    uint32_t dropped;               /**< Number of items dropped because the queue was full */
+    uint32_t depth_max;             /**< Highest number of items waiting for the main loop */
+    uint32_t enqueue_cycles_max;    /**< Longest enqueue in CPU cycles */
+    uint32_t enqueue_cycles_mean;   /**< Mean enqueue time in CPU cycles */
+} work_queue_stats_t;
+
+
+/**@brief Work item handler type.
+ *
+ * @param[in] p_item  Work item.
+ */
+typedef void (*work_queue_handler_t)(const work_queue_item_t* p_item);
+
+
+
+/**@brief Function for initializing the work queue.
+ *
+ * @details Enables the DWT cycle counter, which measures the enqueue cost.
+ *
+ * @retval NRF_SUCCESS  If the queue was initialized.
+ * @retval err_code     Otherwise, the error returned by the atomic FIFO.
+ */
+ret_code_t work_queue_init(void);
+
+
+/**@brief Function for setting the handler of a work item type.
+ *
+ * @param[in] type     Work item type.
+ * @param[in] handler  Handler, called from the main loop.
+ */
+void work_queue_handler_set(work_queue_type_t type, work_queue_handler_t handler);
+
+
+/**@brief Function for posting a work item to the main loop.
+ *
+ * @details Lock-free, may be called from any interrupt priority and from several at once.
+ *
+ * @param[in] type         Work item type.
+ * @param[in] conn_handle  Connection handle of the link, or BLE_CONN_HANDLE_INVALID.
+ * @param[in] arg          Type specific argument.
+ * @param[in] value        Type specific value.
+ *
+ * @retval NRF_SUCCESS       If the item was posted.
+ * @retval NRF_ERROR_NO_MEM  If the queue is full. The item is dropped.
+ */
+ret_code_t work_queue_post(work_queue_type_t type, uint16_t conn_handle, uint8_t arg, uint32_t value);
+
+
+/**@brief Function for handling the posted work items in the order they were posted.
+ *
+ * @details Must be called from the main loop only.
+ */
+void work_queue_process(void);
+
+
+/**@brief Function for getting the work queue statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void work_queue_stats_get(work_queue_stats_t* p_stats);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,318 @@
+#include "wall_clock.h"
+#include "config.h"
+
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "ble_cts_c.h"
+#include "ble_service/ble_evt_router.h"
+
+#include "nrf_log.h"
+
+
+#define PPM     1000000
+
+
+static ble_cts_c_t m_cts_c;
+BLE_EVT_ROUTE(m_cts_c_read_rsp_route,     BLE_GATTC_EVT_READ_RSP,   BLE_CTS_C_BLE_OBSERVER_PRIO, ble_cts_c_on_ble_evt, &m_cts_c);
+BLE_EVT_ROUTE(m_cts_c_disconnected_route, BLE_GAP_EVT_DISCONNECTED, BLE_CTS_C_BLE_OBSERVER_PRIO, ble_cts_c_on_ble_evt, &m_cts_c);
+
+APP_TIMER_DEF(m_extend_timer);
+APP_TIMER_DEF(m_resync_timer);
+
+static wall_clock_sync_handler_t m_sync_handler;
+
+static uint64_t m_ticks;            // Tick count at m_last_cnt
+static uint32_t m_last_cnt;         // app_timer counter at the last extension
+
+static bool     m_synced;
+static uint64_t m_sync_local_ms;    // Local time of the last sync
+static uint64_t m_sync_epoch_ms;    // Wall clock time of the last sync
+static uint64_t m_drift_local_ms;   // Local time of the sync the drift is measured from
+static uint64_t m_drift_epoch_ms;   // Wall clock time of the sync the drift is measured from
+static int32_t  m_drift_ppm;
+
+
+/**@brief Function for getting the days between 1970-01-01 and a date of the Gregorian calendar.
+ */
+static int64_t days_from_civil(int32_t year, uint32_t month, uint32_t day)
+{
+    year -= (month <= 2);
+
+    int32_t  era = year / 400;
+    uint32_t yoe = (uint32_t)(year - era * 400);
+    uint32_t doy = (153 * ((month > 2) ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return (int64_t)era * 146097 + doe - 719468;
+}
+
+
+/**@brief Function for converting a Current Time characteristic to milliseconds since 1970.
+ *
+ * @retval NRF_SUCCESS            If the time was converted.
+ * @retval NRF_ERROR_INVALID_DATA If the date is unknown or out of range.
+ */
+static ret_code_t cts_to_epoch_ms(const current_time_char_t* p_time, uint64_t* p_epoch_ms)
+{
+    const ble_date_time_t* p_dt = &p_time->exact_time_256.day_date_time.date_time;
+    int64_t                days;
+
+    // The characteristic uses zero for unknown fields
+    if (p_dt->year < 1970 || p_dt->month < 1 || p_dt->month > 12 || p_dt->day < 1 || p_dt->day > 31 ||
+        p_dt->hours > 23 || p_dt->minutes > 59 || p_dt->seconds > 59)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    days = days_from_civil(p_dt->year, p_dt->month, p_dt->day);
+
+    *p_epoch_ms = ((uint64_t)days * 86400 + p_dt->hours * 3600 + p_dt->minutes * 60 + p_dt->seconds) * 1000
+                + (uint64_t)p_time->exact_time_256.fractions256 * 1000 / 256;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for converting a local time to wall clock time, corrected by the drift.
+ */
+static uint64_t local_to_epoch_ms(uint64_t local_ms)
+{
+    int64_t elapsed_ms = (int64_t)(local_ms - m_sync_local_ms);
+
+    return m_sync_epoch_ms + elapsed_ms - (elapsed_ms * m_drift_ppm) / PPM;
+}
+
+
+/**@brief Function for syncing the wall clock to a time read from a peer.
+ *
+ * @details The drift is measured over at least WALL_CLOCK_DRIFT_MIN_INTERVAL_MS, so that the
+ *          resolution of the read time does not dominate the measurement.
+ */
+static void sync(uint16_t conn_handle, uint64_t epoch_ms)
+{
+    wall_clock_sync_t result    = {0};
+    uint64_t          local_ms  = wall_clock_ticks_to_ms(wall_clock_ticks_get());
+    int32_t           new_drift = m_drift_ppm;
+
+    result.conn_handle = conn_handle;
+
+    if (!m_synced)
+    {
+        m_drift_local_ms = local_ms;
+        m_drift_epoch_ms = epoch_ms;
+    }
+    else
+    {
+        result.offset_ms = (int32_t)((int64_t)(epoch_ms - local_to_epoch_ms(local_ms)));
+
+        uint64_t local_elapsed_ms = local_ms - m_drift_local_ms;
+        int64_t  epoch_elapsed_ms = (int64_t)(epoch_ms - m_drift_epoch_ms);
+
+        if (local_elapsed_ms >= WALL_CLOCK_DRIFT_MIN_INTERVAL_MS && epoch_elapsed_ms > 0)
+        {
+            int64_t drift_ppm = (((int64_t)local_elapsed_ms - epoch_elapsed_ms) * PPM) / epoch_elapsed_ms;
+
+            // A larger drift means the peer's time was adjusted, not that the crystal is off
+            if (drift_ppm >= -WALL_CLOCK_DRIFT_MAX_PPM && drift_ppm <= WALL_CLOCK_DRIFT_MAX_PPM)
+            {
+                new_drift             = (int32_t)drift_ppm;
+                result.drift_measured = true;
+            }
+            m_drift_local_ms = local_ms;
+            m_drift_epoch_ms = epoch_ms;
+        }
+    }
+
+    CRITICAL_REGION_ENTER();
+    m_sync_local_ms = local_ms;
+    m_sync_epoch_ms = epoch_ms;
+    m_drift_ppm     = new_drift;
+    m_synced        = true;
+    CRITICAL_REGION_EXIT();
+
+    result.drift_ppm = new_drift;
+    if (m_sync_handler != NULL)
+    {
+        m_sync_handler(&result);
+    }
+}
+
+
+/**@brief Function for handling Current Time Service client events.
+ */
+static void cts_c_evt_handler(ble_cts_c_t* p_cts, ble_cts_c_evt_t* p_evt)
+{
+    ret_code_t err_code;
+    uint64_t   epoch_ms;
+
+    switch (p_evt->evt_type)
+    {
+        case BLE_CTS_C_EVT_DISCOVERY_COMPLETE:
+            // Keep syncing from the first peer with a time service
+            if (p_cts->conn_handle != BLE_CONN_HANDLE_INVALID)
+            {
+                break;
+            }
+
+            NRF_LOG_INFO("Current Time Service discovered on conn_handle 0x%x.", p_evt->conn_handle);
+            err_code = ble_cts_c_handles_assign(p_cts, p_evt->conn_handle, &p_evt->params.char_handles);
+            APP_ERROR_CHECK(err_code);
+
+            err_code = ble_cts_c_current_time_read(p_cts);
+            if (err_code != NRF_SUCCESS)
+            {
+                NRF_LOG_WARNING("Current time not read: 0x%x", err_code);
+            }
+            break;
+
+        case BLE_CTS_C_EVT_CURRENT_TIME:
+            if (cts_to_epoch_ms(&p_evt->params.current_time, &epoch_ms) == NRF_SUCCESS)
+            {
+                sync(p_evt->conn_handle, epoch_ms);
+            }
+            else
+            {
+                NRF_LOG_WARNING("Peer reported an unknown time.");
+            }
+            break;
+
+        case BLE_CTS_C_EVT_INVALID_TIME:
+            NRF_LOG_WARNING("Peer reported an invalid time.");
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**@brief Function for handling Current Time Service client errors.
+ *
+ * @details A peer may refuse the read, for example without encryption. The time stays unsynced.
+ *
+ * @param[in] nrf_error  Error code.
+ */
+static void cts_c_error_handler(uint32_t nrf_error)
+{
+    NRF_LOG_WARNING("Current Time Service client error: 0x%x", nrf_error);
+}
+
+
+/**@brief Function for extending the 24-bit app_timer counter before it wraps.
+ *
+ * @param[in] p_context  Unused.
+ */
+static void extend_timer_handler(void* p_context)
+{
+    (void)wall_clock_ticks_get();
+}
+
+
+/**@brief Function for reading the time again from the peer.
+ *
+ * @param[in] p_context  Unused.
+ */
+static void resync_timer_handler(void* p_context)
+{
+    if (m_cts_c.conn_handle != BLE_CONN_HANDLE_INVALID)
+    {
+        (void)ble_cts_c_current_time_read(&m_cts_c);
+    }
+}
+
+
+ret_code_t wall_clock_init(wall_clock_sync_handler_t sync_handler)
+{
+    ret_code_t err_code;
+
+    m_sync_handler = sync_handler;
+    m_last_cnt     = app_timer_cnt_get();
+    m_ticks        = m_last_cnt;
+    m_synced       = false;
+    m_drift_ppm    = 0;
+
+    err_code = app_timer_create(&m_extend_timer, APP_TIMER_MODE_REPEATED, extend_timer_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = app_timer_create(&m_resync_timer, APP_TIMER_MODE_REPEATED, resync_timer_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = app_timer_start(m_extend_timer, APP_TIMER_TICKS(WALL_CLOCK_EXTEND_INTERVAL_MS), NULL);
+    VERIFY_SUCCESS(err_code);
+
+    return app_timer_start(m_resync_timer, APP_TIMER_TICKS(WALL_CLOCK_RESYNC_INTERVAL_MS), NULL);
+}
+
+
+void wall_clock_cts_c_init(nrf_ble_gq_t* p_gatt_queue)
+{
+    ret_code_t       err_code;
+    ble_cts_c_init_t cts_c_init = {0};
+
+    cts_c_init.evt_handler   = cts_c_evt_handler;
+    cts_c_init.error_handler = cts_c_error_handler;
+    cts_c_init.p_gatt_queue  = p_gatt_queue;
+
+    err_code = ble_cts_c_init(&m_cts_c, &cts_c_init);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void wall_clock_on_db_disc_evt(ble_db_discovery_evt_t* p_evt)
+{
+    ble_cts_c_on_db_disc_evt(&m_cts_c, p_evt);
+}
+
+
+uint64_t wall_clock_ticks_get(void)
+{
+    uint64_t ticks;
+
+    CRITICAL_REGION_ENTER();
+    uint32_t cnt = app_timer_cnt_get();
+
+    m_ticks   += app_timer_cnt_diff_compute(cnt, m_last_cnt);
+    m_last_cnt = cnt;
+    ticks      = m_ticks;
+    CRITICAL_REGION_EXIT();
+
+    return ticks;
+}
+
+
+uint64_t wall_clock_ticks_to_ms(uint64_t ticks)
+{
+    return (ticks * 1000) / APP_TIMER_CLOCK_FREQ;
+}
+
+
+uint64_t wall_clock_time_ms_get(void)
+{
+    uint64_t local_ms = wall_clock_ticks_to_ms(wall_clock_ticks_get());
+    uint64_t time_ms;
+
+    CRITICAL_REGION_ENTER();
+    time_ms = m_synced ? local_to_epoch_ms(local_ms) : (local_ms | WALL_CLOCK_BOOT_TIME_FLAG);
+    CRITICAL_REGION_EXIT();
+
+    return time_ms;
+}
+
+
+uint32_t wall_clock_elapsed_ms(uint64_t since_ms)
+{
+    uint64_t now_ms = wall_clock_time_ms_get();
+
+    if (((now_ms ^ since_ms) & WALL_CLOCK_BOOT_TIME_FLAG) != 0 || now_ms <= since_ms)
+    {
+        return 0;
+    }
+    return (uint32_t)MIN(now_ms - since_ms, UINT32_MAX);
+}
+
+
+bool wall_clock_is_synced(void)
+{
+    return m_synced;
+}
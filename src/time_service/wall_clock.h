@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "ble_db_discovery.h"
+#include "nrf_ble_gq.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define WALL_CLOCK_BOOT_TIME_FLAG   (1ULL << 63)    /**< Set in times returned before the first sync. The rest of the value is the time since boot. */
+
+
+/**@brief Time sync result */
+typedef struct {
+    uint16_t conn_handle;       /**< Connection handle of the peer the time was read from */
+    int32_t  offset_ms;         /**< Read time minus the local time before the sync. Zero for the first sync */
+    int32_t  drift_ppm;         /**< Drift applied from now on. Positive if the local clock runs fast */
+    bool     drift_measured;    /**< True if this sync produced a new drift measurement */
+} wall_clock_sync_t;
+
+/**@brief Time sync handler type.
+ *
+ * @param[in] p_sync  Sync result.
+ */
+typedef void (*wall_clock_sync_handler_t)(const wall_clock_sync_t* p_sync);
+
+
+
+/**@brief Function for initializing the wall clock.
+ *
+ * @details Extends the app_timer counter to a 64-bit tick count. Must be called after app_timer_init.
+ *          Until a peer's Current Time Service is read, times are relative to boot.
+ *
+ * @param[in] sync_handler  Handler called after each time sync. Can be NULL.
+ */
+ret_code_t wall_clock_init(wall_clock_sync_handler_t sync_handler);
+
+
+/**@brief Function for initializing the Current Time Service client.
+ *
+ * @details Matches @ref ble_gattc_service_init_func_t, so it can be passed to the BLE services.
+ *
+ * @param[in] p_gatt_queue  GATT queue.
+ */
+void wall_clock_cts_c_init(nrf_ble_gq_t* p_gatt_queue);
+
+
+/**@brief Function for handling database discovery events.
+ *
+ * @details The time is read from the first peer with a Current Time Service, and read again
+ *          every @ref WALL_CLOCK_RESYNC_INTERVAL_MS while that peer stays connected.
+ *
+ * @param[in] p_evt  Database discovery event.
+ */
+void wall_clock_on_db_disc_evt(ble_db_discovery_evt_t* p_evt);
+
+
+/**@brief Function for getting the monotonic tick count.
+ *
+ * @details app_timer ticks since boot, not affected by time syncs. Use it for durations.
+ */
+uint64_t wall_clock_ticks_get(void);
+
+
+/**@brief Function for converting app_timer ticks to milliseconds.
+ *
+ * @param[in] ticks  Tick count.
+ */
+uint64_t wall_clock_ticks_to_ms(uint64_t ticks);
+
+
+/**@brief Function for getting the wall clock time.
+ *
+ * @details Computed from the last sync and the local tick count, corrected by the measured drift.
+ *
+ * @return Milliseconds since 1970-01-01 00:00 in the peer's time zone, as the Current Time
+ *         Service reports local time. Milliseconds since boot with @ref WALL_CLOCK_BOOT_TIME_FLAG
+ *         set if the clock was never synced.
+ */
+uint64_t wall_clock_time_ms_get(void);
+
+
+/**@brief Function for getting the time elapsed since an earlier wall clock time.
+ *
+ * @details Times taken before and after the first sync, for example before a warm reset and after
+ *          the clock was synced again, are on different scales. Their difference is meaningless
+ *          and counts as 0, as does a time in the future.
+ *
+ * @param[in] since_ms  Earlier time, see @ref wall_clock_time_ms_get.
+ *
+ * @return Milliseconds elapsed, saturated at UINT32_MAX.
+ */
+uint32_t wall_clock_elapsed_ms(uint64_t since_ms);
+
+
+/**@brief Function for checking whether the wall clock was synced. */
+bool wall_clock_is_synced(void);
+
+
+#ifdef __cplusplus
+}
+#endif